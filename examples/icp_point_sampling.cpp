@@ -0,0 +1,78 @@
+#include <cilantro/icp_common_instances.hpp>
+#include <cilantro/correspondence_search_subsampled.hpp>
+#include <cilantro/point_cloud.hpp>
+#include <cilantro/timer.hpp>
+
+// Rigid ICP on a perturbed copy of a point cloud, with the correspondences of every iteration computed for a
+// random subset of the source points only (see point_samplers.hpp), for all correspondence search directions.
+template <class SamplerT>
+void run_and_report(const cilantro::PointCloud3f &dst, const cilantro::PointCloud3f &src,
+                    const cilantro::RigidTransform3f &tf_ref, SamplerT &sampler, const std::string &name)
+{
+    const cilantro::CorrespondenceSearchDirection directions[] = {cilantro::CorrespondenceSearchDirection::SECOND_TO_FIRST, cilantro::CorrespondenceSearchDirection::FIRST_TO_SECOND, cilantro::CorrespondenceSearchDirection::BOTH};
+    const std::string direction_names[] = {"source to target", "target to source", "both"};
+
+    for (size_t k = 0; k < 3; k++) {
+        cilantro::PointFeaturesAdaptor3f dst_feat(dst.points), src_feat(src.points);
+        cilantro::DistanceEvaluator<float> dist_eval;
+        cilantro::CorrespondenceSearchKDTree<cilantro::PointFeaturesAdaptor3f> corr_engine(dst_feat, src_feat, dist_eval);
+        corr_engine.setSearchDirection(directions[k]).setMaxDistance(0.1f*0.1f);
+
+        sampler.setSeed(0);
+        cilantro::CorrespondenceSearchSubsampled<decltype(corr_engine),SamplerT> sampled_corr_engine(corr_engine, sampler);
+
+        cilantro::UnityWeightEvaluator<float> weight_eval;
+        cilantro::CombinedMetricRigidTransformICP3f<decltype(sampled_corr_engine)> icp(dst.points, dst.normals, src.points, sampled_corr_engine, weight_eval, weight_eval);
+        icp.setMaxNumberOfIterations(30).setConvergenceTolerance(1e-4f);
+
+        cilantro::Timer timer;
+        timer.start();
+        const cilantro::RigidTransform3f tf_est = icp.estimate().getTransform();
+        timer.stop();
+
+        std::cout << name << ", " << direction_names[k] << ": " << timer.getElapsedTime() << "ms, "
+                  << icp.getNumberOfPerformedIterations() << " iterations, "
+                  << corr_engine.getCorrespondences().size() << " correspondences in the last one, "
+                  << "transform error: " << ((tf_est*tf_ref).matrix() - Eigen::Matrix4f::Identity()).norm() << std::endl;
+    }
+}
+
+int main(int argc, char ** argv) {
+    if (argc < 2) {
+        std::cout << "Please provide path to PLY file." << std::endl;
+        return 0;
+    }
+
+    cilantro::PointCloud3f dst(argv[1]);
+    if (!dst.hasNormals()) {
+        std::cout << "Input cloud is empty or does not have normals!" << std::endl;
+        return 0;
+    }
+
+    dst.gridDownsample(0.005f).removeInvalidData();
+
+    // Perturb and displace a copy of the target
+    cilantro::PointCloud3f src(dst);
+    for (size_t i = 0; i < src.size(); i++) {
+        src.points.col(i) += 0.002f*Eigen::Vector3f::Random();
+    }
+
+    cilantro::RigidTransform3f tf_ref;
+    tf_ref.linear() = (Eigen::AngleAxisf(-0.05f, Eigen::Vector3f::UnitZ())*Eigen::AngleAxisf(0.05f, Eigen::Vector3f::UnitY())).toRotationMatrix();
+    tf_ref.translation() = Eigen::Vector3f(-0.05f, -0.02f, 0.03f);
+    src.transform(tf_ref);
+
+    const size_t num_samples = std::min<size_t>(2000, src.size());
+    std::cout << "Sampling " << num_samples << " of " << src.size() << " source points per iteration" << std::endl;
+
+    cilantro::UniformRandomPointSampler uniform_sampler(src.size(), num_samples);
+    run_and_report(dst, src, tf_ref, uniform_sampler, "Uniform");
+
+    cilantro::NormalSpacePointSampler3f normal_space_sampler(src.normals, num_samples);
+    run_and_report(dst, src, tf_ref, normal_space_sampler, "Normal space");
+
+    cilantro::CovarianceStablePointSampler3f covariance_sampler(src.points, src.normals, num_samples);
+    run_and_report(dst, src, tf_ref, covariance_sampler, "Covariance stable");
+
+    return 0;
+}
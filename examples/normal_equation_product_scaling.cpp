@@ -0,0 +1,77 @@
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include <iostream>
+#include <cilantro/kd_tree.hpp>
+#include <cilantro/sparse_normal_equation_product.hpp>
+#include <cilantro/timer.hpp>
+
+// Thread scaling of the normal equations assembly (At*At^T) for a synthetic sparse rigid warp field over a
+// 50k node graph: point-to-plane data terms over 4 nodes each, and 8-neighbor node regularization
+int main() {
+    const size_t num_nodes = 50000;
+    const size_t num_points = 8*num_nodes;
+    const size_t num_params = 6;
+
+    std::srand(0);
+    cilantro::VectorSet3f nodes = cilantro::VectorSet3f::Random(3, num_nodes);
+    cilantro::VectorSet3f points = cilantro::VectorSet3f::Random(3, num_points);
+    cilantro::KDTree3f tree(nodes);
+
+    std::vector<cilantro::NeighborSet<float>> point_nbhds, node_nbhds;
+    tree.search(points, cilantro::kNNNeighborhood<float>(4), point_nbhds);
+    tree.search(nodes, cilantro::kNNNeighborhood<float>(9), node_nbhds);
+
+    // Random values on the Jacobian structure of the warp field estimators
+    std::vector<Eigen::Triplet<float>> entries;
+    size_t eq = 0;
+    for (size_t i = 0; i < num_points; i++, eq++) {
+        for (size_t j = 0; j < point_nbhds[i].size(); j++) {
+            for (size_t k = 0; k < num_params; k++) {
+                entries.emplace_back(num_params*point_nbhds[i][j].index + k, eq, (float)std::rand()/RAND_MAX - 0.5f);
+            }
+        }
+    }
+    for (size_t i = 0; i < num_nodes; i++) {
+        for (size_t j = 1; j < node_nbhds[i].size(); j++) {
+            for (size_t k = 0; k < num_params; k++, eq++) {
+                entries.emplace_back(num_params*i + k, eq, 1.0f);
+                entries.emplace_back(num_params*node_nbhds[i][j].index + k, eq, -1.0f);
+            }
+        }
+    }
+    Eigen::SparseMatrix<float> At(num_params*num_nodes, eq);
+    At.setFromTriplets(entries.begin(), entries.end());
+
+    std::cout << "At: " << At.rows() << "x" << At.cols() << ", " << At.nonZeros() << " nonzeros" << std::endl;
+
+    cilantro::Timer timer;
+    timer.start();
+    Eigen::SparseMatrix<float> AtA_ref = At*At.transpose();
+    timer.stop();
+    std::cout << "Eigen At*At^T: " << timer.getElapsedTime() << "ms, " << AtA_ref.nonZeros() << " nonzeros" << std::endl;
+
+    const size_t num_runs = 5;
+    for (int num_threads = 1; num_threads <= 32; num_threads *= 2) {
+#ifdef _OPENMP
+        omp_set_num_threads(num_threads);
+#endif
+        cilantro::SparseNormalEquationProduct<float> product;
+
+        // The first call includes the symbolic analysis
+        timer.start();
+        product.compute(At);
+        timer.stop();
+        const double first_time = timer.getElapsedTime();
+
+        timer.start();
+        for (size_t r = 0; r < num_runs; r++) product.compute(At);
+        timer.stop();
+
+        std::cout << num_threads << " threads: " << first_time << "ms first call, "
+                  << timer.getElapsedTime()/num_runs << "ms per value refill, "
+                  << "max deviation: " << Eigen::SparseMatrix<float>(product.getMatrix() - AtA_ref).coeffs().cwiseAbs().maxCoeff() << std::endl;
+    }
+
+    return 0;
+}
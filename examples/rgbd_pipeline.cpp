@@ -0,0 +1,105 @@
+#include <iostream>
+#include <cilantro/frame_pipeline.hpp>
+#include <cilantro/icp_common_instances.hpp>
+
+// Writes a short synthetic sequence (a box in front of a slanted wall, over a floor, seen by a translating
+// camera)
+void write_synthetic_sequence(const std::string &depth_pattern, const std::string &rgb_pattern,
+                              size_t w, size_t h, const Eigen::Matrix3f &K, size_t num_frames)
+{
+    std::vector<unsigned short> depth(w*h);
+    std::vector<unsigned char> rgb(3*w*h);
+    std::vector<char> name(depth_pattern.size() + rgb_pattern.size() + 32);
+    for (size_t f = 0; f < num_frames; f++) {
+        const float cam_x = 0.005f*f;
+        for (size_t y = 0; y < h; y++) {
+            for (size_t x = 0; x < w; x++) {
+                const float rx = (x - K(0,2))/K(0,0), ry = (y - K(1,2))/K(1,1);
+                // Wall: z = 2 + 0.3*X (in world coordinates), floor at y = 0.5, box face at z = 1.2
+                float z = (2.0f + 0.3f*cam_x)/(1.0f - 0.3f*rx);
+                if (ry > 0.0f) z = std::min(z, 0.5f/ry);
+                const float bx = cam_x + 1.2f*rx, by = 1.2f*ry;
+                if (bx > -0.2f && bx < 0.2f && by > -0.3f && by < 0.1f) z = 1.2f;
+                depth[y*w + x] = (unsigned short)(1000.0f*z);
+                rgb[3*(y*w + x)] = (unsigned char)(255*x/w);
+                rgb[3*(y*w + x) + 1] = (unsigned char)(255*y/h);
+                rgb[3*(y*w + x) + 2] = (z < 1.5f) ? 255 : 0;
+            }
+        }
+        std::snprintf(name.data(), name.size(), depth_pattern.c_str(), f);
+        cilantro::writeRawDataToFile(name.data(), depth.data(), depth.size()*sizeof(unsigned short));
+        std::snprintf(name.data(), name.size(), rgb_pattern.c_str(), f);
+        cilantro::writeRawDataToFile(name.data(), rgb.data(), rgb.size());
+    }
+}
+
+int main(int argc, char ** argv) {
+    const size_t w = 640, h = 480;
+    Eigen::Matrix3f K;
+    K << 525, 0, 319.5, 0, 525, 239.5, 0, 0, 1;
+
+    std::string depth_pattern, rgb_pattern;
+    if (argc < 3) {
+        std::cout << "Usage: " << argv[0] << " <depth file pattern> <RGB file pattern> (e.g. depth_%06zu.raw rgb_%06zu.raw)" << std::endl;
+        std::cout << "No input given, writing a synthetic sequence to the working directory" << std::endl;
+        depth_pattern = "depth_%06zu.raw";
+        rgb_pattern = "rgb_%06zu.raw";
+        write_synthetic_sequence(depth_pattern, rgb_pattern, w, h, K, 30);
+    } else {
+        depth_pattern = argv[1];
+        rgb_pattern = argv[2];
+    }
+
+    cilantro::TruncatedDepthValueConverter<unsigned short,float> dc(1000.0f, 3.0f);
+    cilantro::DepthImageBackProjector<float> back_projector(w, h, K);
+    cilantro::RGBDFileSource<unsigned short> source(depth_pattern, rgb_pattern, w, h);
+
+    // Stage state: the previous frame (tracking) and the fused model (integration)
+    cilantro::PointCloud3f previous, model;
+    cilantro::RigidTransform3f pose(cilantro::RigidTransform3f::Identity());
+
+    cilantro::FramePipeline<cilantro::RGBDFramef> pipeline(4, cilantro::RGBDFramef(w, h));
+    pipeline.setSource(source.getPipelineSource<float>());
+
+    // Convert
+    pipeline.addStage([&](cilantro::RGBDFramef &frame) {
+        frame.cloud.fromRGBDImages(back_projector, frame.rgb.data(), frame.depth.data(), dc).estimateNormals(3);
+    });
+
+    // Track (frame to frame)
+    pipeline.addStage([&](cilantro::RGBDFramef &frame) {
+        cilantro::PointCloud3f current(frame.cloud.toPointCloud());
+        current.removeInvalidNormals();
+        if (!previous.isEmpty()) {
+            cilantro::SimpleCombinedMetricRigidProjectiveICP3f icp(previous.points, previous.normals, current.points);
+            icp.correspondenceSearchEngine().setMaxDistance(0.05f*0.05f).setProjectionImageWidth(w)
+                    .setProjectionImageHeight(h).setProjectionIntrinsicMatrix(K);
+            icp.setConvergenceTolerance(5e-4f).setMaxNumberOfIterations(10).setMaxNumberOfOptimizationStepIterations(1);
+            pose = pose*icp.estimate().getTransform();
+        }
+        frame.pose = pose;
+        previous = current;
+    });
+
+    // Integrate
+    pipeline.addStage([&](cilantro::RGBDFramef &frame) {
+        model.append(frame.cloud.toPointCloud().removeInvalidNormals().transform(frame.pose));
+        model.gridDownsample(0.01f);
+    });
+
+    pipeline.run();
+
+    const std::vector<double>& busy = pipeline.getBusyTimes();
+    double sum = 0.0, slowest = 0.0;
+    const char* names[] = {"Ingest", "Convert", "Track", "Integrate"};
+    for (size_t i = 0; i < busy.size(); i++) {
+        std::cout << names[i] << ": " << busy[i] << "ms" << std::endl;
+        sum += busy[i];
+        slowest = std::max(slowest, busy[i]);
+    }
+    std::cout << "Processed " << pipeline.getNumberOfProcessedFrames() << " frames in " << pipeline.getElapsedTime()
+              << "ms (sum of stages: " << sum << "ms, slowest stage: " << slowest << "ms)" << std::endl;
+    std::cout << "Final camera translation: " << pose.translation().transpose() << ", model points: " << model.size() << std::endl;
+
+    return 0;
+}
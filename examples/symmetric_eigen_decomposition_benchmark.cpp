@@ -0,0 +1,83 @@
+#include <iostream>
+#include <cilantro/normal_estimation.hpp>
+#include <cilantro/principal_component_analysis.hpp>
+#include <cilantro/timer.hpp>
+
+// Throughput of the closed-form 3x3 symmetric eigen-decomposition against Eigen's iterative solver, on the
+// local covariances of 1M points sampled from a noisy surface, and of normal estimation as a whole
+int main() {
+    const size_t num_points = 1000000;
+    const size_t k = 10;
+
+    std::srand(0);
+    cilantro::VectorSet3f points(3, num_points);
+    points.topRows(2) = cilantro::VectorSet<float,2>::Random(2, num_points);
+    points.row(2) = 0.2f*(3.0f*points.row(0)).array().sin()*(2.0f*points.row(1)).array().cos() + 0.001f*Eigen::RowVectorXf::Random(num_points).array();
+
+    cilantro::KDTree3f tree(points);
+
+    std::vector<Eigen::Matrix3f> covariances(num_points);
+    cilantro::NeighborSet<float> nn;
+#pragma omp parallel for private (nn)
+    for (size_t i = 0; i < num_points; i++) {
+        tree.kNNSearch(points.col(i), k, nn);
+        Eigen::Vector3f mean(Eigen::Vector3f::Zero());
+        for (size_t j = 0; j < nn.size(); j++) mean += points.col(nn[j].index);
+        mean /= (float)nn.size();
+        covariances[i].setZero();
+        for (size_t j = 0; j < nn.size(); j++) {
+            const Eigen::Vector3f tmp = points.col(nn[j].index) - mean;
+            covariances[i] += tmp*tmp.transpose();
+        }
+        covariances[i] /= (float)(nn.size() - 1);
+    }
+
+    cilantro::VectorSet3f normals_iterative(3, num_points), normals_closed_form(3, num_points);
+    std::vector<float> smallest_iterative(num_points), smallest_closed_form(num_points);
+    cilantro::Timer timer;
+
+    timer.start();
+#pragma omp parallel for
+    for (size_t i = 0; i < num_points; i++) {
+        Eigen::SelfAdjointEigenSolver<Eigen::Matrix3f> eig(covariances[i]);
+        normals_iterative.col(i) = eig.eigenvectors().col(0);
+        smallest_iterative[i] = eig.eigenvalues()[0];
+    }
+    timer.stop();
+    std::cout << "Iterative (Eigen::SelfAdjointEigenSolver): " << timer.getElapsedTime() << "ms" << std::endl;
+
+    timer.start();
+#pragma omp parallel for
+    for (size_t i = 0; i < num_points; i++) {
+        Eigen::Vector3f eigenvalues;
+        Eigen::Matrix3f eigenvectors;
+        cilantro::computeSymmetricEigenDecomposition<float,3>(covariances[i], eigenvalues, eigenvectors);
+        normals_closed_form.col(i) = eigenvectors.col(0);
+        smallest_closed_form[i] = eigenvalues[0];
+    }
+    timer.stop();
+    std::cout << "Closed form, full decomposition: " << timer.getElapsedTime() << "ms" << std::endl;
+
+    timer.start();
+#pragma omp parallel for
+    for (size_t i = 0; i < num_points; i++) {
+        cilantro::computeSymmetricSmallestEigenPair<float,3>(covariances[i], smallest_closed_form[i], normals_closed_form.col(i));
+    }
+    timer.stop();
+    std::cout << "Closed form, smallest eigenpair: " << timer.getElapsedTime() << "ms" << std::endl;
+
+    float max_angle = 0.0f, max_eigenvalue_error = 0.0f;
+    for (size_t i = 0; i < num_points; i++) {
+        max_angle = std::max(max_angle, std::acos(std::min(1.0f, std::abs(normals_iterative.col(i).dot(normals_closed_form.col(i))))));
+        max_eigenvalue_error = std::max(max_eigenvalue_error, std::abs(smallest_iterative[i] - smallest_closed_form[i])/covariances[i].trace());
+    }
+    std::cout << "Max normal angle difference: " << max_angle << " rad, max relative smallest eigenvalue difference: " << max_eigenvalue_error << std::endl;
+
+    timer.start();
+    cilantro::NormalEstimation3f ne(tree);
+    cilantro::VectorSet3f normals = ne.estimateNormalsKNN(k);
+    timer.stop();
+    std::cout << "Normal estimation (" << k << "-NN): " << timer.getElapsedTime() << "ms" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include <cilantro/icp_common_instances.hpp>
+#include <cilantro/sparse_warp_field_hierarchy.hpp>
+#include <cilantro/point_cloud.hpp>
+#include <cilantro/timer.hpp>
+
+// Compares single-level sparse non-rigid registration with coarse-to-fine registration over a node hierarchy,
+// with and without the multigrid (V-cycle) conjugate gradient preconditioner
+int main(int argc, char ** argv) {
+    if (argc < 3) {
+        std::cout << "Please provide paths to two PLY files." << std::endl;
+        return 0;
+    }
+
+    cilantro::PointCloud3f dst(argv[1]), src(argv[2]);
+    if (!dst.hasNormals()) {
+        std::cout << "Target point cloud is empty or does not have normals!" << std::endl;
+        return 0;
+    }
+
+    const float control_res = 0.025f;
+    cilantro::SparseWarpFieldHierarchy<cilantro::RigidTransform<float,3>> hierarchy(src.points, control_res, 3);
+
+    for (size_t l = 0; l < hierarchy.getNumberOfLevels(); l++) {
+        std::cout << "Level " << l << ": " << hierarchy.getNumberOfNodes(l) << " nodes" << std::endl;
+    }
+
+    const size_t num_configs = 4;
+    const bool coarse_to_fine[] = {false, false, true, true};
+    const cilantro::ConjugateGradientPreconditioner preconditioners[] = {cilantro::ConjugateGradientPreconditioner::BLOCK_JACOBI, cilantro::ConjugateGradientPreconditioner::MULTILEVEL, cilantro::ConjugateGradientPreconditioner::BLOCK_JACOBI, cilantro::ConjugateGradientPreconditioner::MULTILEVEL};
+    const std::string config_names[] = {"single level", "single level + multigrid", "coarse-to-fine", "coarse-to-fine + multigrid"};
+
+    for (size_t k = 0; k < num_configs; k++) {
+        size_t num_icp_iterations = 0, num_cg_iterations = 0;
+        cilantro::TransformSet<cilantro::RigidTransform<float,3>> transforms;
+
+        cilantro::Timer timer;
+        timer.start();
+        const size_t start_level = coarse_to_fine[k] ? hierarchy.getNumberOfLevels() - 1 : 0;
+        for (size_t l = start_level + 1; l-- > 0;) {
+            // Coarser levels are only responsible for the large scale motion
+            const float res = hierarchy.getNodeResolution(l);
+            cilantro::SimpleCombinedMetricSparseRigidWarpFieldICP3f icp(dst.points, dst.normals, src.points, hierarchy.getSkinningNeighborhoods(l), hierarchy.getNumberOfNodes(l), hierarchy.getRegularizationNeighborhoods(l));
+            icp.correspondenceSearchEngine().setMaxDistance(0.02f*0.02f);
+            icp.controlWeightEvaluator().setSigma(0.5f*res);
+            icp.regularizationWeightEvaluator().setSigma(3.0f*res);
+            icp.setMaxNumberOfIterations((l > 0) ? 5 : 15).setConvergenceTolerance(2.5e-3f);
+            icp.setMaxNumberOfGaussNewtonIterations(1).setGaussNewtonConvergenceTolerance(5e-4f);
+            icp.setMaxNumberOfConjugateGradientIterations(500).setConjugateGradientConvergenceTolerance(1e-5f);
+            icp.setPointToPointMetricWeight(0.0f).setPointToPlaneMetricWeight(1.0f).setStiffnessRegularizationWeight(200.0f);
+            icp.setHuberLossBoundary(1e-2f);
+            icp.setConjugateGradientPreconditioner(preconditioners[k]);
+            if (preconditioners[k] == cilantro::ConjugateGradientPreconditioner::MULTILEVEL) {
+                icp.setMultilevelPreconditionerProlongations(hierarchy.getProlongationOperators(l));
+            }
+            if (l < start_level) {
+                icp.setInitialTransform(hierarchy.prolongateTransforms(l, transforms));
+            }
+
+            icp.estimate();
+            transforms = icp.getTransform();
+            num_icp_iterations += icp.getNumberOfPerformedIterations();
+            num_cg_iterations += icp.getNumberOfPerformedConjugateGradientIterations();
+
+            if (l == 0) {
+                timer.stop();
+                std::cout << config_names[k] << ": " << timer.getElapsedTime() << "ms, "
+                          << num_icp_iterations << " ICP iterations, "
+                          << num_cg_iterations << " CG iterations, "
+                          << "mean residual: " << icp.getResiduals().mean() << std::endl;
+            }
+        }
+    }
+
+    return 0;
+}
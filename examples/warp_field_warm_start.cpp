@@ -0,0 +1,89 @@
+#include <cilantro/icp_common_instances.hpp>
+#include <cilantro/point_cloud.hpp>
+#include <cilantro/timer.hpp>
+
+// Compares cold-started CG with warm-started CG and adaptive (inexact Newton) CG tolerances for non-rigid registration
+template <class ICPT>
+void run_and_report(ICPT &icp, const std::string &name) {
+    cilantro::Timer timer;
+    timer.start();
+    icp.estimate();
+    timer.stop();
+
+    std::cout << name << ": " << timer.getElapsedTime() << "ms, "
+              << icp.getNumberOfPerformedIterations() << " ICP iterations, "
+              << icp.getNumberOfPerformedConjugateGradientIterations() << " CG iterations, "
+              << "mean residual: " << icp.getResiduals().mean() << std::endl;
+}
+
+int main(int argc, char ** argv) {
+    if (argc < 3) {
+        std::cout << "Please provide paths to two PLY files." << std::endl;
+        return 0;
+    }
+
+    cilantro::PointCloud3f dst(argv[1]), src(argv[2]);
+    if (!dst.hasNormals()) {
+        std::cout << "Target point cloud is empty or does not have normals!" << std::endl;
+        return 0;
+    }
+
+    const bool warm_start[] = {false, true, false, true};
+    const bool adaptive_tolerance[] = {false, false, true, true};
+    const std::string config_names[] = {"cold start", "warm start", "adaptive tolerance", "warm start + adaptive tolerance"};
+
+    // Sparsely supported warp field
+    float control_res = 0.025f;
+    float src_to_control_sigma = 0.5f*control_res;
+    float regularization_sigma = 3.0f*control_res;
+
+    cilantro::VectorSet<float,3> control_points = cilantro::PointsGridDownsampler3f(src.points, control_res).getDownsampledPoints();
+    cilantro::KDTree<float,3> control_tree(control_points);
+
+    std::vector<cilantro::NeighborSet<float>> src_to_control_nn;
+    control_tree.search(src.points, cilantro::kNNNeighborhood<float>(4), src_to_control_nn);
+
+    std::vector<cilantro::NeighborSet<float>> control_regularization_nn;
+    control_tree.search(control_points, cilantro::kNNNeighborhood<float>(8), control_regularization_nn);
+
+    for (size_t k = 0; k < 4; k++) {
+        cilantro::SimpleCombinedMetricSparseRigidWarpFieldICP3f icp(dst.points, dst.normals, src.points, src_to_control_nn, control_points.cols(), control_regularization_nn);
+        icp.correspondenceSearchEngine().setMaxDistance(0.02f*0.02f);
+        icp.controlWeightEvaluator().setSigma(src_to_control_sigma);
+        icp.regularizationWeightEvaluator().setSigma(regularization_sigma);
+        icp.setMaxNumberOfIterations(15).setConvergenceTolerance(2.5e-3f);
+        icp.setMaxNumberOfGaussNewtonIterations(1).setGaussNewtonConvergenceTolerance(5e-4f);
+        icp.setMaxNumberOfConjugateGradientIterations(500).setConjugateGradientConvergenceTolerance(1e-5f);
+        icp.setPointToPointMetricWeight(0.0f).setPointToPlaneMetricWeight(1.0f).setStiffnessRegularizationWeight(200.0f);
+        icp.setHuberLossBoundary(1e-2f);
+        icp.setUseWarmStartedConjugateGradient(warm_start[k]).setUseAdaptiveConjugateGradientTolerance(adaptive_tolerance[k]);
+
+        run_and_report(icp, "Sparse warp field, " + config_names[k]);
+    }
+
+    // Densely supported warp field
+    float res = 0.005f;
+    regularization_sigma = 3.0f*res;
+
+    dst.gridDownsample(res).removeInvalidData();
+    src.gridDownsample(res).removeInvalidData();
+
+    std::vector<cilantro::NeighborSet<float>> regularization_nn;
+    cilantro::KDTree3f(src.points).search(src.points, cilantro::kNNNeighborhood<float>(12), regularization_nn);
+
+    for (size_t k = 0; k < 4; k++) {
+        cilantro::SimpleCombinedMetricDenseRigidWarpFieldICP3f icp(dst.points, dst.normals, src.points, regularization_nn);
+        icp.correspondenceSearchEngine().setMaxDistance(0.04f*0.04f);
+        icp.regularizationWeightEvaluator().setSigma(regularization_sigma);
+        icp.setMaxNumberOfIterations(15).setConvergenceTolerance(2.5e-3f);
+        icp.setMaxNumberOfGaussNewtonIterations(1).setGaussNewtonConvergenceTolerance(5e-4f);
+        icp.setMaxNumberOfConjugateGradientIterations(500).setConjugateGradientConvergenceTolerance(1e-5f);
+        icp.setPointToPointMetricWeight(0.1f).setPointToPlaneMetricWeight(1.0f).setStiffnessRegularizationWeight(200.0f);
+        icp.setHuberLossBoundary(1e-2f);
+        icp.setUseWarmStartedConjugateGradient(warm_start[k]).setUseAdaptiveConjugateGradientTolerance(adaptive_tolerance[k]);
+
+        run_and_report(icp, "Dense warp field, " + config_names[k]);
+    }
+
+    return 0;
+}
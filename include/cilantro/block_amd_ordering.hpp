@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include <Eigen/Sparse>
+
+namespace cilantro {
+    // Fill-reducing ordering functor for Eigen's sparse direct solvers (drop-in replacement for
+    // Eigen::AMDOrdering) for systems made of BlockSize x BlockSize node blocks: the approximate minimum
+    // degree ordering is computed on the (much smaller) node graph and expanded block-wise, so that the
+    // unknowns of each node stay contiguous. Falls back to plain AMD if the size is not a multiple of BlockSize.
+    template <typename StorageIndexT, ptrdiff_t BlockSize>
+    class BlockAMDOrdering {
+    public:
+        typedef Eigen::PermutationMatrix<Eigen::Dynamic,Eigen::Dynamic,StorageIndexT> PermutationType;
+
+        template <typename MatrixT>
+        void operator()(const MatrixT &mat, PermutationType &perm) {
+            if (mat.cols() % BlockSize != 0) {
+                Eigen::AMDOrdering<StorageIndexT>()(mat, perm);
+                return;
+            }
+
+            const StorageIndexT num_nodes = (StorageIndexT)(mat.cols()/BlockSize);
+
+            std::vector<Eigen::Triplet<typename MatrixT::Scalar,StorageIndexT>> node_arcs;
+            node_arcs.reserve(mat.nonZeros()/(BlockSize*BlockSize) + num_nodes);
+            for (StorageIndexT j = 0; j < mat.outerSize(); j++) {
+                const StorageIndexT node_j = j/BlockSize;
+                StorageIndexT last_node_i = -1;
+                for (typename MatrixT::InnerIterator it(mat, j); it; ++it) {
+                    const StorageIndexT node_i = (StorageIndexT)(it.index()/BlockSize);
+                    if (node_i == last_node_i) continue;
+                    node_arcs.emplace_back(node_i, node_j, (typename MatrixT::Scalar)1.0);
+                    last_node_i = node_i;
+                }
+            }
+
+            Eigen::SparseMatrix<typename MatrixT::Scalar,Eigen::ColMajor,StorageIndexT> node_graph(num_nodes, num_nodes);
+            node_graph.setFromTriplets(node_arcs.begin(), node_arcs.end());
+
+            PermutationType node_perm;
+            Eigen::AMDOrdering<StorageIndexT>()(node_graph, node_perm);
+
+            perm.resize(mat.cols());
+            for (StorageIndexT k = 0; k < num_nodes; k++) {
+                for (StorageIndexT c = 0; c < BlockSize; c++) {
+                    perm.indices()[BlockSize*k + c] = BlockSize*node_perm.indices()[k] + c;
+                }
+            }
+        }
+    };
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <cilantro/sparse_normal_equation_operator.hpp>
+
+namespace cilantro {
+    // Block-Jacobi preconditioner for Eigen's iterative solvers (drop-in replacement for
+    // Eigen::DiagonalPreconditioner). The diagonal BlockSize x BlockSize blocks of the system matrix are
+    // inverted once per factorize() call; applying the preconditioner is a block-wise matrix-vector product.
+    // Blocks that are not positive definite (e.g. unconstrained nodes) fall back to Jacobi scaling.
+    // BlockSize = 1 gives plain Jacobi scaling, also for matrix-free SparseNormalEquationOperator systems.
+    template <typename ScalarT, ptrdiff_t BlockSize>
+    class BlockDiagonalPreconditioner {
+        typedef Eigen::Matrix<ScalarT,Eigen::Dynamic,1> Vector;
+
+    public:
+        typedef typename Vector::StorageIndex StorageIndex;
+
+        enum {
+            ColsAtCompileTime = Eigen::Dynamic,
+            MaxColsAtCompileTime = Eigen::Dynamic
+        };
+
+        BlockDiagonalPreconditioner() : size_(0), is_initialized_(false) {}
+
+        template <typename MatT>
+        explicit BlockDiagonalPreconditioner(const MatT &mat) : size_(0), is_initialized_(false) { compute(mat); }
+
+        inline Eigen::Index rows() const { return size_; }
+
+        inline Eigen::Index cols() const { return size_; }
+
+        template <typename MatT>
+        inline BlockDiagonalPreconditioner& analyzePattern(const MatT &) { return *this; }
+
+        template <typename MatT>
+        BlockDiagonalPreconditioner& factorize(const MatT &mat) {
+            return factorize_(mat.cols(), [&mat](size_t start) -> Eigen::Matrix<ScalarT,BlockSize,BlockSize> {
+                Eigen::Matrix<ScalarT,BlockSize,BlockSize> block(Eigen::Matrix<ScalarT,BlockSize,BlockSize>::Zero());
+                for (size_t j = 0; j < BlockSize; j++) {
+                    for (typename MatT::InnerIterator it(mat, start + j); it; ++it) {
+                        if ((size_t)it.index() >= start && (size_t)it.index() < start + BlockSize) {
+                            block(it.index() - start, j) = it.value();
+                        }
+                    }
+                }
+                return block;
+            }, [&mat](size_t j) -> ScalarT {
+                ScalarT diag = (ScalarT)0.0;
+                for (typename MatT::InnerIterator it(mat, j); it; ++it) {
+                    if ((size_t)it.index() == j) diag = it.value();
+                }
+                return diag;
+            });
+        }
+
+        // Matrix-free normal equations: all diagonal blocks are computed in one pass over the Jacobian
+        BlockDiagonalPreconditioner& factorize(const SparseNormalEquationOperator<ScalarT> &op) {
+            Eigen::Matrix<ScalarT,BlockSize,Eigen::Dynamic> blocks;
+            op.template computeDiagonalBlocks<BlockSize>(blocks);
+            return factorize_(op.cols(), [&blocks](size_t start) -> Eigen::Matrix<ScalarT,BlockSize,BlockSize> {
+                return blocks.template block<BlockSize,BlockSize>(0, start);
+            }, [&blocks](size_t j) -> ScalarT {
+                return blocks(j % BlockSize, j);
+            });
+        }
+
+        template <typename MatT>
+        inline BlockDiagonalPreconditioner& compute(const MatT &mat) { return factorize(mat); }
+
+        template <typename RhsT, typename DestT>
+        void _solve_impl(const RhsT &b, DestT &x) const {
+            const size_t num_blocks = inv_blocks_.cols()/BlockSize;
+#pragma omp parallel for
+            for (size_t k = 0; k < num_blocks; k++) {
+                x.template segment<BlockSize>(BlockSize*k).noalias() = inv_blocks_.template block<BlockSize,BlockSize>(0,BlockSize*k)*b.template segment<BlockSize>(BlockSize*k);
+            }
+            const size_t tail_start = BlockSize*num_blocks;
+            for (size_t j = 0; j < (size_t)inv_diag_tail_.size(); j++) {
+                x[tail_start + j] = inv_diag_tail_[j]*b[tail_start + j];
+            }
+        }
+
+        template <typename RhsT>
+        inline const Eigen::Solve<BlockDiagonalPreconditioner,RhsT> solve(const Eigen::MatrixBase<RhsT> &b) const {
+            eigen_assert(is_initialized_ && "BlockDiagonalPreconditioner is not initialized.");
+            eigen_assert(size_ == (size_t)b.rows() && "BlockDiagonalPreconditioner::solve(): invalid number of rows of the right hand side matrix b");
+            return Eigen::Solve<BlockDiagonalPreconditioner,RhsT>(*this, b.derived());
+        }
+
+        inline Eigen::ComputationInfo info() const { return Eigen::Success; }
+
+    private:
+        size_t size_;
+        Eigen::Matrix<ScalarT,BlockSize,Eigen::Dynamic> inv_blocks_;
+        Vector inv_diag_tail_;
+        bool is_initialized_;
+
+        template <class BlockGetterT, class DiagonalGetterT>
+        BlockDiagonalPreconditioner& factorize_(size_t size, const BlockGetterT &get_block, const DiagonalGetterT &get_diagonal) {
+            size_ = size;
+            const size_t num_blocks = size_/BlockSize;
+
+            inv_blocks_.resize(BlockSize, BlockSize*num_blocks);
+            inv_blocks_.setZero();
+            inv_diag_tail_.resize(size_ - BlockSize*num_blocks);
+
+#pragma omp parallel for
+            for (size_t k = 0; k < num_blocks; k++) {
+                const size_t start = BlockSize*k;
+                const Eigen::Matrix<ScalarT,BlockSize,BlockSize> block(get_block(start));
+                Eigen::LLT<Eigen::Matrix<ScalarT,BlockSize,BlockSize>> llt(block);
+                if (llt.info() == Eigen::Success) {
+                    inv_blocks_.template block<BlockSize,BlockSize>(0,start) = llt.solve(Eigen::Matrix<ScalarT,BlockSize,BlockSize>::Identity());
+                } else {
+                    for (size_t j = 0; j < BlockSize; j++) {
+                        inv_blocks_(j,start + j) = (block(j,j) == (ScalarT)0.0) ? (ScalarT)1.0 : (ScalarT)1.0/block(j,j);
+                    }
+                }
+            }
+
+            // Trailing entries that do not fill a whole block
+            for (size_t j = BlockSize*num_blocks; j < size_; j++) {
+                const ScalarT diag = get_diagonal(j);
+                inv_diag_tail_[j - BlockSize*num_blocks] = (diag == (ScalarT)0.0) ? (ScalarT)1.0 : (ScalarT)1.0/diag;
+            }
+
+            is_initialized_ = true;
+            return *this;
+        }
+    };
+}
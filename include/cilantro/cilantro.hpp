@@ -1,10 +1,13 @@
 #pragma once
 
 #include <cilantro/accumulators.hpp>
+#include <cilantro/block_amd_ordering.hpp>
+#include <cilantro/block_diagonal_preconditioner.hpp>
 #include <cilantro/colormap.hpp>
 #include <cilantro/common_pair_evaluators.hpp>
 #include <cilantro/common_renderables.hpp>
 #include <cilantro/common_transformable_feature_adaptors.hpp>
+#include <cilantro/compact_transform_set.hpp>
 #include <cilantro/connected_component_segmentation.hpp>
 #include <cilantro/convex_hull_utilities.hpp>
 #include <cilantro/convex_polytope.hpp>
@@ -15,8 +18,12 @@
 #include <cilantro/correspondence_search_kd_tree_utilities.hpp>
 #include <cilantro/correspondence_search_oracle.hpp>
 #include <cilantro/correspondence_search_projective.hpp>
+#include <cilantro/correspondence_search_subsampled.hpp>
 #include <cilantro/data_containers.hpp>
+#include <cilantro/deformation_graph.hpp>
+#include <cilantro/depth_image_pyramid.hpp>
 #include <cilantro/flat_convex_hull_3d.hpp>
+#include <cilantro/frame_pipeline.hpp>
 #include <cilantro/grid_accumulator.hpp>
 #include <cilantro/grid_downsampler.hpp>
 #include <cilantro/icp_base.hpp>
@@ -27,16 +34,24 @@
 #include <cilantro/icp_warp_field_combined_metric_sparse.hpp>
 #include <cilantro/image_point_cloud_conversions.hpp>
 #include <cilantro/image_viewer.hpp>
+#include <cilantro/integral_image_normal_estimation.hpp>
 #include <cilantro/io.hpp>
 #include <cilantro/kd_tree.hpp>
 #include <cilantro/kmeans.hpp>
 #include <cilantro/mean_shift.hpp>
+#include <cilantro/morton_order.hpp>
 #include <cilantro/multidimensional_scaling.hpp>
+#include <cilantro/multilevel_preconditioner.hpp>
+#include <cilantro/multiscale_geometric_features.hpp>
 #include <cilantro/nearest_neighbor_graph_utilities.hpp>
 #include <cilantro/nearest_neighbors.hpp>
+#include <cilantro/normal_equation_accumulator.hpp>
 #include <cilantro/normal_estimation.hpp>
 #include <cilantro/omp_reductions.hpp>
+#include <cilantro/organized_point_cloud.hpp>
 #include <cilantro/point_cloud.hpp>
+#include <cilantro/point_cloud_preprocessor.hpp>
+#include <cilantro/point_samplers.hpp>
 #include <cilantro/principal_component_analysis.hpp>
 #include <cilantro/ransac_base.hpp>
 #include <cilantro/ransac_hyperplane_estimator.hpp>
@@ -44,10 +59,15 @@
 #include <cilantro/renderable.hpp>
 #include <cilantro/space_region.hpp>
 #include <cilantro/space_transformations.hpp>
+#include <cilantro/sparse_normal_equation_operator.hpp>
+#include <cilantro/sparse_normal_equation_product.hpp>
+#include <cilantro/sparse_warp_field_hierarchy.hpp>
 #include <cilantro/spectral_clustering.hpp>
+#include <cilantro/symmetric_eigen_decomposition.hpp>
 #include <cilantro/timer.hpp>
 #include <cilantro/transform_estimation.hpp>
 #include <cilantro/visualizer.hpp>
 #include <cilantro/visualizer_handler.hpp>
 #include <cilantro/warp_field_estimation.hpp>
+#include <cilantro/warp_field_skinning.hpp>
 #include <cilantro/warp_field_utilities.hpp>
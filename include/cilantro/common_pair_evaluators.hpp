@@ -101,6 +101,20 @@ namespace cilantro {
     template <typename ValueT>
     using AlwaysTrueEvaluator = UnityWeightEvaluator<ValueT,bool>;
 
+    // Marks evaluators whose output depends only on the value argument (and not on the point indices);
+    // correspondence search engines use this to skip materializing transformed features
+    template <class EvaluatorT>
+    struct IsValueOnlyEvaluator : std::false_type {};
+
+    template <typename ValueT, typename WeightT>
+    struct IsValueOnlyEvaluator<IdentityWeightEvaluator<ValueT,WeightT>> : std::true_type {};
+
+    template <typename ValueT, typename WeightT>
+    struct IsValueOnlyEvaluator<UnityWeightEvaluator<ValueT,WeightT>> : std::true_type {};
+
+    template <typename ValueT, typename WeightT, bool distances_are_squared>
+    struct IsValueOnlyEvaluator<RBFKernelWeightEvaluator<ValueT,WeightT,distances_are_squared>> : std::true_type {};
+
     // Proximity evaluators (return bool)
 
     template <typename ScalarT, ptrdiff_t EigenDim>
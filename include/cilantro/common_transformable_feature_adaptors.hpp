@@ -35,6 +35,16 @@ namespace cilantro {
             return *this;
         }
 
+        // Transforms only the given subset of features; the remaining transformed features are left untouched
+        template <class TransformT>
+        inline PointFeaturesAdaptor& transformFeatures(const TransformT &tform, const std::vector<size_t> &indices) {
+#pragma omp parallel for
+            for (size_t i = 0; i < indices.size(); i++) {
+                transformed_data_.col(indices[i]).noalias() = tform.linear()*data_map_.col(indices[i]) + tform.translation();
+            }
+            return *this;
+        }
+
         template <class TransformT>
         inline PointFeaturesAdaptor& transformFeatures(const TransformSet<TransformT> &tforms) {
 #pragma omp parallel for
@@ -44,6 +54,18 @@ namespace cilantro {
             return *this;
         }
 
+        // Computes the i-th transformed feature without writing to the transformed features buffer
+        template <class TransformT>
+        inline void getTransformedFeature(const TransformT &tform, size_t i, Vector<ScalarT,FeatureDimension> &result) const {
+            result.noalias() = tform.linear()*data_map_.col(i) + tform.translation();
+        }
+
+        // Stores an externally computed transformed feature (see getTransformedFeature)
+        inline PointFeaturesAdaptor& setTransformedFeature(size_t i, const Eigen::Ref<const Vector<ScalarT,FeatureDimension>> &feature) {
+            transformed_data_.col(i) = feature;
+            return *this;
+        }
+
         inline const ConstVectorSetMatrixMap<ScalarT,FeatureDimension>& getFeaturesMatrixMap() const {
             return data_map_;
         }
@@ -71,7 +93,9 @@ namespace cilantro {
                 : data_map_(data),
                   transformed_data_(data.rows(), data.cols()),
                   transformed_data_map_(transformed_data_)
-        {}
+        {
+            normal_weight_ = compute_normal_weight_();
+        }
 
         PointNormalFeaturesAdaptor(const ConstVectorSetMatrixMap<ScalarT,EigenDim> &points,
                                    const ConstVectorSetMatrixMap<ScalarT,EigenDim> &normals,
@@ -83,6 +107,7 @@ namespace cilantro {
         {
             data_.topRows(points.rows()) = points;
             data_.bottomRows(normals.rows()) = normal_weight*normals;
+            normal_weight_ = compute_normal_weight_();
         }
 
         PointNormalFeaturesAdaptor& transformFeatures() {
@@ -105,13 +130,36 @@ namespace cilantro {
                     res_col.tail(dim).noalias() = tform.linear()*data_col.tail(dim);
                 }
             } else {
-                const ScalarT normal_weight = (data_map_.cols() > 0) ? data_map_.template block<3,1>(dim,0).norm() : (ScalarT)0.0;
 #pragma omp parallel for
                 for (size_t i = 0; i < data_map_.cols(); i++) {
                     auto res_col = transformed_data_.col(i);
                     auto data_col = data_map_.col(i);
                     res_col.head(dim).noalias() = tform.linear()*data_col.head(dim) + tform.translation();
-                    res_col.tail(dim).noalias() = normal_weight*(tform.linear().inverse().transpose()*data_col.tail(dim)).normalized();
+                    res_col.tail(dim).noalias() = normal_weight_*(tform.linear().inverse().transpose()*data_col.tail(dim)).normalized();
+                }
+            }
+            return *this;
+        }
+
+        // Transforms only the given subset of features; the remaining transformed features are left untouched
+        template <class TransformT>
+        PointNormalFeaturesAdaptor& transformFeatures(const TransformT &tform, const std::vector<size_t> &indices) {
+            const size_t dim = data_map_.rows()/2;
+            if (int(TransformT::Mode) == int(Eigen::Isometry)) {
+#pragma omp parallel for
+                for (size_t i = 0; i < indices.size(); i++) {
+                    auto res_col = transformed_data_.col(indices[i]);
+                    auto data_col = data_map_.col(indices[i]);
+                    res_col.head(dim).noalias() = tform.linear()*data_col.head(dim) + tform.translation();
+                    res_col.tail(dim).noalias() = tform.linear()*data_col.tail(dim);
+                }
+            } else {
+#pragma omp parallel for
+                for (size_t i = 0; i < indices.size(); i++) {
+                    auto res_col = transformed_data_.col(indices[i]);
+                    auto data_col = data_map_.col(indices[i]);
+                    res_col.head(dim).noalias() = tform.linear()*data_col.head(dim) + tform.translation();
+                    res_col.tail(dim).noalias() = normal_weight_*(tform.linear().inverse().transpose()*data_col.tail(dim)).normalized();
                 }
             }
             return *this;
@@ -129,18 +177,37 @@ namespace cilantro {
                     res_col.tail(dim).noalias() = tforms[i].linear()*data_col.tail(dim);
                 }
             } else {
-                const ScalarT normal_weight = (data_map_.cols() > 0) ? data_map_.template block<3,1>(dim,0).norm() : (ScalarT)0.0;
 #pragma omp parallel for
                 for (size_t i = 0; i < data_map_.cols(); i++) {
                     auto res_col = transformed_data_.col(i);
                     auto data_col = data_map_.col(i);
                     res_col.head(dim).noalias() = tforms[i].linear()*data_col.head(dim) + tforms[i].translation();
-                    res_col.tail(dim).noalias() = normal_weight*(tforms[i].linear().inverse().transpose()*data_col.tail(dim)).normalized();
+                    res_col.tail(dim).noalias() = normal_weight_*(tforms[i].linear().inverse().transpose()*data_col.tail(dim)).normalized();
                 }
             }
             return *this;
         }
 
+        // Computes the i-th transformed feature without writing to the transformed features buffer
+        template <class TransformT>
+        inline void getTransformedFeature(const TransformT &tform, size_t i, Vector<ScalarT,FeatureDimension> &result) const {
+            const size_t dim = data_map_.rows()/2;
+            auto data_col = data_map_.col(i);
+            result.resize(data_map_.rows());
+            result.head(dim).noalias() = tform.linear()*data_col.head(dim) + tform.translation();
+            if (int(TransformT::Mode) == int(Eigen::Isometry)) {
+                result.tail(dim).noalias() = tform.linear()*data_col.tail(dim);
+            } else {
+                result.tail(dim).noalias() = normal_weight_*(tform.linear().inverse().transpose()*data_col.tail(dim)).normalized();
+            }
+        }
+
+        // Stores an externally computed transformed feature (see getTransformedFeature)
+        inline PointNormalFeaturesAdaptor& setTransformedFeature(size_t i, const Eigen::Ref<const Vector<ScalarT,FeatureDimension>> &feature) {
+            transformed_data_.col(i) = feature;
+            return *this;
+        }
+
         inline const ConstVectorSetMatrixMap<ScalarT,FeatureDimension>& getFeaturesMatrixMap() const {
             return data_map_;
         }
@@ -154,6 +221,12 @@ namespace cilantro {
         ConstVectorSetMatrixMap<ScalarT,FeatureDimension> data_map_;
         VectorSet<ScalarT,FeatureDimension> transformed_data_;
         ConstVectorSetMatrixMap<ScalarT,FeatureDimension> transformed_data_map_;
+        ScalarT normal_weight_;
+
+        // Normals are stored scaled by a common weight, which non-isometric transforms must preserve
+        inline ScalarT compute_normal_weight_() const {
+            return (data_map_.cols() > 0) ? data_map_.col(0).tail(data_map_.rows()/2).norm() : (ScalarT)0.0;
+        }
     };
 
     template <typename ScalarT, ptrdiff_t EigenDim>
@@ -204,6 +277,20 @@ namespace cilantro {
             return *this;
         }
 
+        // Transforms only the given subset of features; the remaining transformed features are left untouched
+        template <class TransformT>
+        PointColorFeaturesAdaptor& transformFeatures(const TransformT &tform, const std::vector<size_t> &indices) {
+            const size_t dim = data_map_.rows() - 3;
+#pragma omp parallel for
+            for (size_t i = 0; i < indices.size(); i++) {
+                auto res_col = transformed_data_.col(indices[i]);
+                auto data_col = data_map_.col(indices[i]);
+                res_col.head(dim).noalias() = tform.linear()*data_col.head(dim) + tform.translation();
+                res_col.tail(3) = data_col.tail(3);
+            }
+            return *this;
+        }
+
         template <class TransformT>
         PointColorFeaturesAdaptor& transformFeatures(const TransformSet<TransformT> &tforms) {
             const size_t dim = data_map_.rows() - 3;
@@ -217,6 +304,22 @@ namespace cilantro {
             return *this;
         }
 
+        // Computes the i-th transformed feature without writing to the transformed features buffer
+        template <class TransformT>
+        inline void getTransformedFeature(const TransformT &tform, size_t i, Vector<ScalarT,FeatureDimension> &result) const {
+            const size_t dim = data_map_.rows() - 3;
+            auto data_col = data_map_.col(i);
+            result.resize(data_map_.rows());
+            result.head(dim).noalias() = tform.linear()*data_col.head(dim) + tform.translation();
+            result.tail(3) = data_col.tail(3);
+        }
+
+        // Stores an externally computed transformed feature (see getTransformedFeature)
+        inline PointColorFeaturesAdaptor& setTransformedFeature(size_t i, const Eigen::Ref<const Vector<ScalarT,FeatureDimension>> &feature) {
+            transformed_data_.col(i) = feature;
+            return *this;
+        }
+
         inline const ConstVectorSetMatrixMap<ScalarT,FeatureDimension>& getFeaturesMatrixMap() const {
             return data_map_;
         }
@@ -245,7 +348,9 @@ namespace cilantro {
                 : data_map_(data),
                   transformed_data_(data.rows(), data.cols()),
                   transformed_data_map_(transformed_data_)
-        {}
+        {
+            normal_weight_ = compute_normal_weight_();
+        }
 
         PointNormalColorFeaturesAdaptor(const ConstVectorSetMatrixMap<ScalarT,EigenDim> &points,
                                         const ConstVectorSetMatrixMap<ScalarT,EigenDim> &normals,
@@ -259,6 +364,7 @@ namespace cilantro {
             data_.topRows(points.rows()) = points;
             data_.block(points.rows(),0,normals.rows(),normals.cols()) = normal_weight*normals;
             data_.bottomRows(3) = color_weight*colors.template cast<ScalarT>();
+            normal_weight_ = compute_normal_weight_();
         }
 
         PointNormalColorFeaturesAdaptor& transformFeatures() {
@@ -282,13 +388,38 @@ namespace cilantro {
                     res_col.tail(3) = data_col.tail(3);
                 }
             } else {
-                const ScalarT normal_weight = (data_map_.cols() > 0) ? data_map_.template block<3,1>(dim,0).norm() : (ScalarT)0.0;
 #pragma omp parallel for
                 for (size_t i = 0; i < data_map_.cols(); i++) {
                     auto res_col = transformed_data_.col(i);
                     auto data_col = data_map_.col(i);
                     res_col.head(dim).noalias() = tform.linear()*data_col.head(dim) + tform.translation();
-                    res_col.segment(dim,dim).noalias() = normal_weight*(tform.linear().inverse().transpose()*data_col.segment(dim,dim)).normalized();
+                    res_col.segment(dim,dim).noalias() = normal_weight_*(tform.linear().inverse().transpose()*data_col.segment(dim,dim)).normalized();
+                    res_col.tail(3) = data_col.tail(3);
+                }
+            }
+            return *this;
+        }
+
+        // Transforms only the given subset of features; the remaining transformed features are left untouched
+        template <class TransformT>
+        PointNormalColorFeaturesAdaptor& transformFeatures(const TransformT &tform, const std::vector<size_t> &indices) {
+            const size_t dim = (data_map_.rows() - 3)/2;
+            if (int(TransformT::Mode) == int(Eigen::Isometry)) {
+#pragma omp parallel for
+                for (size_t i = 0; i < indices.size(); i++) {
+                    auto res_col = transformed_data_.col(indices[i]);
+                    auto data_col = data_map_.col(indices[i]);
+                    res_col.head(dim).noalias() = tform.linear()*data_col.head(dim) + tform.translation();
+                    res_col.segment(dim,dim).noalias() = tform.linear()*data_col.segment(dim,dim);
+                    res_col.tail(3) = data_col.tail(3);
+                }
+            } else {
+#pragma omp parallel for
+                for (size_t i = 0; i < indices.size(); i++) {
+                    auto res_col = transformed_data_.col(indices[i]);
+                    auto data_col = data_map_.col(indices[i]);
+                    res_col.head(dim).noalias() = tform.linear()*data_col.head(dim) + tform.translation();
+                    res_col.segment(dim,dim).noalias() = normal_weight_*(tform.linear().inverse().transpose()*data_col.segment(dim,dim)).normalized();
                     res_col.tail(3) = data_col.tail(3);
                 }
             }
@@ -308,19 +439,39 @@ namespace cilantro {
                     res_col.tail(3) = data_col.tail(3);
                 }
             } else {
-                const ScalarT normal_weight = (data_map_.cols() > 0) ? data_map_.template block<3,1>(dim,0).norm() : (ScalarT)0.0;
 #pragma omp parallel for
                 for (size_t i = 0; i < data_map_.cols(); i++) {
                     auto res_col = transformed_data_.col(i);
                     auto data_col = data_map_.col(i);
                     res_col.head(dim).noalias() = tforms[i].linear()*data_col.head(dim) + tforms[i].translation();
-                    res_col.segment(dim,dim).noalias() = normal_weight*(tforms[i].linear().inverse().transpose()*data_col.segment(dim,dim)).normalized();
+                    res_col.segment(dim,dim).noalias() = normal_weight_*(tforms[i].linear().inverse().transpose()*data_col.segment(dim,dim)).normalized();
                     res_col.tail(3) = data_col.tail(3);
                 }
             }
             return *this;
         }
 
+        // Computes the i-th transformed feature without writing to the transformed features buffer
+        template <class TransformT>
+        inline void getTransformedFeature(const TransformT &tform, size_t i, Vector<ScalarT,FeatureDimension> &result) const {
+            const size_t dim = (data_map_.rows() - 3)/2;
+            auto data_col = data_map_.col(i);
+            result.resize(data_map_.rows());
+            result.head(dim).noalias() = tform.linear()*data_col.head(dim) + tform.translation();
+            if (int(TransformT::Mode) == int(Eigen::Isometry)) {
+                result.segment(dim,dim).noalias() = tform.linear()*data_col.segment(dim,dim);
+            } else {
+                result.segment(dim,dim).noalias() = normal_weight_*(tform.linear().inverse().transpose()*data_col.segment(dim,dim)).normalized();
+            }
+            result.tail(3) = data_col.tail(3);
+        }
+
+        // Stores an externally computed transformed feature (see getTransformedFeature)
+        inline PointNormalColorFeaturesAdaptor& setTransformedFeature(size_t i, const Eigen::Ref<const Vector<ScalarT,FeatureDimension>> &feature) {
+            transformed_data_.col(i) = feature;
+            return *this;
+        }
+
         inline const ConstVectorSetMatrixMap<ScalarT,FeatureDimension>& getFeaturesMatrixMap() const {
             return data_map_;
         }
@@ -334,6 +485,12 @@ namespace cilantro {
         ConstVectorSetMatrixMap<ScalarT,FeatureDimension> data_map_;
         VectorSet<ScalarT,FeatureDimension> transformed_data_;
         ConstVectorSetMatrixMap<ScalarT,FeatureDimension> transformed_data_map_;
+        ScalarT normal_weight_;
+
+        // Normals are stored scaled by a common weight, which non-isometric transforms must preserve
+        inline ScalarT compute_normal_weight_() const {
+            return (data_map_.cols() > 0) ? data_map_.col(0).segment((data_map_.rows() - 3)/2,(data_map_.rows() - 3)/2).norm() : (ScalarT)0.0;
+        }
     };
 
     typedef PointFeaturesAdaptor<float,2> PointFeaturesAdaptor2f;
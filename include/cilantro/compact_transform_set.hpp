@@ -0,0 +1,307 @@
+#pragma once
+
+#include <algorithm>
+#include <cilantro/space_transformations.hpp>
+
+namespace cilantro {
+    // Alternative storage for a set of rigid or affine transforms: instead of one Eigen::Transform per element
+    // (a homogeneous (Dim+1)x(Dim+1) matrix for isometries), each of the Dim*Dim linear and Dim translation
+    // parameters is stored in its own contiguous array (structure of arrays). Batched composition, inversion
+    // and point transformation run over blocks of elements in vectorizable loops. Elements are accessible as
+    // Eigen::Transform values or through strided linear()/translation() views, and conversions from/to
+    // TransformSet keep the TransformSet based API usable.
+    template <class TransformT>
+    class CompactTransformSet {
+        static_assert(TransformT::Dim != Eigen::Dynamic, "CompactTransformSet requires a fixed dimension");
+
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        typedef TransformT Transform;
+
+        typedef typename TransformT::Scalar Scalar;
+
+        enum {
+            Dim = TransformT::Dim,
+            Dimension = TransformT::Dim,
+            NumberOfParameters = TransformT::Dim*(TransformT::Dim + 1)
+        };
+
+        typedef Eigen::Map<Eigen::Matrix<Scalar,TransformT::Dim,TransformT::Dim>,0,Eigen::Stride<Eigen::Dynamic,Eigen::Dynamic>> LinearMap;
+        typedef Eigen::Map<const Eigen::Matrix<Scalar,TransformT::Dim,TransformT::Dim>,0,Eigen::Stride<Eigen::Dynamic,Eigen::Dynamic>> ConstLinearMap;
+        typedef Eigen::Map<Vector<Scalar,TransformT::Dim>,0,Eigen::InnerStride<Eigen::Dynamic>> TranslationMap;
+        typedef Eigen::Map<const Vector<Scalar,TransformT::Dim>,0,Eigen::InnerStride<Eigen::Dynamic>> ConstTranslationMap;
+
+        CompactTransformSet() {}
+
+        explicit CompactTransformSet(size_t size) : parameters_(size, NumberOfParameters) {}
+
+        CompactTransformSet(size_t size, const TransformT &tform) : parameters_(size, NumberOfParameters) { setConstant(tform); }
+
+        explicit CompactTransformSet(const TransformSet<TransformT> &tforms) : parameters_(tforms.size(), NumberOfParameters) {
+#pragma omp parallel for
+            for (size_t i = 0; i < tforms.size(); i++) {
+                setTransform(i, tforms[i]);
+            }
+        }
+
+        inline size_t size() const { return parameters_.rows(); }
+
+        inline bool empty() const { return parameters_.rows() == 0; }
+
+        inline CompactTransformSet& resize(size_t size) {
+            parameters_.conservativeResize(size, NumberOfParameters);
+            return *this;
+        }
+
+        // One column per parameter: the column-major linear part, followed by the translation
+        inline const Eigen::Matrix<Scalar,Eigen::Dynamic,NumberOfParameters>& getParameters() const { return parameters_; }
+
+        inline Eigen::Matrix<Scalar,Eigen::Dynamic,NumberOfParameters>& getParameters() { return parameters_; }
+
+        inline LinearMap linear(size_t i) {
+            return LinearMap(parameters_.data() + i, Eigen::Stride<Eigen::Dynamic,Eigen::Dynamic>(Dimension*size(), size()));
+        }
+
+        inline ConstLinearMap linear(size_t i) const {
+            return ConstLinearMap(parameters_.data() + i, Eigen::Stride<Eigen::Dynamic,Eigen::Dynamic>(Dimension*size(), size()));
+        }
+
+        inline TranslationMap translation(size_t i) {
+            return TranslationMap(parameters_.data() + Dimension*Dimension*size() + i, Eigen::InnerStride<Eigen::Dynamic>(size()));
+        }
+
+        inline ConstTranslationMap translation(size_t i) const {
+            return ConstTranslationMap(parameters_.data() + Dimension*Dimension*size() + i, Eigen::InnerStride<Eigen::Dynamic>(size()));
+        }
+
+        inline TransformT operator[](size_t i) const { return getTransform(i); }
+
+        inline TransformT getTransform(size_t i) const {
+            TransformT tform;
+            tform.setIdentity();
+            tform.linear() = linear(i);
+            tform.translation() = translation(i);
+            return tform;
+        }
+
+        inline CompactTransformSet& setTransform(size_t i, const TransformT &tform) {
+            linear(i) = tform.linear();
+            translation(i) = tform.translation();
+            return *this;
+        }
+
+        TransformSet<TransformT> getTransformSet() const {
+            TransformSet<TransformT> tforms(size());
+#pragma omp parallel for
+            for (size_t i = 0; i < tforms.size(); i++) {
+                tforms[i] = getTransform(i);
+            }
+            return tforms;
+        }
+
+        CompactTransformSet& setIdentity() {
+            for (size_t c = 0; c < Dimension; c++) {
+                for (size_t r = 0; r < Dimension; r++) {
+                    parameters_.col(Dimension*c + r).setConstant((r == c) ? (Scalar)1.0 : (Scalar)0.0);
+                }
+            }
+            parameters_.template rightCols<Dimension>().setZero();
+            return *this;
+        }
+
+        CompactTransformSet& setConstant(const TransformT &tform) {
+            for (size_t c = 0; c < Dimension; c++) {
+                for (size_t r = 0; r < Dimension; r++) {
+                    parameters_.col(Dimension*c + r).setConstant(tform.linear()(r,c));
+                }
+            }
+            for (size_t r = 0; r < Dimension; r++) {
+                parameters_.col(Dimension*Dimension + r).setConstant(tform.translation()[r]);
+            }
+            return *this;
+        }
+
+        CompactTransformSet inverse() const {
+            CompactTransformSet res(size());
+            invert_(*this, res);
+            return res;
+        }
+
+        CompactTransformSet& invert() {
+            invert_(*this, *this);
+            return *this;
+        }
+
+        // this[i] = other[i]*this[i]
+        CompactTransformSet& preApply(const CompactTransformSet &other) {
+            eigen_assert(other.size() == size() && "CompactTransformSet::preApply(): size mismatch");
+            compose_(other, *this, *this);
+            return *this;
+        }
+
+        // this[i] = this[i]*other[i]
+        CompactTransformSet& postApply(const CompactTransformSet &other) {
+            eigen_assert(other.size() == size() && "CompactTransformSet::postApply(): size mismatch");
+            compose_(*this, other, *this);
+            return *this;
+        }
+
+        // Applies element i to point i; result may share storage with points
+        void transformPoints(const ConstVectorSetMatrixMap<Scalar,TransformT::Dim> &points,
+                             VectorSet<Scalar,TransformT::Dim> &result) const
+        {
+            eigen_assert(points.cols() == (Eigen::Index)size() && "CompactTransformSet::transformPoints(): number of points does not match the number of transforms");
+            result.resize(Dimension, size());
+            const Scalar * const pts = points.data();
+            Scalar * const res = result.data();
+            for_each_block_([&](size_t start, size_t end) {
+                const size_t n = end - start;
+                const Scalar * const pts_block = pts + Dimension*start;
+                Scalar buf[Dimension][BlockSize];
+                for (size_t r = 0; r < Dimension; r++) {
+                    const Scalar * const t = param_(Dimension*Dimension + r) + start;
+                    std::copy(t, t + n, buf[r]);
+                    for (size_t c = 0; c < Dimension; c++) {
+                        const Scalar * const l = param_(Dimension*c + r) + start;
+                        for (size_t i = 0; i < n; i++) {
+                            buf[r][i] += l[i]*pts_block[Dimension*i + c];
+                        }
+                    }
+                }
+                Scalar * const res_block = res + Dimension*start;
+                for (size_t i = 0; i < n; i++) {
+                    for (size_t r = 0; r < Dimension; r++) res_block[Dimension*i + r] = buf[r][i];
+                }
+            });
+        }
+
+        inline VectorSet<Scalar,TransformT::Dim> transformPoints(const ConstVectorSetMatrixMap<Scalar,TransformT::Dim> &points) const {
+            VectorSet<Scalar,TransformT::Dim> result;
+            transformPoints(points, result);
+            return result;
+        }
+
+    private:
+        // Elements per block; a block of results is staged on the stack, so that outputs may alias inputs
+        enum { BlockSize = 256 };
+
+        Eigen::Matrix<Scalar,Eigen::Dynamic,NumberOfParameters> parameters_;
+
+        inline const Scalar * param_(size_t p) const { return parameters_.data() + p*size(); }
+
+        inline Scalar * param_(size_t p) { return parameters_.data() + p*size(); }
+
+        // Runs f(start, end) on consecutive element blocks, in parallel
+        template <class FunctorT>
+        inline void for_each_block_(const FunctorT &f) const {
+            const size_t num_blocks = (size() + BlockSize - 1)/BlockSize;
+#pragma omp parallel for
+            for (size_t b = 0; b < num_blocks; b++) {
+                f(BlockSize*b, std::min((size_t)BlockSize*(b + 1), size()));
+            }
+        }
+
+        inline void store_block_(const Scalar buf[][BlockSize], size_t start, size_t end) {
+            for (size_t p = 0; p < NumberOfParameters; p++) {
+                std::copy(buf[p], buf[p] + (end - start), param_(p) + start);
+            }
+        }
+
+        // res[i] = lhs[i]*rhs[i]
+        static void compose_(const CompactTransformSet &lhs, const CompactTransformSet &rhs, CompactTransformSet &res) {
+            res.for_each_block_([&](size_t start, size_t end) {
+                const size_t n = end - start;
+                Scalar buf[NumberOfParameters][BlockSize];
+                for (size_t r = 0; r < Dimension; r++) {
+                    // Linear part
+                    for (size_t c = 0; c < Dimension; c++) {
+                        Scalar * const res_rc = buf[Dimension*c + r];
+                        std::fill(res_rc, res_rc + n, (Scalar)0.0);
+                        for (size_t k = 0; k < Dimension; k++) {
+                            const Scalar * const lhs_rk = lhs.param_(Dimension*k + r) + start;
+                            const Scalar * const rhs_kc = rhs.param_(Dimension*c + k) + start;
+                            for (size_t i = 0; i < n; i++) res_rc[i] += lhs_rk[i]*rhs_kc[i];
+                        }
+                    }
+                    // Translation
+                    Scalar * const res_t = buf[Dimension*Dimension + r];
+                    const Scalar * const lhs_t = lhs.param_(Dimension*Dimension + r) + start;
+                    std::copy(lhs_t, lhs_t + n, res_t);
+                    for (size_t k = 0; k < Dimension; k++) {
+                        const Scalar * const lhs_rk = lhs.param_(Dimension*k + r) + start;
+                        const Scalar * const rhs_t = rhs.param_(Dimension*Dimension + k) + start;
+                        for (size_t i = 0; i < n; i++) res_t[i] += lhs_rk[i]*rhs_t[i];
+                    }
+                }
+                res.store_block_(buf, start, end);
+            });
+        }
+
+        // res[i] = src[i]^-1
+        static void invert_(const CompactTransformSet &src, CompactTransformSet &res) {
+            res.for_each_block_([&](size_t start, size_t end) {
+                const size_t n = end - start;
+                Scalar buf[NumberOfParameters][BlockSize];
+                if (int(TransformT::Mode) == int(Eigen::Isometry)) {
+                    // Transposed rotation
+                    for (size_t c = 0; c < Dimension; c++) {
+                        for (size_t r = 0; r < Dimension; r++) {
+                            const Scalar * const a_cr = src.param_(Dimension*r + c) + start;
+                            std::copy(a_cr, a_cr + n, buf[Dimension*c + r]);
+                        }
+                    }
+                } else if (Dimension == 2 || Dimension == 3) {
+                    // Adjugate over determinant
+                    Scalar * const inv_det = buf[Dimension*Dimension];
+                    std::fill(inv_det, inv_det + n, (Scalar)0.0);
+                    for (size_t c = 0; c < Dimension; c++) {
+                        const Scalar * const a_0c = src.param_(Dimension*c) + start;
+                        for (size_t i = 0; i < n; i++) inv_det[i] += a_0c[i]*src.cofactor_(0, c, start + i);
+                    }
+                    for (size_t i = 0; i < n; i++) inv_det[i] = (Scalar)1.0/inv_det[i];
+                    for (size_t c = 0; c < Dimension; c++) {
+                        for (size_t r = 0; r < Dimension; r++) {
+                            Scalar * const inv_rc = buf[Dimension*c + r];
+                            for (size_t i = 0; i < n; i++) inv_rc[i] = src.cofactor_(c, r, start + i)*inv_det[i];
+                        }
+                    }
+                } else {
+                    for (size_t i = 0; i < n; i++) {
+                        const Eigen::Matrix<Scalar,TransformT::Dim,TransformT::Dim> inv = src.linear(start + i).inverse();
+                        for (size_t c = 0; c < Dimension; c++) {
+                            for (size_t r = 0; r < Dimension; r++) buf[Dimension*c + r][i] = inv(r,c);
+                        }
+                    }
+                }
+
+                // Translation: -inv(L)*t
+                for (size_t r = 0; r < Dimension; r++) {
+                    Scalar * const res_t = buf[Dimension*Dimension + r];
+                    std::fill(res_t, res_t + n, (Scalar)0.0);
+                    for (size_t k = 0; k < Dimension; k++) {
+                        const Scalar * const inv_rk = buf[Dimension*k + r];
+                        const Scalar * const t = src.param_(Dimension*Dimension + k) + start;
+                        for (size_t i = 0; i < n; i++) res_t[i] -= inv_rk[i]*t[i];
+                    }
+                }
+                res.store_block_(buf, start, end);
+            });
+        }
+
+        // Cofactor (r,c) of the linear part of element i (2D or 3D)
+        inline Scalar cofactor_(size_t r, size_t c, size_t i) const {
+            if (Dimension == 2) {
+                return (((r + c) % 2 == 0) ? (Scalar)1.0 : (Scalar)(-1.0))*param_(Dimension*(1 - c) + 1 - r)[i];
+            }
+            const size_t r1 = (r + 1) % Dimension, r2 = (r + 2) % Dimension, c1 = (c + 1) % Dimension, c2 = (c + 2) % Dimension;
+            return param_(Dimension*c1 + r1)[i]*param_(Dimension*c2 + r2)[i] - param_(Dimension*c2 + r1)[i]*param_(Dimension*c1 + r2)[i];
+        }
+    };
+
+    template <typename ScalarT, ptrdiff_t EigenDim>
+    using CompactRigidTransformSet = CompactTransformSet<RigidTransform<ScalarT,EigenDim>>;
+
+    template <typename ScalarT, ptrdiff_t EigenDim>
+    using CompactAffineTransformSet = CompactTransformSet<AffineTransform<ScalarT,EigenDim>>;
+}
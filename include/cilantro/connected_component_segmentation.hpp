@@ -192,6 +192,22 @@ namespace cilantro {
 //            return *this;
 //        }
 
+        // Organized points (one per pixel, in row major order, with NaN entries for invalid pixels, as in
+        // OrganizedPointCloud): each pixel is connected to those of its 8 neighbors that are valid, within
+        // max_distance (squared) and accepted by the evaluator. No neighborhood search is needed; components
+        // are found by union-find over the pixel grid. Indices refer to pixels.
+        template <typename ScalarT, class PointSimilarityEvaluator = AlwaysTrueEvaluator<ScalarT>>
+        ConnectedComponentSegmentation& segmentOrganized(const ConstVectorSetMatrixMap<ScalarT,3> &points,
+                                                         size_t image_w, size_t image_h,
+                                                         ScalarT max_distance,
+                                                         const PointSimilarityEvaluator &evaluator = PointSimilarityEvaluator(),
+                                                         size_t min_segment_size = 0,
+                                                         size_t max_segment_size = std::numeric_limits<size_t>::max())
+        {
+            segment_organized_<ScalarT,PointSimilarityEvaluator>(points, image_w, image_h, max_distance, evaluator, min_segment_size, max_segment_size);
+            return *this;
+        }
+
         inline const std::vector<std::vector<size_t>>& getComponentPointIndices() const { return component_point_indices_; }
 
         inline const std::vector<size_t>& getComponentIndexMap() const { return segment_index_map_; }
@@ -212,6 +228,87 @@ namespace cilantro {
         std::vector<std::vector<size_t>> component_point_indices_;
         std::vector<size_t> segment_index_map_;
 
+        static inline size_t find_root_(std::vector<size_t> &parent, size_t i) {
+            while (parent[i] != i) {
+                parent[i] = parent[parent[i]];
+                i = parent[i];
+            }
+            return i;
+        }
+
+        template <typename ScalarT, class PointSimilarityEvaluator>
+        void segment_organized_(const ConstVectorSetMatrixMap<ScalarT,3> &points,
+                                size_t image_w, size_t image_h,
+                                ScalarT max_distance,
+                                const PointSimilarityEvaluator &evaluator,
+                                size_t min_segment_size,
+                                size_t max_segment_size)
+        {
+            const size_t num_pixels = image_w*image_h;
+
+            // Links of each pixel to its right, lower left, lower and lower right neighbors, evaluated in parallel
+            const ptrdiff_t offsets[4] = {1, (ptrdiff_t)image_w - 1, (ptrdiff_t)image_w, (ptrdiff_t)image_w + 1};
+            std::vector<unsigned char> links(num_pixels, 0);
+#pragma omp parallel for
+            for (size_t y = 0; y < image_h; y++) {
+                for (size_t x = 0; x < image_w; x++) {
+                    const size_t i = y*image_w + x;
+                    if (std::isnan(points(0,i))) continue;
+                    const bool has_neighbor[4] = {x + 1 < image_w, y + 1 < image_h && x > 0, y + 1 < image_h, y + 1 < image_h && x + 1 < image_w};
+                    unsigned char mask = 0;
+                    for (size_t n = 0; n < 4; n++) {
+                        if (!has_neighbor[n]) continue;
+                        const size_t j = i + offsets[n];
+                        if (std::isnan(points(0,j))) continue;
+                        const ScalarT dist = (points.col(i) - points.col(j)).squaredNorm();
+                        if (dist < max_distance && evaluator(i, j, dist)) mask |= (unsigned char)(1 << n);
+                    }
+                    links[i] = mask;
+                }
+            }
+
+            std::vector<size_t> parent(num_pixels);
+            for (size_t i = 0; i < num_pixels; i++) parent[i] = i;
+            for (size_t i = 0; i < num_pixels; i++) {
+                if (!links[i]) continue;
+                for (size_t n = 0; n < 4; n++) {
+                    if (!(links[i] & (1 << n))) continue;
+                    const size_t ri = find_root_(parent, i), rj = find_root_(parent, i + offsets[n]);
+                    if (ri < rj) parent[rj] = ri; else parent[ri] = rj;
+                }
+            }
+
+            // Component sizes per root, then labels by decreasing size
+            std::vector<size_t> root_size(num_pixels, 0);
+            for (size_t i = 0; i < num_pixels; i++) {
+                if (std::isnan(points(0,i))) continue;
+                parent[i] = find_root_(parent, i);
+                root_size[parent[i]]++;
+            }
+            std::vector<size_t> roots;
+            for (size_t i = 0; i < num_pixels; i++) {
+                if (root_size[i] > 0 && root_size[i] >= min_segment_size && root_size[i] <= max_segment_size) roots.emplace_back(i);
+            }
+            std::stable_sort(roots.begin(), roots.end(), [&root_size](size_t a, size_t b) { return root_size[a] > root_size[b]; });
+
+            const size_t no_label = roots.size();
+            std::vector<size_t> root_label(num_pixels, no_label);
+            component_point_indices_.resize(roots.size());
+            for (size_t l = 0; l < roots.size(); l++) {
+                root_label[roots[l]] = l;
+                component_point_indices_[l].clear();
+                component_point_indices_[l].reserve(root_size[roots[l]]);
+            }
+            segment_index_map_.assign(num_pixels, no_label);
+            for (size_t i = 0; i < num_pixels; i++) {
+                if (std::isnan(points(0,i))) continue;
+                const size_t l = root_label[parent[i]];
+                if (l == no_label) continue;
+                segment_index_map_[i] = l;
+                component_point_indices_[l].emplace_back(i);
+            }
+        }
+
         template <typename ScalarT, class PointSimilarityEvaluator>
         void segment_given_neighbors_(const std::vector<NeighborSet<ScalarT>> &neighbors,
                                       const std::vector<size_t> &seeds_ind,
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <vector>
 #include <Eigen/Dense>
 #include <cilantro/correspondence_search_combined_metric_adaptor.hpp>
 
@@ -52,6 +53,19 @@ namespace cilantro {
             return *this;
         }
 
+        template <class TransformT>
+        inline CorrespondenceSearchCombinedMetricCombiner& findCorrespondences(const TransformT& tform, const std::vector<size_t> &src_indices) {
+            if (std::is_same<PointToPointCorrespondenceSearchT,PointToPlaneCorrespondenceSearchT>::value &&
+                &point_to_point_corr_search_ == (PointToPointCorrespondenceSearchT *)(&point_to_plane_corr_search_))
+            {
+                point_to_point_corr_search_.findCorrespondences(tform, src_indices);
+            } else {
+                point_to_point_corr_search_.findCorrespondences(tform, src_indices);
+                point_to_plane_corr_search_.findCorrespondences(tform, src_indices);
+            }
+            return *this;
+        }
+
         inline const PointToPointCorrespondenceSearchResult& getPointToPointCorrespondences() const {
             return CorrespondenceSearchCombinedMetricAdaptor<PointToPointCorrespondenceSearchT>(point_to_point_corr_search_).getPointToPointCorrespondences();
         }
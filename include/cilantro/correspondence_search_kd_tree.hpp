@@ -133,7 +133,11 @@ namespace cilantro {
                 }
                 case CorrespondenceSearchDirection::SECOND_TO_FIRST: {
                     if (!dst_tree_ptr_) dst_tree_ptr_.reset(new SearchTree(dst_search_features_adaptor_.getFeaturesMatrixMap()));
-                    findNNCorrespondencesUnidirectional<SearchFeatureScalar,SearchFeatureAdaptorT::FeatureDimension,DistAdaptor,EvaluatorT>(src_search_features_adaptor_.transformFeatures(tform).getTransformedFeaturesMatrixMap(), *dst_tree_ptr_, true, correspondences_, max_distance_, evaluator_);
+                    if (can_fuse_transform_and_search_()) {
+                        findTransformedNNCorrespondencesUnidirectional<SearchFeatureAdaptorT,TransformT,DistAdaptor,EvaluatorT>(src_search_features_adaptor_, tform, *dst_tree_ptr_, true, correspondences_, max_distance_, evaluator_);
+                    } else {
+                        findNNCorrespondencesUnidirectional<SearchFeatureScalar,SearchFeatureAdaptorT::FeatureDimension,DistAdaptor,EvaluatorT>(src_search_features_adaptor_.transformFeatures(tform).getTransformedFeaturesMatrixMap(), *dst_tree_ptr_, true, correspondences_, max_distance_, evaluator_);
+                    }
                     break;
                 }
                 case CorrespondenceSearchDirection::BOTH: {
@@ -149,6 +153,44 @@ namespace cilantro {
             return *this;
         }
 
+        // Interface for ICP use, restricted to a subset of source points; for FIRST_TO_SECOND and BOTH searches,
+        // the source tree is built on the subset only
+        template <class TransformT>
+        CorrespondenceSearchKDTree& findCorrespondences(const TransformT &tform, const std::vector<size_t> &src_indices) {
+            if (!std::is_same<SearchFeatureAdaptorT,EvaluationFeatureAdaptorT>::value ||
+                &src_search_features_adaptor_ != (SearchFeatureAdaptorT *)(&src_evaluation_features_adaptor_))
+            {
+                src_evaluation_features_adaptor_.transformFeatures(tform, src_indices);
+            }
+
+            switch (search_dir_) {
+                case CorrespondenceSearchDirection::FIRST_TO_SECOND: {
+                    build_src_subset_tree_(tform, src_indices);
+                    findNNCorrespondencesUnidirectional<SearchFeatureScalar,SearchFeatureAdaptorT::FeatureDimension,DistAdaptor,EvaluatorT>(dst_search_features_adaptor_.getFeaturesMatrixMap(), *src_trans_tree_ptr_, src_indices, false, correspondences_, max_distance_, evaluator_);
+                    break;
+                }
+                case CorrespondenceSearchDirection::SECOND_TO_FIRST: {
+                    if (!dst_tree_ptr_) dst_tree_ptr_.reset(new SearchTree(dst_search_features_adaptor_.getFeaturesMatrixMap()));
+                    if (can_fuse_transform_and_search_()) {
+                        findTransformedNNCorrespondencesUnidirectional<SearchFeatureAdaptorT,TransformT,DistAdaptor,EvaluatorT>(src_search_features_adaptor_, tform, src_indices, *dst_tree_ptr_, true, correspondences_, max_distance_, evaluator_);
+                    } else {
+                        findNNCorrespondencesUnidirectional<SearchFeatureScalar,SearchFeatureAdaptorT::FeatureDimension,DistAdaptor,EvaluatorT>(src_search_features_adaptor_.transformFeatures(tform, src_indices).getTransformedFeaturesMatrixMap(), src_indices, *dst_tree_ptr_, true, correspondences_, max_distance_, evaluator_);
+                    }
+                    break;
+                }
+                case CorrespondenceSearchDirection::BOTH: {
+                    if (!dst_tree_ptr_) dst_tree_ptr_.reset(new SearchTree(dst_search_features_adaptor_.getFeaturesMatrixMap()));
+                    build_src_subset_tree_(tform, src_indices);
+                    findNNCorrespondencesBidirectional<SearchFeatureScalar,SearchFeatureAdaptorT::FeatureDimension,DistAdaptor,EvaluatorT>(dst_search_features_adaptor_.getFeaturesMatrixMap(), src_search_features_adaptor_.getTransformedFeaturesMatrixMap(), src_indices, *dst_tree_ptr_, *src_trans_tree_ptr_, correspondences_, max_distance_, require_reciprocality_, evaluator_);
+                    break;
+                }
+            }
+
+            filterCorrespondencesFraction(correspondences_, inlier_fraction_);
+
+            return *this;
+        }
+
         inline const SearchResult& getCorrespondences() const { return correspondences_; }
 
         inline Evaluator& evaluator() { return evaluator_; }
@@ -199,5 +241,27 @@ namespace cilantro {
         bool require_reciprocality_;
 
         SearchResult correspondences_;
+
+        // Transformed source features of the current subset (see findCorrespondences(tform, src_indices)), which
+        // src_trans_tree_ptr_ is built on
+        VectorSet<SearchFeatureScalar,SearchFeatureAdaptorT::FeatureDimension> src_subset_features_;
+
+        template <class TransformT>
+        void build_src_subset_tree_(const TransformT &tform, const std::vector<size_t> &src_indices) {
+            const auto src_trans = src_search_features_adaptor_.transformFeatures(tform, src_indices).getTransformedFeaturesMatrixMap();
+            src_subset_features_.resize(src_trans.rows(), src_indices.size());
+#pragma omp parallel for
+            for (size_t i = 0; i < src_indices.size(); i++) {
+                src_subset_features_.col(i) = src_trans.col(src_indices[i]);
+            }
+            src_trans_tree_ptr_.reset(new SearchTree(src_subset_features_));
+        }
+
+        // Source search features can be transformed on the fly during the search (instead of being transformed
+        // in bulk beforehand) unless the evaluator may read them back by index
+        inline bool can_fuse_transform_and_search_() const {
+            return IsValueOnlyEvaluator<EvaluatorT>::value || !std::is_same<SearchFeatureAdaptorT,EvaluationFeatureAdaptorT>::value ||
+                   &src_search_features_adaptor_ != (SearchFeatureAdaptorT *)(&src_evaluation_features_adaptor_);
+        }
     };
 }
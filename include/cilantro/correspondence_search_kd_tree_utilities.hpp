@@ -3,6 +3,7 @@
 #include <cilantro/correspondence.hpp>
 #include <cilantro/common_pair_evaluators.hpp>
 #include <cilantro/kd_tree.hpp>
+#include <cilantro/space_transformations.hpp>
 
 namespace cilantro {
     enum struct CorrespondenceSearchDirection {FIRST_TO_SECOND, SECOND_TO_FIRST, BOTH};
@@ -62,6 +63,213 @@ namespace cilantro {
         return corr_set;
     }
 
+    // Restricts the queries to the columns of query_pts listed in query_indices
+    template <typename ScalarT, ptrdiff_t EigenDim, template <class> class DistAdaptor = KDTreeDistanceAdaptors::L2, class EvaluatorT = DistanceEvaluator<ScalarT,ScalarT>, typename CorrValueT = typename EvaluatorT::OutputScalar>
+    void findNNCorrespondencesUnidirectional(const ConstVectorSetMatrixMap<ScalarT,EigenDim> &query_pts,
+                                             const std::vector<size_t> &query_indices,
+                                             const KDTree<ScalarT,EigenDim,DistAdaptor> &ref_tree,
+                                             bool ref_is_first,
+                                             CorrespondenceSet<CorrValueT> &correspondences,
+                                             CorrValueT max_distance,
+                                             const EvaluatorT &evaluator = EvaluatorT())
+    {
+        if (ref_tree.getPointsMatrixMap().cols() == 0) {
+            correspondences.clear();
+            return;
+        }
+
+        CorrespondenceSet<CorrValueT> corr_tmp(query_indices.size());
+
+        Neighbor<ScalarT> nn;
+
+        if (ref_is_first) {
+#pragma omp parallel for shared (correspondences) private (nn)
+            for (size_t i = 0; i < corr_tmp.size(); i++) {
+                const size_t ind = query_indices[i];
+                ref_tree.nearestNeighborSearch(query_pts.col(ind), nn);
+                corr_tmp[i].indexInFirst = nn.index;
+                corr_tmp[i].indexInSecond = ind;
+                corr_tmp[i].value = evaluator(nn.index, ind, nn.value);
+            }
+        } else {
+#pragma omp parallel for shared (correspondences) private (nn)
+            for (size_t i = 0; i < corr_tmp.size(); i++) {
+                const size_t ind = query_indices[i];
+                ref_tree.nearestNeighborSearch(query_pts.col(ind), nn);
+                corr_tmp[i].indexInFirst = ind;
+                corr_tmp[i].indexInSecond = nn.index;
+                corr_tmp[i].value = evaluator(ind, nn.index, nn.value);
+            }
+        }
+
+        correspondences.resize(corr_tmp.size());
+        size_t count = 0;
+        for (size_t i = 0; i < corr_tmp.size(); i++) {
+            if (corr_tmp[i].value < max_distance) correspondences[count++] = corr_tmp[i];
+        }
+        correspondences.resize(count);
+    }
+
+    // ref_tree is built on the columns of the reference points listed in ref_indices (in that order); the
+    // resulting correspondences (and the evaluator calls) refer to the original reference indices
+    template <typename ScalarT, ptrdiff_t EigenDim, template <class> class DistAdaptor = KDTreeDistanceAdaptors::L2, class EvaluatorT = DistanceEvaluator<ScalarT,ScalarT>, typename CorrValueT = typename EvaluatorT::OutputScalar>
+    void findNNCorrespondencesUnidirectional(const ConstVectorSetMatrixMap<ScalarT,EigenDim> &query_pts,
+                                             const KDTree<ScalarT,EigenDim,DistAdaptor> &ref_tree,
+                                             const std::vector<size_t> &ref_indices,
+                                             bool ref_is_first,
+                                             CorrespondenceSet<CorrValueT> &correspondences,
+                                             CorrValueT max_distance,
+                                             const EvaluatorT &evaluator = EvaluatorT())
+    {
+        if (ref_tree.getPointsMatrixMap().cols() == 0) {
+            correspondences.clear();
+            return;
+        }
+
+        CorrespondenceSet<CorrValueT> corr_tmp(query_pts.cols());
+
+        Neighbor<ScalarT> nn;
+
+        if (ref_is_first) {
+#pragma omp parallel for shared (correspondences) private (nn)
+            for (size_t i = 0; i < corr_tmp.size(); i++) {
+                ref_tree.nearestNeighborSearch(query_pts.col(i), nn);
+                corr_tmp[i].indexInFirst = ref_indices[nn.index];
+                corr_tmp[i].indexInSecond = i;
+                corr_tmp[i].value = evaluator(ref_indices[nn.index], i, nn.value);
+            }
+        } else {
+#pragma omp parallel for shared (correspondences) private (nn)
+            for (size_t i = 0; i < corr_tmp.size(); i++) {
+                ref_tree.nearestNeighborSearch(query_pts.col(i), nn);
+                corr_tmp[i].indexInFirst = i;
+                corr_tmp[i].indexInSecond = ref_indices[nn.index];
+                corr_tmp[i].value = evaluator(i, ref_indices[nn.index], nn.value);
+            }
+        }
+
+        correspondences.resize(corr_tmp.size());
+        size_t count = 0;
+        for (size_t i = 0; i < corr_tmp.size(); i++) {
+            if (corr_tmp[i].value < max_distance) correspondences[count++] = corr_tmp[i];
+        }
+        correspondences.resize(count);
+    }
+
+    namespace internal {
+        template <class QueryFeatureAdaptorT, class TransformT, template <class> class DistAdaptor, class EvaluatorT, typename CorrValueT>
+        void findTransformedNNCorrespondencesUnidirectional(QueryFeatureAdaptorT &query_features,
+                                                            const TransformT &tform,
+                                                            const std::vector<size_t> *query_indices,
+                                                            const KDTree<typename QueryFeatureAdaptorT::Scalar,QueryFeatureAdaptorT::FeatureDimension,DistAdaptor> &ref_tree,
+                                                            bool ref_is_first,
+                                                            CorrespondenceSet<CorrValueT> &correspondences,
+                                                            CorrValueT max_distance,
+                                                            const EvaluatorT &evaluator)
+        {
+            if (ref_tree.getPointsMatrixMap().cols() == 0) {
+                correspondences.clear();
+                return;
+            }
+
+            CorrespondenceSet<CorrValueT> corr_tmp((query_indices != NULL) ? query_indices->size() : query_features.getFeaturesMatrixMap().cols());
+            const CorrValueT value_to_reject = max_distance + (CorrValueT)1.0;
+
+            Neighbor<typename QueryFeatureAdaptorT::Scalar> nn;
+            Vector<typename QueryFeatureAdaptorT::Scalar,QueryFeatureAdaptorT::FeatureDimension> feat(query_features.getFeaturesMatrixMap().rows());
+
+#pragma omp parallel for shared (corr_tmp) firstprivate (nn, feat)
+            for (size_t k = 0; k < corr_tmp.size(); k++) {
+                const size_t ind = (query_indices != NULL) ? (*query_indices)[k] : k;
+                query_features.getTransformedFeature(getPointTransform(tform, ind), ind, feat);
+                ref_tree.nearestNeighborSearch(feat, nn);
+                if (ref_is_first) {
+                    corr_tmp[k].indexInFirst = nn.index;
+                    corr_tmp[k].indexInSecond = ind;
+                    corr_tmp[k].value = evaluator(nn.index, ind, nn.value);
+                } else {
+                    corr_tmp[k].indexInFirst = ind;
+                    corr_tmp[k].indexInSecond = nn.index;
+                    corr_tmp[k].value = evaluator(ind, nn.index, nn.value);
+                }
+                if (corr_tmp[k].value < max_distance) {
+                    query_features.setTransformedFeature(ind, feat);
+                } else {
+                    corr_tmp[k].value = value_to_reject;
+                }
+            }
+
+            correspondences.resize(corr_tmp.size());
+            size_t count = 0;
+            for (size_t i = 0; i < corr_tmp.size(); i++) {
+                if (corr_tmp[i].value < max_distance) correspondences[count++] = corr_tmp[i];
+            }
+            correspondences.resize(count);
+        }
+    }
+
+    // Fused transform-and-search: query features are transformed on the fly by the adaptor (TransformT may be a single
+    // transform or a TransformSet) instead of being read from a precomputed transformed copy. Only the transformed
+    // features of accepted correspondences are written back to the adaptor, so evaluator must not depend on them.
+    template <class QueryFeatureAdaptorT, class TransformT, template <class> class DistAdaptor, class EvaluatorT = DistanceEvaluator<typename QueryFeatureAdaptorT::Scalar,typename QueryFeatureAdaptorT::Scalar>, typename CorrValueT = typename EvaluatorT::OutputScalar>
+    inline void findTransformedNNCorrespondencesUnidirectional(QueryFeatureAdaptorT &query_features,
+                                                               const TransformT &tform,
+                                                               const KDTree<typename QueryFeatureAdaptorT::Scalar,QueryFeatureAdaptorT::FeatureDimension,DistAdaptor> &ref_tree,
+                                                               bool ref_is_first,
+                                                               CorrespondenceSet<CorrValueT> &correspondences,
+                                                               CorrValueT max_distance,
+                                                               const EvaluatorT &evaluator = EvaluatorT())
+    {
+        internal::findTransformedNNCorrespondencesUnidirectional<QueryFeatureAdaptorT,TransformT,DistAdaptor,EvaluatorT,CorrValueT>(query_features, tform, NULL, ref_tree, ref_is_first, correspondences, max_distance, evaluator);
+    }
+
+    // Same as above, restricted to the query features listed in query_indices
+    template <class QueryFeatureAdaptorT, class TransformT, template <class> class DistAdaptor, class EvaluatorT = DistanceEvaluator<typename QueryFeatureAdaptorT::Scalar,typename QueryFeatureAdaptorT::Scalar>, typename CorrValueT = typename EvaluatorT::OutputScalar>
+    inline void findTransformedNNCorrespondencesUnidirectional(QueryFeatureAdaptorT &query_features,
+                                                               const TransformT &tform,
+                                                               const std::vector<size_t> &query_indices,
+                                                               const KDTree<typename QueryFeatureAdaptorT::Scalar,QueryFeatureAdaptorT::FeatureDimension,DistAdaptor> &ref_tree,
+                                                               bool ref_is_first,
+                                                               CorrespondenceSet<CorrValueT> &correspondences,
+                                                               CorrValueT max_distance,
+                                                               const EvaluatorT &evaluator = EvaluatorT())
+    {
+        internal::findTransformedNNCorrespondencesUnidirectional<QueryFeatureAdaptorT,TransformT,DistAdaptor,EvaluatorT,CorrValueT>(query_features, tform, &query_indices, ref_tree, ref_is_first, correspondences, max_distance, evaluator);
+    }
+
+    namespace internal {
+        // Merges (sorts in place) the correspondences found in the two directions
+        template <typename CorrValueT>
+        void mergeNNCorrespondences(CorrespondenceSet<CorrValueT> &corr_first_to_second,
+                                    CorrespondenceSet<CorrValueT> &corr_second_to_first,
+                                    CorrespondenceSet<CorrValueT> &correspondences,
+                                    bool require_reciprocal)
+        {
+            typename Correspondence<CorrValueT>::IndicesLexicographicalComparator comparator;
+
+#pragma omp parallel sections
+            {
+#pragma omp section
+                std::sort(corr_first_to_second.begin(), corr_first_to_second.end(), comparator);
+#pragma omp section
+                std::sort(corr_second_to_first.begin(), corr_second_to_first.end(), comparator);
+            }
+
+            correspondences.clear();
+            correspondences.reserve(corr_first_to_second.size()+corr_second_to_first.size());
+
+            if (require_reciprocal) {
+                std::set_intersection(corr_first_to_second.begin(), corr_first_to_second.end(),
+                                      corr_second_to_first.begin(), corr_second_to_first.end(),
+                                      std::back_inserter(correspondences), comparator);
+            } else {
+                std::set_union(corr_first_to_second.begin(), corr_first_to_second.end(),
+                               corr_second_to_first.begin(), corr_second_to_first.end(),
+                               std::back_inserter(correspondences), comparator);
+            }
+        }
+    }
+
     template <typename ScalarT, ptrdiff_t EigenDim, template <class> class DistAdaptor = KDTreeDistanceAdaptors::L2, class EvaluatorT = DistanceEvaluator<ScalarT,ScalarT>, typename CorrValueT = typename EvaluatorT::OutputScalar>
     void findNNCorrespondencesBidirectional(const ConstVectorSetMatrixMap<ScalarT,EigenDim> &first_points,
                                             const ConstVectorSetMatrixMap<ScalarT,EigenDim> &second_points,
@@ -75,29 +283,26 @@ namespace cilantro {
         CorrespondenceSet<CorrValueT> corr_first_to_second, corr_second_to_first;
         findNNCorrespondencesUnidirectional<ScalarT,EigenDim,DistAdaptor,EvaluatorT,CorrValueT>(first_points, second_tree, false, corr_first_to_second, max_distance, evaluator);
         findNNCorrespondencesUnidirectional<ScalarT,EigenDim,DistAdaptor,EvaluatorT,CorrValueT>(second_points, first_tree, true, corr_second_to_first, max_distance, evaluator);
+        internal::mergeNNCorrespondences(corr_first_to_second, corr_second_to_first, correspondences, require_reciprocal);
+    }
 
-        typename Correspondence<CorrValueT>::IndicesLexicographicalComparator comparator;
-
-#pragma omp parallel sections
-        {
-#pragma omp section
-            std::sort(corr_first_to_second.begin(), corr_first_to_second.end(), comparator);
-#pragma omp section
-            std::sort(corr_second_to_first.begin(), corr_second_to_first.end(), comparator);
-        }
-
-        correspondences.clear();
-        correspondences.reserve(corr_first_to_second.size()+corr_second_to_first.size());
-
-        if (require_reciprocal) {
-            std::set_intersection(corr_first_to_second.begin(), corr_first_to_second.end(),
-                                  corr_second_to_first.begin(), corr_second_to_first.end(),
-                                  std::back_inserter(correspondences), comparator);
-        } else {
-            std::set_union(corr_first_to_second.begin(), corr_first_to_second.end(),
-                           corr_second_to_first.begin(), corr_second_to_first.end(),
-                           std::back_inserter(correspondences), comparator);
-        }
+    // Restricted to the columns of second_points listed in second_indices; second_tree is built on those columns
+    // (in that order)
+    template <typename ScalarT, ptrdiff_t EigenDim, template <class> class DistAdaptor = KDTreeDistanceAdaptors::L2, class EvaluatorT = DistanceEvaluator<ScalarT,ScalarT>, typename CorrValueT = typename EvaluatorT::OutputScalar>
+    void findNNCorrespondencesBidirectional(const ConstVectorSetMatrixMap<ScalarT,EigenDim> &first_points,
+                                            const ConstVectorSetMatrixMap<ScalarT,EigenDim> &second_points,
+                                            const std::vector<size_t> &second_indices,
+                                            const KDTree<ScalarT,EigenDim,DistAdaptor> &first_tree,
+                                            const KDTree<ScalarT,EigenDim,DistAdaptor> &second_tree,
+                                            CorrespondenceSet<CorrValueT> &correspondences,
+                                            CorrValueT max_distance,
+                                            bool require_reciprocal = false,
+                                            const EvaluatorT &evaluator = EvaluatorT())
+    {
+        CorrespondenceSet<CorrValueT> corr_first_to_second, corr_second_to_first;
+        findNNCorrespondencesUnidirectional<ScalarT,EigenDim,DistAdaptor,EvaluatorT,CorrValueT>(first_points, second_tree, second_indices, false, corr_first_to_second, max_distance, evaluator);
+        findNNCorrespondencesUnidirectional<ScalarT,EigenDim,DistAdaptor,EvaluatorT,CorrValueT>(second_points, second_indices, first_tree, true, corr_second_to_first, max_distance, evaluator);
+        internal::mergeNNCorrespondences(corr_first_to_second, corr_second_to_first, correspondences, require_reciprocal);
     }
 
     template <typename ScalarT, ptrdiff_t EigenDim, template <class> class DistAdaptor = KDTreeDistanceAdaptors::L2, class EvaluatorT = DistanceEvaluator<ScalarT,ScalarT>, typename CorrValueT = typename EvaluatorT::OutputScalar>
@@ -26,7 +26,7 @@ namespace cilantro {
                   projection_image_width_(640), projection_image_height_(480),
                   projection_extrinsics_(RigidTransform<ScalarT,3>::Identity()),
                   projection_extrinsics_inv_(RigidTransform<ScalarT,3>::Identity()),
-                  max_distance_((CorrespondenceScalar)(0.01*0.01)), inlier_fraction_(1.0)
+                  dst_organized_(false), max_distance_((CorrespondenceScalar)(0.01*0.01)), inlier_fraction_(1.0)
         {
             // "Kinect"-like defaults
             projection_intrinsics_ << 528, 0, 320, 0, 528, 240, 0, 0, 1;
@@ -41,26 +41,54 @@ namespace cilantro {
                   projection_image_width_(640), projection_image_height_(480),
                   projection_extrinsics_(RigidTransform<ScalarT,3>::Identity()),
                   projection_extrinsics_inv_(RigidTransform<ScalarT,3>::Identity()),
-                  max_distance_((CorrespondenceScalar)(0.01*0.01)), inlier_fraction_(1.0)
+                  dst_organized_(false), max_distance_((CorrespondenceScalar)(0.01*0.01)), inlier_fraction_(1.0)
         {
             // "Kinect"-like defaults
             projection_intrinsics_ << 528, 0, 320, 0, 528, 240, 0, 0, 1;
         }
 
         inline CorrespondenceSearchProjective& findCorrespondences() {
-            find_correspondences_(src_search_features_adaptor_.getFeaturesMatrixMap(), correspondences_);
+            find_correspondences_(RigidTransform<ScalarT,3>::Identity(), NULL, false, correspondences_);
             return *this;
         }
 
         // Interface for ICP use
         template <class TransformT>
         inline CorrespondenceSearchProjective& findCorrespondences(const TransformT &tform) {
+            // If the evaluator needs all transformed source points of a shared adaptor, a bulk transform
+            // replaces the per-correspondence write-back
+            bool store_transformed = true;
             if (!std::is_same<PointFeaturesAdaptor<ScalarT,3>,EvaluationFeatureAdaptorT>::value ||
                 &src_search_features_adaptor_ != (PointFeaturesAdaptor<ScalarT,3> *)(&src_evaluation_features_adaptor_))
             {
                 src_evaluation_features_adaptor_.transformFeatures(tform);
+            } else if (!IsValueOnlyEvaluator<EvaluatorT>::value) {
+                src_search_features_adaptor_.transformFeatures(tform);
+                store_transformed = false;
             }
-            find_correspondences_(src_search_features_adaptor_.transformFeatures(tform).getTransformedFeaturesMatrixMap(), correspondences_);
+            find_correspondences_(tform, NULL, store_transformed, correspondences_);
+            return *this;
+        }
+
+        // Interface for ICP use, restricted to a subset of source points
+        template <class TransformT>
+        inline CorrespondenceSearchProjective& findCorrespondences(const TransformT &tform, const std::vector<size_t> &src_indices) {
+            if (src_indices.empty()) {
+                correspondences_.clear();
+                return *this;
+            }
+            // If the evaluator needs all transformed source points of a shared adaptor, a bulk transform
+            // replaces the per-correspondence write-back
+            bool store_transformed = true;
+            if (!std::is_same<PointFeaturesAdaptor<ScalarT,3>,EvaluationFeatureAdaptorT>::value ||
+                &src_search_features_adaptor_ != (PointFeaturesAdaptor<ScalarT,3> *)(&src_evaluation_features_adaptor_))
+            {
+                src_evaluation_features_adaptor_.transformFeatures(tform, src_indices);
+            } else if (!IsValueOnlyEvaluator<EvaluatorT>::value) {
+                src_search_features_adaptor_.transformFeatures(tform, src_indices);
+                store_transformed = false;
+            }
+            find_correspondences_(tform, &src_indices, store_transformed, correspondences_);
             return *this;
         }
 
@@ -103,6 +131,18 @@ namespace cilantro {
             return *this;
         }
 
+        inline bool getDestinationOrganized() const { return dst_organized_; }
+
+        // Destination points are organized in the projection image (e.g. the points of an OrganizedPointCloud
+        // captured by the projection camera, possibly transformed): the point at pixel (x,y) is column
+        // y*width + x, with NaN entries for empty pixels, so that no index map needs to be rendered (destinations
+        // of any other size fall back to the index map)
+        inline CorrespondenceSearchProjective& setDestinationOrganized(bool organized) {
+            dst_organized_ = organized;
+            index_map_.resize(0,0);
+            return *this;
+        }
+
         inline CorrespondenceScalar getMaxDistance() const { return max_distance_; }
 
         inline CorrespondenceSearchProjective& setMaxDistance(CorrespondenceScalar dist_thresh) {
@@ -132,41 +172,59 @@ namespace cilantro {
         size_t projection_image_height_;
         RigidTransform<ScalarT,3> projection_extrinsics_;
         RigidTransform<ScalarT,3> projection_extrinsics_inv_;
+        bool dst_organized_;
 
         CorrespondenceScalar max_distance_;
         double inlier_fraction_;
 
         SearchResult correspondences_;
 
-        void find_correspondences_(const ConstVectorSetMatrixMap<ScalarT,3>& src_points_trans, SearchResult &correspondences) {
+        // Source points are transformed on the fly (tform may be a single transform or a TransformSet);
+        // if store_transformed is set, the transformed points of accepted correspondences are written back
+        // to the source adaptor. A NULL src_indices means all source points are queried.
+        template <class TransformT>
+        void find_correspondences_(const TransformT &tform, const std::vector<size_t> *src_indices, bool store_transformed, SearchResult &correspondences) {
             const ConstVectorSetMatrixMap<ScalarT,3>& dst_points(dst_search_features_adaptor_.getFeaturesMatrixMap());
 
-            if (index_map_.rows() != projection_image_width_ || index_map_.cols() != projection_image_height_) {
+            // Destinations that do not cover the projection image are searched through the rendered index map
+            const bool organized = dst_organized_ && (size_t)dst_points.cols() == projection_image_width_*projection_image_height_;
+            if (!organized && (index_map_.rows() != projection_image_width_ || index_map_.cols() != projection_image_height_)) {
                 index_map_.resize(projection_image_width_, projection_image_height_);
                 pointsToIndexMap<ScalarT>(dst_points, projection_extrinsics_, projection_intrinsics_, index_map_.data(), projection_image_width_, projection_image_height_);
             }
 
-            Vector<ScalarT,3> src_pt_trans_cam;
+            Vector<ScalarT,3> src_pt_trans, src_pt_trans_cam;
             const size_t empty = std::numeric_limits<size_t>::max();
 
-            SearchResult corr_tmp(src_points_trans.cols());
+            SearchResult corr_tmp((src_indices != NULL) ? src_indices->size() : src_search_features_adaptor_.getFeaturesMatrixMap().cols());
             const CorrespondenceScalar value_to_reject = max_distance_ + (CorrespondenceScalar)1.0;
 #pragma omp parallel for
             for (size_t i = 0; i < corr_tmp.size(); i++) {
                 corr_tmp[i].value = value_to_reject;
             }
-#pragma omp parallel for private (src_pt_trans_cam)
-            for (size_t i = 0; i < src_points_trans.cols(); i++) {
-                src_pt_trans_cam = projection_extrinsics_inv_*src_points_trans.col(i);
-                if (src_pt_trans_cam(2) <= (ScalarT)0.0) continue;
+#pragma omp parallel for private (src_pt_trans, src_pt_trans_cam)
+            for (size_t k = 0; k < corr_tmp.size(); k++) {
+                const size_t i = (src_indices != NULL) ? (*src_indices)[k] : k;
+                src_search_features_adaptor_.getTransformedFeature(internal::getPointTransform(tform, i), i, src_pt_trans);
+                src_pt_trans_cam = projection_extrinsics_inv_*src_pt_trans;
+                if (!(src_pt_trans_cam(2) > (ScalarT)0.0)) continue;
                 size_t x = (size_t)std::llround(src_pt_trans_cam(0)*projection_intrinsics_(0,0)/src_pt_trans_cam(2) + projection_intrinsics_(0,2));
                 size_t y = (size_t)std::llround(src_pt_trans_cam(1)*projection_intrinsics_(1,1)/src_pt_trans_cam(2) + projection_intrinsics_(1,2));
                 if (x >= projection_image_width_ || y >= projection_image_height_) continue;
-                size_t ind = index_map_(x,y);
-                if (ind == empty) continue;
-                corr_tmp[i].indexInFirst = ind;
-                corr_tmp[i].indexInSecond = i;
-                corr_tmp[i].value = evaluator_(ind, i, (src_points_trans.col(i) - dst_points.col(ind)).squaredNorm());
+                size_t ind;
+                if (organized) {
+                    ind = y*projection_image_width_ + x;
+                    if (std::isnan(dst_points(0,ind))) continue;
+                } else {
+                    ind = index_map_(x,y);
+                    if (ind == empty) continue;
+                }
+                corr_tmp[k].indexInFirst = ind;
+                corr_tmp[k].indexInSecond = i;
+                corr_tmp[k].value = evaluator_(ind, i, (src_pt_trans - dst_points.col(ind)).squaredNorm());
+                if (store_transformed && corr_tmp[k].value < max_distance_) {
+                    src_search_features_adaptor_.setTransformedFeature(i, src_pt_trans);
+                }
             }
 
             correspondences.resize(corr_tmp.size());
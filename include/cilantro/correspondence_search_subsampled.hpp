@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cilantro/correspondence_search_combined_metric_adaptor.hpp>
+#include <cilantro/point_samplers.hpp>
+
+namespace cilantro {
+    // Wraps a correspondence search engine so that, in ICP use, every call to findCorrespondences(tform)
+    // only queries a fresh random subset of the source points, drawn by PointSamplerT (see point_samplers.hpp).
+    // The wrapped engine must provide findCorrespondences(tform, src_indices).
+    template <class CorrespondenceSearchT, class PointSamplerT>
+    class CorrespondenceSearchSubsampled {
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        typedef CorrespondenceSearchT BaseCorrespondenceSearch;
+
+        typedef PointSamplerT PointSampler;
+
+        typedef typename CorrespondenceSearchCombinedMetricAdaptor<CorrespondenceSearchT>::PointToPointCorrespondenceScalar PointToPointCorrespondenceScalar;
+
+        typedef typename CorrespondenceSearchCombinedMetricAdaptor<CorrespondenceSearchT>::PointToPointCorrespondenceSearchResult PointToPointCorrespondenceSearchResult;
+
+        typedef typename CorrespondenceSearchCombinedMetricAdaptor<CorrespondenceSearchT>::PointToPlaneCorrespondenceScalar PointToPlaneCorrespondenceScalar;
+
+        typedef typename CorrespondenceSearchCombinedMetricAdaptor<CorrespondenceSearchT>::PointToPlaneCorrespondenceSearchResult PointToPlaneCorrespondenceSearchResult;
+
+        inline CorrespondenceSearchSubsampled(CorrespondenceSearchT &corr_engine, PointSamplerT &sampler)
+                : corr_engine_(corr_engine), sampler_(sampler)
+        {}
+
+        // Full (non-sampled) search
+        inline CorrespondenceSearchSubsampled& findCorrespondences() {
+            corr_engine_.findCorrespondences();
+            return *this;
+        }
+
+        // Interface for ICP use
+        template <class TransformT>
+        inline CorrespondenceSearchSubsampled& findCorrespondences(const TransformT& tform) {
+            sampler_.sampleIndices(sampled_indices_);
+            corr_engine_.findCorrespondences(tform, sampled_indices_);
+            return *this;
+        }
+
+        inline const PointToPointCorrespondenceSearchResult& getPointToPointCorrespondences() const {
+            return CorrespondenceSearchCombinedMetricAdaptor<CorrespondenceSearchT>(corr_engine_).getPointToPointCorrespondences();
+        }
+
+        inline const PointToPlaneCorrespondenceSearchResult& getPointToPlaneCorrespondences() const {
+            return CorrespondenceSearchCombinedMetricAdaptor<CorrespondenceSearchT>(corr_engine_).getPointToPlaneCorrespondences();
+        }
+
+        inline const std::vector<size_t>& getSampledIndices() const { return sampled_indices_; }
+
+        inline BaseCorrespondenceSearch& baseCorrespondenceSearchEngine() { return corr_engine_; }
+
+        inline PointSampler& pointSampler() { return sampler_; }
+
+    private:
+        CorrespondenceSearchT& corr_engine_;
+        PointSamplerT& sampler_;
+        std::vector<size_t> sampled_indices_;
+    };
+}
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <memory>
+#include <limits>
+#include <algorithm>
+#include <cilantro/grid_downsampler.hpp>
+#include <cilantro/kd_tree.hpp>
+#include <cilantro/warp_field_utilities.hpp>
+
+namespace cilantro {
+    // Incrementally maintained deformation graph for sparse warp fields (e.g. CombinedMetricSparseWarpFieldICP)
+    // over a growing, append-only point set. Control nodes are sampled by grid downsampling the points that
+    // are farther than the node resolution from all existing nodes. On each update, only the regularization
+    // (node kNN) and skinning (point-to-node kNN) neighborhoods that new nodes actually enter are recomputed
+    // (existing points are only visited near new nodes), and new node transforms are interpolated from existing
+    // ones via resampleTransforms.
+    // Neighborhood values are squared distances; regularization neighborhoods start with the node itself.
+    template <class TransformT, class WeightEvaluatorT = RBFKernelWeightEvaluator<typename TransformT::Scalar,typename TransformT::Scalar,true>>
+    class DeformationGraph {
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        typedef typename TransformT::Scalar Scalar;
+
+        enum { Dimension = TransformT::Dim };
+
+        typedef KDTree<Scalar,TransformT::Dim,KDTreeDistanceAdaptors::L2> NodeTree;
+
+        DeformationGraph(Scalar node_resolution, size_t num_skinning_neighbors = 4, size_t num_regularization_neighbors = 8)
+                : node_resolution_(node_resolution),
+                  num_skinning_neighbors_(num_skinning_neighbors),
+                  num_regularization_neighbors_(num_regularization_neighbors),
+                  weight_evaluator_(node_resolution),
+                  nodes_(TransformT::Dim, 0)
+        {}
+
+        // The node tree maps nodes_, so copies get their own
+        DeformationGraph(const DeformationGraph &other)
+                : node_resolution_(other.node_resolution_),
+                  num_skinning_neighbors_(other.num_skinning_neighbors_),
+                  num_regularization_neighbors_(other.num_regularization_neighbors_),
+                  weight_evaluator_(other.weight_evaluator_),
+                  nodes_(other.nodes_),
+                  node_transforms_(other.node_transforms_),
+                  node_tree_((nodes_.cols() > 0) ? new NodeTree(nodes_) : NULL),
+                  skinning_neighborhoods_(other.skinning_neighborhoods_),
+                  regularization_neighborhoods_(other.regularization_neighborhoods_),
+                  point_nodes_(other.point_nodes_),
+                  node_points_(other.node_points_),
+                  node_points_radius_(other.node_points_radius_)
+        {}
+
+        DeformationGraph& operator=(const DeformationGraph &other) {
+            if (this == &other) return *this;
+            node_resolution_ = other.node_resolution_;
+            num_skinning_neighbors_ = other.num_skinning_neighbors_;
+            num_regularization_neighbors_ = other.num_regularization_neighbors_;
+            weight_evaluator_ = other.weight_evaluator_;
+            nodes_ = other.nodes_;
+            node_transforms_ = other.node_transforms_;
+            node_tree_.reset((nodes_.cols() > 0) ? new NodeTree(nodes_) : NULL);
+            skinning_neighborhoods_ = other.skinning_neighborhoods_;
+            regularization_neighborhoods_ = other.regularization_neighborhoods_;
+            point_nodes_ = other.point_nodes_;
+            node_points_ = other.node_points_;
+            node_points_radius_ = other.node_points_radius_;
+            return *this;
+        }
+
+        // The first getNumberOfPoints() columns of points are assumed unchanged since the last call; returns
+        // the number of inserted nodes
+        size_t update(const ConstVectorSetMatrixMap<Scalar,TransformT::Dim> &points) {
+            const size_t num_old_points = skinning_neighborhoods_.size();
+            const size_t num_old_nodes = nodes_.cols();
+            if (points.cols() <= num_old_points) return 0;
+
+            const ConstVectorSetMatrixMap<Scalar,TransformT::Dim> new_points(points.data() + TransformT::Dim*num_old_points, points.cols() - num_old_points);
+
+            // Sample nodes on uncovered new geometry
+            VectorSet<Scalar,TransformT::Dim> new_nodes;
+            if (num_old_nodes == 0) {
+                new_nodes = PointsGridDownsampler<Scalar,TransformT::Dim>(new_points, node_resolution_).getDownsampledPoints();
+            } else {
+                const Scalar coverage_sq = node_resolution_*node_resolution_;
+                std::vector<char> uncovered(new_points.cols());
+#pragma omp parallel for
+                for (size_t i = 0; i < new_points.cols(); i++) {
+                    Neighbor<Scalar> nn;
+                    node_tree_->nearestNeighborSearch(new_points.col(i), nn);
+                    uncovered[i] = nn.value > coverage_sq;
+                }
+                std::vector<size_t> uncovered_ind;
+                for (size_t i = 0; i < uncovered.size(); i++) {
+                    if (uncovered[i]) uncovered_ind.emplace_back(i);
+                }
+                if (!uncovered_ind.empty()) {
+                    VectorSet<Scalar,TransformT::Dim> uncovered_points(TransformT::Dim, uncovered_ind.size());
+                    for (size_t i = 0; i < uncovered_ind.size(); i++) {
+                        uncovered_points.col(i) = new_points.col(uncovered_ind[i]);
+                    }
+                    new_nodes = PointsGridDownsampler<Scalar,TransformT::Dim>(uncovered_points, node_resolution_).getDownsampledPoints();
+                }
+            }
+            const size_t num_new_nodes = new_nodes.cols();
+
+            if (num_new_nodes > 0) {
+                // Carry the current warp over to the new nodes
+                TransformSet<TransformT> new_transforms;
+                if (num_old_nodes > 0) {
+                    resampleTransforms<TransformT,WeightEvaluatorT>(*node_tree_, node_transforms_, new_nodes, kNNNeighborhood<Scalar>(num_skinning_neighbors_), new_transforms, weight_evaluator_);
+                } else {
+                    new_transforms.resize(num_new_nodes);
+                    new_transforms.setIdentity();
+                }
+                node_transforms_.insert(node_transforms_.end(), new_transforms.begin(), new_transforms.end());
+
+                nodes_.conservativeResize(TransformT::Dim, num_old_nodes + num_new_nodes);
+                nodes_.rightCols(num_new_nodes) = new_nodes;
+                node_tree_.reset(new NodeTree(nodes_));
+
+                // Neighborhoods of existing nodes and points change only where a new node is closer than
+                // their current farthest neighbor
+                node_points_.resize(num_old_nodes + num_new_nodes);
+                node_points_radius_.resize(num_old_nodes + num_new_nodes, (Scalar)0.0);
+                if (num_old_nodes > 0) {
+                    const NodeTree new_node_tree(new_nodes);
+                    update_affected_node_neighborhoods_(new_node_tree, num_old_nodes);
+                    update_affected_point_neighborhoods_(new_node_tree, points, num_old_nodes);
+                }
+
+                regularization_neighborhoods_.resize(num_old_nodes + num_new_nodes);
+#pragma omp parallel for
+                for (size_t i = num_old_nodes; i < regularization_neighborhoods_.size(); i++) {
+                    node_tree_->kNNSearch(nodes_.col(i), num_regularization_neighbors_ + 1, regularization_neighborhoods_[i]);
+                }
+            }
+
+            skinning_neighborhoods_.resize(points.cols());
+#pragma omp parallel for
+            for (size_t i = num_old_points; i < skinning_neighborhoods_.size(); i++) {
+                node_tree_->kNNSearch(points.col(i), num_skinning_neighbors_, skinning_neighborhoods_[i]);
+            }
+            point_nodes_.resize(points.cols());
+            for (size_t i = num_old_points; i < skinning_neighborhoods_.size(); i++) {
+                assign_point_to_node_(i);
+            }
+
+            return num_new_nodes;
+        }
+
+        inline size_t getNumberOfNodes() const { return nodes_.cols(); }
+
+        inline size_t getNumberOfPoints() const { return skinning_neighborhoods_.size(); }
+
+        inline const VectorSet<Scalar,TransformT::Dim>& getNodes() const { return nodes_; }
+
+        inline const TransformSet<TransformT>& getNodeTransforms() const { return node_transforms_; }
+
+        // E.g. the estimate of CombinedMetricSparseWarpFieldICP::getTransform()
+        inline DeformationGraph& setNodeTransforms(const TransformSet<TransformT> &transforms) {
+            node_transforms_ = transforms;
+            return *this;
+        }
+
+        // Point-to-node neighborhoods (src_to_ctrl_neighborhoods of the sparse warp field estimators)
+        inline const std::vector<NeighborSet<Scalar>>& getSkinningNeighborhoods() const { return skinning_neighborhoods_; }
+
+        // Node-to-node neighborhoods (ctrl_regularization_neighborhoods of the sparse warp field estimators)
+        inline const std::vector<NeighborSet<Scalar>>& getRegularizationNeighborhoods() const { return regularization_neighborhoods_; }
+
+        // Interpolation weights for the transforms of new nodes
+        inline WeightEvaluatorT& weightEvaluator() { return weight_evaluator_; }
+
+        inline Scalar getNodeResolution() const { return node_resolution_; }
+
+        inline size_t getNumberOfSkinningNeighbors() const { return num_skinning_neighbors_; }
+
+        inline size_t getNumberOfRegularizationNeighbors() const { return num_regularization_neighbors_; }
+
+    private:
+        Scalar node_resolution_;
+        size_t num_skinning_neighbors_;
+        size_t num_regularization_neighbors_;
+        WeightEvaluatorT weight_evaluator_;
+
+        VectorSet<Scalar,TransformT::Dim> nodes_;
+        TransformSet<TransformT> node_transforms_;
+        std::shared_ptr<NodeTree> node_tree_;
+
+        std::vector<NeighborSet<Scalar>> skinning_neighborhoods_;
+        std::vector<NeighborSet<Scalar>> regularization_neighborhoods_;
+
+        // Every point is assigned to its nearest node; node_points_radius_[j] bounds the squared distance from the
+        // points of node j to their farthest skinning neighbor (never lowered, so it may be stale but not too small)
+        std::vector<size_t> point_nodes_;
+        std::vector<std::vector<size_t>> node_points_;
+        std::vector<Scalar> node_points_radius_;
+
+        // Squared distance to the farthest skinning neighbor (infinite if the neighborhood is not full)
+        inline Scalar skinning_radius_(size_t i) const {
+            const NeighborSet<Scalar> &nn = skinning_neighborhoods_[i];
+            return (nn.size() < num_skinning_neighbors_) ? std::numeric_limits<Scalar>::infinity() : nn.back().value;
+        }
+
+        inline void assign_point_to_node_(size_t i) {
+            const size_t node = skinning_neighborhoods_[i].front().index;
+            point_nodes_[i] = node;
+            node_points_[node].emplace_back(i);
+            node_points_radius_[node] = std::max(node_points_radius_[node], skinning_radius_(i));
+        }
+
+        void update_affected_node_neighborhoods_(const NodeTree &new_node_tree, size_t num_old_nodes) {
+            const size_t k = num_regularization_neighbors_ + 1;
+#pragma omp parallel for schedule (dynamic, 64)
+            for (size_t i = 0; i < num_old_nodes; i++) {
+                Neighbor<Scalar> nn;
+                new_node_tree.nearestNeighborSearch(nodes_.col(i), nn);
+                if (regularization_neighborhoods_[i].size() < k || nn.value < regularization_neighborhoods_[i].back().value) {
+                    node_tree_->kNNSearch(nodes_.col(i), k, regularization_neighborhoods_[i]);
+                }
+            }
+        }
+
+        // A new node m can only enter the neighborhood of point p if |p - m| < r_p (the distance to its farthest
+        // neighbor); as p's nearest node n lies within r_p of p, |n - m| < 2*r_p. Only the points of old nodes
+        // that have a new node within twice their radius bound are tested.
+        void update_affected_point_neighborhoods_(const NodeTree &new_node_tree,
+                                                  const ConstVectorSetMatrixMap<Scalar,TransformT::Dim> &points,
+                                                  size_t num_old_nodes)
+        {
+            std::vector<char> node_affected(num_old_nodes, 0);
+#pragma omp parallel for schedule (dynamic, 64)
+            for (size_t j = 0; j < num_old_nodes; j++) {
+                if (node_points_[j].empty()) continue;
+                Neighbor<Scalar> nn;
+                new_node_tree.nearestNeighborSearch(nodes_.col(j), nn);
+                node_affected[j] = nn.value < (Scalar)4.0*node_points_radius_[j];
+            }
+
+            std::vector<size_t> candidates;
+            for (size_t j = 0; j < num_old_nodes; j++) {
+                if (node_affected[j]) candidates.insert(candidates.end(), node_points_[j].begin(), node_points_[j].end());
+            }
+
+            std::vector<char> updated(candidates.size(), 0);
+#pragma omp parallel for schedule (dynamic, 256)
+            for (size_t c = 0; c < candidates.size(); c++) {
+                const size_t i = candidates[c];
+                Neighbor<Scalar> nn;
+                new_node_tree.nearestNeighborSearch(points.col(i), nn);
+                if (nn.value < skinning_radius_(i)) {
+                    node_tree_->kNNSearch(points.col(i), num_skinning_neighbors_, skinning_neighborhoods_[i]);
+                    updated[c] = 1;
+                }
+            }
+
+            // Move updated points whose nearest node changed
+            for (size_t c = 0; c < candidates.size(); c++) {
+                const size_t i = candidates[c];
+                if (!updated[c] || skinning_neighborhoods_[i].front().index == point_nodes_[i]) continue;
+                std::vector<size_t> &old_points = node_points_[point_nodes_[i]];
+                *std::find(old_points.begin(), old_points.end(), i) = old_points.back();
+                old_points.pop_back();
+                assign_point_to_node_(i);
+            }
+        }
+    };
+}
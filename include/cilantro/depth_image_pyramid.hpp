@@ -0,0 +1,304 @@
+#pragma once
+
+#include <cilantro/image_point_cloud_conversions.hpp>
+
+namespace cilantro {
+    // Raw to metric depth
+    template <class DepthConverterT>
+    void convertDepthImage(const typename DepthConverterT::RawDepth* depth_data,
+                           const DepthConverterT &depth_converter,
+                           size_t image_w, size_t image_h,
+                           typename DepthConverterT::MetricDepth* metric_depth_data)
+    {
+        const DepthConverterT dc(depth_converter);
+#pragma omp parallel for
+        for (size_t y = 0; y < image_h; y++) {
+            for (size_t x = 0; x < image_w; x++) {
+                metric_depth_data[y*image_w + x] = dc.getMetricValue(depth_data[y*image_w + x]);
+            }
+        }
+    }
+
+    // Edge preserving smoothing of metric depth images. Spatial weights are tabulated over the window and
+    // range weights over quantized depth differences, so that no exponentials are evaluated per pixel; depth
+    // differences beyond three range standard deviations get zero weight. Invalid (non-positive) depths
+    // neither contribute nor get filtered, so holes and occluding contours are preserved.
+    template <typename ScalarT>
+    class DepthImageBilateralFilter {
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        typedef ScalarT Scalar;
+
+        // sigma_space is in pixels, sigma_depth in metric depth units
+        DepthImageBilateralFilter(size_t window_radius = 3,
+                                  ScalarT sigma_space = (ScalarT)2.0,
+                                  ScalarT sigma_depth = (ScalarT)0.02,
+                                  size_t num_range_bins = 256)
+        {
+            setParameters(window_radius, sigma_space, sigma_depth, num_range_bins);
+        }
+
+        DepthImageBilateralFilter& setParameters(size_t window_radius, ScalarT sigma_space, ScalarT sigma_depth, size_t num_range_bins = 256) {
+            window_radius_ = window_radius;
+            sigma_space_ = sigma_space;
+            sigma_depth_ = sigma_depth;
+
+            const size_t window_size = 2*window_radius + 1;
+            spatial_lut_.resize(window_size*window_size);
+            for (size_t i = 0; i < window_size; i++) {
+                for (size_t j = 0; j < window_size; j++) {
+                    const ScalarT dx = (ScalarT)j - (ScalarT)window_radius, dy = (ScalarT)i - (ScalarT)window_radius;
+                    spatial_lut_[i*window_size + j] = std::exp(-(dx*dx + dy*dy)/(2*sigma_space*sigma_space));
+                }
+            }
+
+            // One extra (zero) bin for all differences beyond the tabulated range
+            range_lut_.resize(num_range_bins + 1);
+            range_bin_scale_ = (ScalarT)num_range_bins/(3*sigma_depth);
+            for (size_t b = 0; b < num_range_bins; b++) {
+                const ScalarT d = ((ScalarT)b + (ScalarT)0.5)/range_bin_scale_;
+                range_lut_[b] = std::exp(-d*d/(2*sigma_depth*sigma_depth));
+            }
+            range_lut_[num_range_bins] = (ScalarT)0.0;
+            return *this;
+        }
+
+        inline size_t getWindowRadius() const { return window_radius_; }
+
+        inline ScalarT getSigmaSpace() const { return sigma_space_; }
+
+        inline ScalarT getSigmaDepth() const { return sigma_depth_; }
+
+        // Filters a metric depth image into a different buffer of the same size
+        const DepthImageBilateralFilter& filter(const ScalarT* depth_data, size_t image_w, size_t image_h, ScalarT* filtered_data) const {
+            // Non-finite depths (e.g. NaN from converters) would give out of range bins; they are replaced by
+            // zero (invalid) in a copy, so that the inner loop stays branchless
+            const size_t num_pixels = image_w*image_h;
+            size_t num_non_finite = 0;
+#pragma omp parallel for reduction (+: num_non_finite)
+            for (size_t i = 0; i < num_pixels; i++) {
+                num_non_finite += !(std::abs(depth_data[i]) < std::numeric_limits<ScalarT>::infinity());
+            }
+            if (num_non_finite > 0) {
+                std::vector<ScalarT> finite_depth(depth_data, depth_data + num_pixels);
+                for (size_t i = 0; i < num_pixels; i++) {
+                    if (!(std::abs(finite_depth[i]) < std::numeric_limits<ScalarT>::infinity())) finite_depth[i] = (ScalarT)0.0;
+                }
+                return filter(finite_depth.data(), image_w, image_h, filtered_data);
+            }
+
+            const ptrdiff_t r = (ptrdiff_t)window_radius_;
+            const size_t window_size = 2*window_radius_ + 1;
+            const ScalarT max_bin = (ScalarT)(range_lut_.size() - 1);
+            const ScalarT* const spatial = spatial_lut_.data();
+            const ScalarT* const range = range_lut_.data();
+
+#pragma omp parallel for
+            for (size_t y = 0; y < image_h; y++) {
+                const ptrdiff_t dy0 = -std::min(r, (ptrdiff_t)y), dy1 = std::min(r, (ptrdiff_t)(image_h - 1 - y));
+                for (size_t x = 0; x < image_w; x++) {
+                    const ScalarT zc = depth_data[y*image_w + x];
+                    if (!(zc > (ScalarT)0.0)) {
+                        filtered_data[y*image_w + x] = (ScalarT)0.0;
+                        continue;
+                    }
+                    const ptrdiff_t dx0 = -std::min(r, (ptrdiff_t)x), dx1 = std::min(r, (ptrdiff_t)(image_w - 1 - x));
+                    ScalarT sum_w = (ScalarT)0.0, sum_wz = (ScalarT)0.0;
+                    for (ptrdiff_t dy = dy0; dy <= dy1; dy++) {
+                        const ScalarT* const in_row = depth_data + (y + dy)*image_w + x;
+                        const ScalarT* const spatial_row = spatial + (dy + r)*window_size + r;
+                        for (ptrdiff_t dx = dx0; dx <= dx1; dx++) {
+                            // Invalid neighbors are far from zc or get masked out, branchlessly
+                            const ScalarT zn = in_row[dx];
+                            const size_t bin = (size_t)std::min(std::abs(zn - zc)*range_bin_scale_, max_bin);
+                            const ScalarT w = (zn > (ScalarT)0.0)*spatial_row[dx]*range[bin];
+                            sum_w += w;
+                            sum_wz += w*zn;
+                        }
+                    }
+                    filtered_data[y*image_w + x] = sum_wz/sum_w;
+                }
+            }
+            return *this;
+        }
+
+        // Converts a raw depth image and filters it
+        template <class DepthConverterT, class = typename std::enable_if<std::is_same<typename DepthConverterT::MetricDepth,ScalarT>::value>::type>
+        const DepthImageBilateralFilter& filter(const typename DepthConverterT::RawDepth* depth_data,
+                                                const DepthConverterT &depth_converter,
+                                                size_t image_w, size_t image_h,
+                                                ScalarT* filtered_data) const
+        {
+            std::vector<ScalarT> metric_depth(image_w*image_h);
+            convertDepthImage(depth_data, depth_converter, image_w, image_h, metric_depth.data());
+            return filter(metric_depth.data(), image_w, image_h, filtered_data);
+        }
+
+    private:
+        size_t window_radius_;
+        ScalarT sigma_space_;
+        ScalarT sigma_depth_;
+        std::vector<ScalarT> spatial_lut_;
+        std::vector<ScalarT> range_lut_;
+        ScalarT range_bin_scale_;
+    };
+
+    typedef DepthImageBilateralFilter<float> DepthImageBilateralFilterf;
+    typedef DepthImageBilateralFilter<double> DepthImageBilateralFilterd;
+
+    // Intrinsics of the half resolution image, where pixel (x,y) covers the 2x2 block at (2x,2y) (pixel
+    // centers at integer coordinates)
+    template <typename ScalarT>
+    inline Eigen::Matrix<ScalarT,3,3> getHalfResolutionIntrinsics(const Eigen::Ref<const Eigen::Matrix<ScalarT,3,3>> &intrinsics) {
+        Eigen::Matrix<ScalarT,3,3> res(intrinsics);
+        res(0,0) *= (ScalarT)0.5;
+        res(1,1) *= (ScalarT)0.5;
+        res(0,1) *= (ScalarT)0.5;
+        res(0,2) = (intrinsics(0,2) - (ScalarT)0.5)*(ScalarT)0.5;
+        res(1,2) = (intrinsics(1,2) - (ScalarT)0.5)*(ScalarT)0.5;
+        return res;
+    }
+
+    // Depth aware 2x downsampling of a metric depth image into a (image_w/2)x(image_h/2) one: each output
+    // pixel averages the valid depths of its 2x2 block that lie within max_depth_change_factor times the
+    // nearest of them, so that foreground and background are never blended across discontinuities
+    template <typename ScalarT>
+    void downsampleDepthImage(const ScalarT* depth_data,
+                              size_t image_w, size_t image_h,
+                              ScalarT* downsampled_data,
+                              ScalarT max_depth_change_factor = (ScalarT)0.02)
+    {
+        const size_t out_w = image_w/2, out_h = image_h/2;
+        const ScalarT inf = std::numeric_limits<ScalarT>::infinity();
+#pragma omp parallel for
+        for (size_t y = 0; y < out_h; y++) {
+            const ScalarT* const row0 = depth_data + 2*y*image_w;
+            const ScalarT* const row1 = row0 + image_w;
+            for (size_t x = 0; x < out_w; x++) {
+                const ScalarT block[4] = {row0[2*x], row0[2*x + 1], row1[2*x], row1[2*x + 1]};
+                ScalarT nearest = inf;
+                for (size_t i = 0; i < 4; i++) {
+                    nearest = std::min(nearest, (block[i] > (ScalarT)0.0) ? block[i] : inf);
+                }
+                const ScalarT max_depth = nearest*((ScalarT)1.0 + max_depth_change_factor);
+                ScalarT sum = (ScalarT)0.0, count = (ScalarT)0.0;
+                for (size_t i = 0; i < 4; i++) {
+                    const ScalarT w = (block[i] > (ScalarT)0.0 && block[i] <= max_depth);
+                    sum += w*block[i];
+                    count += w;
+                }
+                downsampled_data[y*out_w + x] = (count > (ScalarT)0.0) ? sum/count : (ScalarT)0.0;
+            }
+        }
+    }
+
+    // Multi resolution metric depth for coarse to fine tracking. Level 0 is the (optionally bilateral
+    // filtered) input, and each further level halves the resolution with downsampleDepthImage. Every level
+    // keeps its intrinsics and a back projector (with its ray tables), so that it can be passed as is to
+    // depthImageToPoints, OrganizedPointCloud, or a projective correspondence search, together with the
+    // identity converter returned by getDepthConverter(). Buffers are reused across frames of the same size.
+    template <typename ScalarT>
+    class DepthImagePyramid {
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        typedef ScalarT Scalar;
+
+        // Levels hold metric depth
+        typedef DepthValueConverter<ScalarT,ScalarT> DepthConverter;
+
+        DepthImagePyramid(size_t num_levels = 3, ScalarT max_depth_change_factor = (ScalarT)0.02)
+                : num_levels_(std::max<size_t>(num_levels, 1)),
+                  max_depth_change_factor_(max_depth_change_factor)
+        {}
+
+        template <class DepthConverterT, class = typename std::enable_if<std::is_same<typename DepthConverterT::MetricDepth,ScalarT>::value>::type>
+        DepthImagePyramid& build(const typename DepthConverterT::RawDepth* depth_data,
+                                 const DepthConverterT &depth_converter,
+                                 size_t image_w, size_t image_h,
+                                 const Eigen::Ref<const Eigen::Matrix<ScalarT,3,3>> &intrinsics)
+        {
+            init_levels_(image_w, image_h, intrinsics);
+            convertDepthImage(depth_data, depth_converter, image_w, image_h, depth_[0].data());
+            build_coarser_levels_();
+            return *this;
+        }
+
+        template <class DepthConverterT, class = typename std::enable_if<std::is_same<typename DepthConverterT::MetricDepth,ScalarT>::value>::type>
+        DepthImagePyramid& build(const typename DepthConverterT::RawDepth* depth_data,
+                                 const DepthConverterT &depth_converter,
+                                 size_t image_w, size_t image_h,
+                                 const Eigen::Ref<const Eigen::Matrix<ScalarT,3,3>> &intrinsics,
+                                 const DepthImageBilateralFilter<ScalarT> &filter)
+        {
+            init_levels_(image_w, image_h, intrinsics);
+            convertDepthImage(depth_data, depth_converter, image_w, image_h, metric_depth_.data());
+            filter.filter(metric_depth_.data(), image_w, image_h, depth_[0].data());
+            build_coarser_levels_();
+            return *this;
+        }
+
+        inline size_t getNumberOfLevels() const { return num_levels_; }
+
+        inline DepthImagePyramid& setNumberOfLevels(size_t num_levels) {
+            num_levels_ = std::max<size_t>(num_levels, 1);
+            return *this;
+        }
+
+        inline ScalarT getMaxDepthChangeFactor() const { return max_depth_change_factor_; }
+
+        inline DepthImagePyramid& setMaxDepthChangeFactor(ScalarT factor) {
+            max_depth_change_factor_ = factor;
+            return *this;
+        }
+
+        inline DepthConverter getDepthConverter() const { return DepthConverter(); }
+
+        inline const ScalarT* getDepthImage(size_t level) const { return depth_[level].data(); }
+
+        inline size_t getImageWidth(size_t level) const { return back_projectors_[level].getImageWidth(); }
+
+        inline size_t getImageHeight(size_t level) const { return back_projectors_[level].getImageHeight(); }
+
+        inline const Eigen::Matrix<ScalarT,3,3>& getIntrinsics(size_t level) const { return back_projectors_[level].getIntrinsics(); }
+
+        inline const DepthImageBackProjector<ScalarT>& getBackProjector(size_t level) const { return back_projectors_[level]; }
+
+        // Points of a level, in the camera frame
+        inline const DepthImagePyramid& getPoints(size_t level, VectorSet<ScalarT,3> &points, bool keep_invalid = false) const {
+            back_projectors_[level].depthImageToPoints(depth_[level].data(), DepthConverter(), points, keep_invalid);
+            return *this;
+        }
+
+    private:
+        size_t num_levels_;
+        ScalarT max_depth_change_factor_;
+        std::vector<std::vector<ScalarT>> depth_;
+        std::vector<ScalarT> metric_depth_;
+        std::vector<DepthImageBackProjector<ScalarT>,Eigen::aligned_allocator<DepthImageBackProjector<ScalarT>>> back_projectors_;
+
+        void init_levels_(size_t image_w, size_t image_h, const Eigen::Ref<const Eigen::Matrix<ScalarT,3,3>> &intrinsics) {
+            depth_.resize(num_levels_);
+            back_projectors_.resize(num_levels_);
+            metric_depth_.resize(image_w*image_h);
+            Eigen::Matrix<ScalarT,3,3> level_intrinsics(intrinsics);
+            for (size_t l = 0; l < num_levels_; l++) {
+                depth_[l].resize(image_w*image_h);
+                back_projectors_[l].setIntrinsics(image_w, image_h, level_intrinsics);
+                image_w /= 2;
+                image_h /= 2;
+                level_intrinsics = getHalfResolutionIntrinsics<ScalarT>(level_intrinsics);
+            }
+        }
+
+        void build_coarser_levels_() {
+            for (size_t l = 1; l < num_levels_; l++) {
+                downsampleDepthImage<ScalarT>(depth_[l - 1].data(), getImageWidth(l - 1), getImageHeight(l - 1), depth_[l].data(), max_depth_change_factor_);
+            }
+        }
+    };
+
+    typedef DepthImagePyramid<float> DepthImagePyramidf;
+    typedef DepthImagePyramid<double> DepthImagePyramidd;
+}
@@ -0,0 +1,352 @@
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <cilantro/io.hpp>
+#include <cilantro/organized_point_cloud.hpp>
+#include <cilantro/timer.hpp>
+
+namespace cilantro {
+    // Fixed capacity ring buffer for exactly one producer thread and one consumer thread. Indices are
+    // published with acquire/release atomics, so that no locks are taken. They are kept on separate cache
+    // lines by explicit padding (over-aligned types are not honored by new before C++17).
+    template <typename T>
+    class BoundedSPSCQueue {
+    public:
+        BoundedSPSCQueue(size_t capacity) : buffer_(capacity + 1), head_(0), tail_(0) {}
+
+        BoundedSPSCQueue(const BoundedSPSCQueue&) = delete;
+
+        BoundedSPSCQueue& operator=(const BoundedSPSCQueue&) = delete;
+
+        inline size_t capacity() const { return buffer_.size() - 1; }
+
+        inline bool tryPush(const T &item) {
+            const size_t tail = tail_.load(std::memory_order_relaxed);
+            const size_t next = (tail + 1 == buffer_.size()) ? 0 : tail + 1;
+            if (next == head_.load(std::memory_order_acquire)) return false;
+            buffer_[tail] = item;
+            tail_.store(next, std::memory_order_release);
+            return true;
+        }
+
+        inline bool tryPop(T &item) {
+            const size_t head = head_.load(std::memory_order_relaxed);
+            if (head == tail_.load(std::memory_order_acquire)) return false;
+            item = buffer_[head];
+            head_.store((head + 1 == buffer_.size()) ? 0 : head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Blocking variants: spin briefly, then back off, so that idle stages leave the cores to busy ones
+        inline void push(const T &item) {
+            for (size_t tries = 0; !tryPush(item); tries++) wait_(tries);
+        }
+
+        inline void pop(T &item) {
+            for (size_t tries = 0; !tryPop(item); tries++) wait_(tries);
+        }
+
+    private:
+        std::vector<T> buffer_;
+        char pad0_[64];
+        std::atomic<size_t> head_;
+        char pad1_[64];
+        std::atomic<size_t> tail_;
+        char pad2_[64];
+
+        static inline void wait_(size_t tries) {
+            if (tries < 64) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+            }
+        }
+    };
+
+    // Runs a frame source and a sequence of processing stages (e.g. ingest -> convert -> track -> integrate)
+    // concurrently, one thread each, connected by bounded lock-free queues. A fixed pool of frames is
+    // allocated up front (as copies of a prototype, so buffers can be presized) and recycled from the last
+    // stage back to the source, which also bounds the number of frames in flight. Frames visit every stage
+    // in source order, so stages may keep state across frames (e.g. the previous pose), and throughput
+    // approaches that of the slowest stage. Stages that use OpenMP share the cores with the other stages.
+    // If the source or a stage throws, the source stops, later frames skip all stages, and the first
+    // exception is rethrown by wait() (or run()).
+    template <class FrameT>
+    class FramePipeline {
+    public:
+        // Fills the next frame; returns false when there are no more frames
+        typedef std::function<bool(FrameT&)> Source;
+        typedef std::function<void(FrameT&)> Stage;
+
+        FramePipeline(size_t num_frames = 4, const FrameT &frame_prototype = FrameT())
+                : frames_(std::max<size_t>(num_frames, 1), frame_prototype),
+                  stop_requested_(false),
+                  failed_(false),
+                  num_processed_(0),
+                  elapsed_time_(0.0)
+        {}
+
+        ~FramePipeline() {
+            stop();
+            join_();
+        }
+
+        inline FramePipeline& setSource(const Source &source) {
+            source_ = source;
+            return *this;
+        }
+
+        inline FramePipeline& addStage(const Stage &stage) {
+            stages_.emplace_back(stage);
+            return *this;
+        }
+
+        inline size_t getNumberOfStages() const { return stages_.size(); }
+
+        inline size_t getNumberOfFrames() const { return frames_.size(); }
+
+        // Starts the source and stage threads and returns immediately
+        FramePipeline& start() {
+            if (!threads_.empty()) return *this;
+
+            stop_requested_ = false;
+            failed_ = false;
+            exception_ = nullptr;
+            num_processed_ = 0;
+            busy_times_.assign(stages_.size() + 1, 0.0);
+
+            // A NULL frame marks the end of the stream; queues can hold all frames plus the end marker
+            queues_.clear();
+            for (size_t i = 0; i < stages_.size(); i++) {
+                queues_.emplace_back(new BoundedSPSCQueue<FrameT*>(frames_.size() + 1));
+            }
+            free_frames_.reset(new BoundedSPSCQueue<FrameT*>(frames_.size()));
+            for (size_t i = 0; i < frames_.size(); i++) free_frames_->push(&frames_[i]);
+
+            timer_.start();
+            threads_.emplace_back(&FramePipeline::run_source_, this);
+            for (size_t i = 0; i < stages_.size(); i++) {
+                threads_.emplace_back(&FramePipeline::run_stage_, this, i);
+            }
+            return *this;
+        }
+
+        // Blocks until all frames of the source have gone through all stages (or the pipeline is stopped);
+        // rethrows the first exception thrown by the source or a stage
+        FramePipeline& wait() {
+            join_();
+            if (exception_) {
+                std::exception_ptr e(exception_);
+                exception_ = nullptr;
+                std::rethrow_exception(e);
+            }
+            return *this;
+        }
+
+        inline FramePipeline& run() { return start().wait(); }
+
+        // The source stops producing; frames in flight still go through the remaining stages
+        inline FramePipeline& stop() {
+            stop_requested_ = true;
+            return *this;
+        }
+
+        inline bool isRunning() const { return !threads_.empty(); }
+
+        inline size_t getNumberOfProcessedFrames() const { return num_processed_; }
+
+        // Wall clock time of the last run, in ms
+        inline double getElapsedTime() const { return elapsed_time_; }
+
+        // Time spent working (not waiting) in the source (first entry) and in each stage, in ms
+        inline const std::vector<double>& getBusyTimes() const { return busy_times_; }
+
+    private:
+        std::vector<FrameT,Eigen::aligned_allocator<FrameT>> frames_;
+        Source source_;
+        std::vector<Stage> stages_;
+
+        std::vector<std::unique_ptr<BoundedSPSCQueue<FrameT*>>> queues_;
+        std::unique_ptr<BoundedSPSCQueue<FrameT*>> free_frames_;
+        std::vector<std::thread> threads_;
+
+        std::atomic<bool> stop_requested_;
+        std::atomic<bool> failed_;
+        std::mutex exception_mutex_;
+        std::exception_ptr exception_;
+        std::atomic<size_t> num_processed_;
+        std::vector<double> busy_times_;
+        Timer timer_;
+        double elapsed_time_;
+
+        void join_() {
+            for (size_t i = 0; i < threads_.size(); i++) threads_[i].join();
+            if (!threads_.empty()) elapsed_time_ = timer_.stopAndGetElapsedTime();
+            threads_.clear();
+        }
+
+        // Keeps the first exception and winds the pipeline down
+        void set_failed_(std::exception_ptr e) {
+            std::lock_guard<std::mutex> lock(exception_mutex_);
+            if (!exception_) exception_ = e;
+            failed_ = true;
+            stop_requested_ = true;
+        }
+
+        inline void recycle_(FrameT *frame) {
+            num_processed_++;
+            free_frames_->push(frame);
+        }
+
+        void run_source_() {
+            Timer timer;
+            FrameT *frame;
+            while (!stop_requested_) {
+                free_frames_->pop(frame);
+                timer.start();
+                bool has_frame = false;
+                try {
+                    has_frame = source_(*frame);
+                } catch (...) {
+                    set_failed_(std::current_exception());
+                }
+                busy_times_[0] += timer.stopAndGetElapsedTime();
+                // The unused frame is not handed back here, as the last stage is the only producer of free frames
+                if (!has_frame) break;
+                if (stages_.empty()) {
+                    recycle_(frame);
+                } else {
+                    queues_[0]->push(frame);
+                }
+            }
+            if (!stages_.empty()) queues_[0]->push(NULL);
+        }
+
+        void run_stage_(size_t stage) {
+            Timer timer;
+            FrameT *frame;
+            while (true) {
+                queues_[stage]->pop(frame);
+                if (frame != NULL && !failed_) {
+                    timer.start();
+                    try {
+                        stages_[stage](*frame);
+                    } catch (...) {
+                        set_failed_(std::current_exception());
+                    }
+                    busy_times_[stage + 1] += timer.stopAndGetElapsedTime();
+                }
+                if (stage + 1 < stages_.size()) {
+                    queues_[stage + 1]->push(frame);
+                } else if (frame != NULL) {
+                    recycle_(frame);
+                }
+                if (frame == NULL) break;
+            }
+        }
+    };
+
+    // Frame with raw RGB-D images and their organized point cloud, to be used with FramePipeline
+    template <typename ScalarT, typename RawDepthT = unsigned short>
+    struct RGBDFrame {
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        typedef ScalarT Scalar;
+        typedef RawDepthT RawDepth;
+
+        RGBDFrame() : index(0), pose(RigidTransform<ScalarT,3>::Identity()) {}
+
+        // Preallocates image buffers
+        RGBDFrame(size_t image_w, size_t image_h)
+                : index(0), rgb(3*image_w*image_h), depth(image_w*image_h),
+                  pose(RigidTransform<ScalarT,3>::Identity())
+        {}
+
+        size_t index;
+        std::vector<unsigned char> rgb;
+        std::vector<RawDepthT> depth;
+        OrganizedPointCloud<ScalarT> cloud;
+        RigidTransform<ScalarT,3> pose;
+    };
+
+    typedef RGBDFrame<float> RGBDFramef;
+    typedef RGBDFrame<double> RGBDFramed;
+
+    // Reads raw RGB-D frames from files, e.g. for running a pipeline without a camera. File names are given
+    // as printf style patterns of the frame index (e.g. "depth_%06zu.raw"); depth files hold image_w*image_h
+    // RawDepthT values and RGB files image_w*image_h interleaved RGB bytes, both in row major order. An empty
+    // RGB pattern reads depth only. The source ends at the first missing frame, or after num_frames.
+    template <typename RawDepthT = unsigned short>
+    class RGBDFileSource {
+    public:
+        RGBDFileSource(const std::string &depth_file_pattern,
+                       const std::string &rgb_file_pattern,
+                       size_t image_w, size_t image_h,
+                       size_t first_index = 0,
+                       size_t num_frames = std::numeric_limits<size_t>::max())
+                : depth_file_pattern_(depth_file_pattern), rgb_file_pattern_(rgb_file_pattern),
+                  image_w_(image_w), image_h_(image_h),
+                  next_index_(first_index), end_index_((num_frames > std::numeric_limits<size_t>::max() - first_index) ? std::numeric_limits<size_t>::max() : first_index + num_frames)
+        {}
+
+        inline size_t getImageWidth() const { return image_w_; }
+
+        inline size_t getImageHeight() const { return image_h_; }
+
+        inline size_t getNextFrameIndex() const { return next_index_; }
+
+        // Reads the next frame into caller allocated buffers (rgb_data may be NULL)
+        bool grab(unsigned char* rgb_data, RawDepthT* depth_data) {
+            if (next_index_ >= end_index_) return false;
+            const std::string depth_file(get_file_name_(depth_file_pattern_, next_index_));
+            const size_t depth_bytes = image_w_*image_h_*sizeof(RawDepthT);
+            if (getFileSizeInBytes(depth_file) != depth_bytes) return false;
+            const bool read_rgb = rgb_data != NULL && !rgb_file_pattern_.empty();
+            const std::string rgb_file(read_rgb ? get_file_name_(rgb_file_pattern_, next_index_) : std::string());
+            if (read_rgb && getFileSizeInBytes(rgb_file) != 3*image_w_*image_h_) return false;
+
+            readRawDataFromFile(depth_file, depth_data, depth_bytes);
+            if (read_rgb) readRawDataFromFile(rgb_file, rgb_data, 3*image_w_*image_h_);
+            next_index_++;
+            return true;
+        }
+
+        template <typename ScalarT>
+        inline bool grab(RGBDFrame<ScalarT,RawDepthT> &frame) {
+            frame.index = next_index_;
+            frame.depth.resize(image_w_*image_h_);
+            if (!rgb_file_pattern_.empty()) frame.rgb.resize(3*image_w_*image_h_);
+            return grab(rgb_file_pattern_.empty() ? NULL : frame.rgb.data(), frame.depth.data());
+        }
+
+        // Source callable for FramePipeline<RGBDFrame<ScalarT,RawDepthT>>
+        template <typename ScalarT>
+        inline std::function<bool(RGBDFrame<ScalarT,RawDepthT>&)> getPipelineSource() {
+            return [this](RGBDFrame<ScalarT,RawDepthT> &frame) { return this->grab(frame); };
+        }
+
+    private:
+        std::string depth_file_pattern_;
+        std::string rgb_file_pattern_;
+        size_t image_w_;
+        size_t image_h_;
+        size_t next_index_;
+        size_t end_index_;
+
+        static std::string get_file_name_(const std::string &pattern, size_t index) {
+            std::vector<char> buf(pattern.size() + 32);
+            int len = std::snprintf(buf.data(), buf.size(), pattern.c_str(), index);
+            if (len >= (int)buf.size()) {
+                buf.resize(len + 1);
+                std::snprintf(buf.data(), buf.size(), pattern.c_str(), index);
+            }
+            return std::string(buf.data());
+        }
+    };
+}
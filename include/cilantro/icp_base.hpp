@@ -2,9 +2,39 @@
 
 #include <cstddef>
 #include <limits>
+#include <atomic>
+#include <type_traits>
 #include <Eigen/Dense>
+#include <cilantro/timer.hpp>
 
 namespace cilantro {
+    // Defined in correspondence_search_combined_metric_adaptor.hpp, which every ICP instance already includes
+    template <class CorrespondenceSearchT>
+    class CorrespondenceSearchCombinedMetricAdaptor;
+
+    // Per-iteration ICP telemetry, as reported to estimate(observer)
+    template <typename ScalarT>
+    struct ICPIterationStatistics {
+        size_t iteration;
+        size_t numPointToPointCorrespondences;
+        size_t numPointToPlaneCorrespondences;
+        double correspondenceUpdateTime;        // Time spent in updateCorrespondences() (ms)
+        double estimateUpdateTime;              // Time spent in updateEstimate() (ms)
+        ScalarT updateNorm;
+        // Statistics of the correspondence values (as given by the search engine's evaluator)
+        ScalarT correspondenceValueMin;
+        ScalarT correspondenceValueMax;
+        ScalarT correspondenceValueMean;
+    };
+
+    namespace internal {
+        // Default observer for estimate(); all telemetry code is compiled out when it is used
+        struct NullICPIterationObserver {
+            template <typename ScalarT>
+            inline void operator()(const ICPIterationStatistics<ScalarT> &) const {}
+        };
+    }
+
     // CRTP base class
     template <class ICPInstanceT, class TransformT, class CorrespondenceSearchEngineT, class ResidualVectorT>
     class IterativeClosestPointBase {
@@ -30,6 +60,9 @@ namespace cilantro {
                   iterations_(0),
                   convergence_tol_(conv_tol),
                   last_delta_norm_(std::numeric_limits<PointScalar>::infinity()),
+                  time_budget_(std::numeric_limits<double>::infinity()),
+                  cancellation_flag_(NULL),
+                  terminated_early_(false),
                   correspondence_search_engine_(corr_engine)
         {}
 
@@ -51,6 +84,22 @@ namespace cilantro {
             return *static_cast<ICPInstanceT*>(this);
         }
 
+        // Wall-clock budget (in milliseconds) for a single estimate() call; checked between iterations
+        inline double getTimeBudget() const { return time_budget_; }
+
+        inline ICPInstanceT& setTimeBudget(double time_budget_ms) {
+            time_budget_ = time_budget_ms;
+            return *static_cast<ICPInstanceT*>(this);
+        }
+
+        inline const std::atomic<bool>* getCancellationFlag() const { return cancellation_flag_; }
+
+        // estimate() stops before the next iteration once *flag becomes true (NULL disables)
+        inline ICPInstanceT& setCancellationFlag(const std::atomic<bool> *flag) {
+            cancellation_flag_ = flag;
+            return *static_cast<ICPInstanceT*>(this);
+        }
+
         inline const Transform& getInitialTransform() const { return transform_init_; }
 
         inline ICPInstanceT& setInitialTransform(const Transform& tform_init) {
@@ -63,19 +112,51 @@ namespace cilantro {
         inline PointScalar getLastUpdateNorm() const { return last_delta_norm_; }
 
         // Main ICP loop
-        ICPInstanceT& estimate() {
+        inline ICPInstanceT& estimate() {
+            return estimate(internal::NullICPIterationObserver());
+        }
+
+        // Main ICP loop; observer(const ICPIterationStatistics<PointScalar> &) is called after every iteration
+        template <class IterationObserverT>
+        ICPInstanceT& estimate(IterationObserverT &&observer) {
+            const bool observe = !std::is_same<typename std::decay<IterationObserverT>::type,internal::NullICPIterationObserver>::value;
+
             ICPInstanceT& icp_instance = *static_cast<ICPInstanceT*>(this);
 
             transform_ = transform_init_;
             iterations_ = 0;
             last_delta_norm_ = std::numeric_limits<PointScalar>::infinity();
+            terminated_early_ = false;
+            Timer timer(true);
+            Timer step_timer;
+            ICPIterationStatistics<PointScalar> stats;
             icp_instance.initializeComputation();
 
             while (iterations_ < max_iterations_) {
+                // Stop between iterations if out of time or cancelled; transform_ holds the latest estimate
+                if ((cancellation_flag_ != NULL && cancellation_flag_->load(std::memory_order_relaxed)) ||
+                    timer.getElapsedTimeSinceStart() >= time_budget_)
+                {
+                    terminated_early_ = true;
+                    break;
+                }
+
                 // Update correspondences_
+                if (observe) step_timer.start();
                 icp_instance.updateCorrespondences();
+                if (observe) stats.correspondenceUpdateTime = step_timer.stopAndGetElapsedTime();
+
                 // Update transform_ and last_delta_norm_ based on correspondences_
+                if (observe) step_timer.start();
                 icp_instance.updateEstimate();
+                if (observe) stats.estimateUpdateTime = step_timer.stopAndGetElapsedTime();
+
+                if (observe) {
+                    stats.iteration = iterations_;
+                    stats.updateNorm = last_delta_norm_;
+                    compute_correspondence_statistics_(stats);
+                    observer(static_cast<const ICPIterationStatistics<PointScalar>&>(stats));
+                }
 
                 iterations_++;
                 if (last_delta_norm_ < convergence_tol_) break;
@@ -101,12 +182,19 @@ namespace cilantro {
 
         inline bool hasConverged() const { return last_delta_norm_ < convergence_tol_; }
 
+        // True if the last estimate() call was stopped by the time budget or the cancellation flag
+        inline bool hasTerminatedEarly() const { return terminated_early_; }
+
     protected:
         size_t max_iterations_;
         size_t iterations_;
         PointScalar convergence_tol_;
         PointScalar last_delta_norm_;
 
+        double time_budget_;
+        const std::atomic<bool> *cancellation_flag_;
+        bool terminated_early_;
+
         CorrespondenceSearchEngine& correspondence_search_engine_;
 
         Transform transform_init_;
@@ -114,5 +202,40 @@ namespace cilantro {
 
         // Default implementation
         inline void initializeComputation() {}
+
+    private:
+        template <class CorrespondenceSetT>
+        inline void accumulate_correspondence_statistics_(const CorrespondenceSetT &correspondences,
+                                                          PointScalar &min_val, PointScalar &max_val,
+                                                          PointScalar &sum) const
+        {
+            for (size_t i = 0; i < correspondences.size(); i++) {
+                const PointScalar val = (PointScalar)correspondences[i].value;
+                if (val < min_val) min_val = val;
+                if (val > max_val) max_val = val;
+                sum += val;
+            }
+        }
+
+        void compute_correspondence_statistics_(ICPIterationStatistics<PointScalar> &stats) const {
+            CorrespondenceSearchCombinedMetricAdaptor<CorrespondenceSearchEngine> corr_getter_proxy(correspondence_search_engine_);
+            const auto& point_corr = corr_getter_proxy.getPointToPointCorrespondences();
+            const auto& plane_corr = corr_getter_proxy.getPointToPlaneCorrespondences();
+            const bool shared = (void *)(&point_corr) == (void *)(&plane_corr);
+
+            stats.numPointToPointCorrespondences = point_corr.size();
+            stats.numPointToPlaneCorrespondences = plane_corr.size();
+
+            PointScalar min_val = std::numeric_limits<PointScalar>::infinity();
+            PointScalar max_val = -std::numeric_limits<PointScalar>::infinity();
+            PointScalar sum = (PointScalar)0.0;
+            accumulate_correspondence_statistics_(point_corr, min_val, max_val, sum);
+            if (!shared) accumulate_correspondence_statistics_(plane_corr, min_val, max_val, sum);
+
+            const size_t count = point_corr.size() + (shared ? 0 : plane_corr.size());
+            stats.correspondenceValueMin = (count > 0) ? min_val : std::numeric_limits<PointScalar>::quiet_NaN();
+            stats.correspondenceValueMax = (count > 0) ? max_val : std::numeric_limits<PointScalar>::quiet_NaN();
+            stats.correspondenceValueMean = (count > 0) ? sum/count : std::numeric_limits<PointScalar>::quiet_NaN();
+        }
     };
 }
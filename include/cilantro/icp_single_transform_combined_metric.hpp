@@ -31,7 +31,8 @@ namespace cilantro {
                   max_optimization_iterations_(1), optimization_convergence_tol_((typename TransformT::Scalar)1e-5),
                   point_to_point_weight_((typename TransformT::Scalar)0.0), point_to_plane_weight_((typename TransformT::Scalar)1.0),
                   point_corr_eval_(point_corr_eval), plane_corr_eval_(plane_corr_eval),
-                  src_points_trans_(src_points_.rows(), src_points_.cols())
+                  src_points_trans_(src_points_.rows(), src_points_.cols()),
+                  src_point_marked_(src_points_.cols(), 0)
         {
             this->transform_init_.setIdentity();
         }
@@ -87,6 +88,10 @@ namespace cilantro {
 
         VectorSet<typename TransformT::Scalar,TransformT::Dim> src_points_trans_;
 
+        // Distinct source indices of the current correspondences; src_point_marked_ is all zeros between calls
+        std::vector<char> src_point_marked_;
+        std::vector<size_t> corresponding_src_indices_;
+
         // ICP interface
         inline void initializeComputation() {}
 
@@ -96,9 +101,23 @@ namespace cilantro {
         }
 
         void updateEstimate() {
-            transformPoints(this->transform_, src_points_, src_points_trans_);
-
             CorrespondenceSearchCombinedMetricAdaptor<CorrespondenceSearchEngineT> corr_getter_proxy(this->correspondence_search_engine_);
+
+            // Only transform the source points that take part in a correspondence, each one once (search
+            // directions other than SECOND_TO_FIRST may match a source point more than once)
+            corresponding_src_indices_.clear();
+            collect_corresponding_points_(corr_getter_proxy.getPointToPointCorrespondences());
+            if (&corr_getter_proxy.getPointToPlaneCorrespondences() != &corr_getter_proxy.getPointToPointCorrespondences()) {
+                collect_corresponding_points_(corr_getter_proxy.getPointToPlaneCorrespondences());
+            }
+#pragma omp parallel for
+            for (size_t i = 0; i < corresponding_src_indices_.size(); i++) {
+                src_points_trans_.col(corresponding_src_indices_[i]).noalias() = this->transform_*src_points_.col(corresponding_src_indices_[i]);
+            }
+            for (size_t i = 0; i < corresponding_src_indices_.size(); i++) {
+                src_point_marked_[corresponding_src_indices_[i]] = 0;
+            }
+
             TransformT tform_iter;
             estimateTransformCombinedMetric(dst_points_, dst_normals_, src_points_trans_, corr_getter_proxy.getPointToPointCorrespondences(), point_to_point_weight_, corr_getter_proxy.getPointToPlaneCorrespondences(), point_to_plane_weight_, tform_iter, max_optimization_iterations_, optimization_convergence_tol_, point_corr_eval_, plane_corr_eval_);
 
@@ -109,6 +128,16 @@ namespace cilantro {
             this->last_delta_norm_ = std::sqrt((tform_iter.linear() - TransformT::LinearMatrixType::Identity()).squaredNorm() + tform_iter.translation().squaredNorm());
         }
 
+        template <class CorrespondenceSetT>
+        inline void collect_corresponding_points_(const CorrespondenceSetT &correspondences) {
+            for (size_t i = 0; i < correspondences.size(); i++) {
+                const size_t ind = correspondences[i].indexInSecond;
+                if (src_point_marked_[ind]) continue;
+                src_point_marked_[ind] = 1;
+                corresponding_src_indices_.emplace_back(ind);
+            }
+        }
+
         // ICP interface
         VectorSet<typename TransformT::Scalar,1> computeResiduals() {
             if (dst_points_.cols() == 0) {
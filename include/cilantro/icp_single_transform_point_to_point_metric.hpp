@@ -21,7 +21,8 @@ namespace cilantro {
                                              CorrespondenceSearchEngineT &corr_engine)
                 : Base(corr_engine),
                   dst_points_(dst), src_points_(src),
-                  src_points_trans_(src_points_.rows(), src_points_.cols())
+                  src_points_trans_(src_points_.rows(), src_points_.cols()),
+                  src_point_marked_(src_points_.cols(), 0)
         {
             this->transform_init_.setIdentity();
         }
@@ -32,6 +33,10 @@ namespace cilantro {
 
         VectorSet<typename TransformT::Scalar,TransformT::Dim> src_points_trans_;
 
+        // Distinct source indices of the current correspondences; src_point_marked_ is all zeros between calls
+        std::vector<char> src_point_marked_;
+        std::vector<size_t> corresponding_src_indices_;
+
         // ICP interface
         inline void initializeComputation() {}
 
@@ -41,11 +46,28 @@ namespace cilantro {
         }
 
         void updateEstimate() {
-            transformPoints(this->transform_, src_points_, src_points_trans_);
-
             CorrespondenceSearchCombinedMetricAdaptor<CorrespondenceSearchEngineT> corr_getter_proxy(this->correspondence_search_engine_);
+            const auto& correspondences = corr_getter_proxy.getPointToPointCorrespondences();
+
+            // Only transform the source points that take part in a correspondence, each one once (search
+            // directions other than SECOND_TO_FIRST may match a source point more than once)
+            corresponding_src_indices_.clear();
+            for (size_t i = 0; i < correspondences.size(); i++) {
+                const size_t ind = correspondences[i].indexInSecond;
+                if (src_point_marked_[ind]) continue;
+                src_point_marked_[ind] = 1;
+                corresponding_src_indices_.emplace_back(ind);
+            }
+#pragma omp parallel for
+            for (size_t i = 0; i < corresponding_src_indices_.size(); i++) {
+                src_points_trans_.col(corresponding_src_indices_[i]).noalias() = this->transform_*src_points_.col(corresponding_src_indices_[i]);
+            }
+            for (size_t i = 0; i < corresponding_src_indices_.size(); i++) {
+                src_point_marked_[corresponding_src_indices_[i]] = 0;
+            }
+
             TransformT tform_iter;
-            estimateTransformPointToPointMetric(dst_points_, src_points_trans_, corr_getter_proxy.getPointToPointCorrespondences(), tform_iter);
+            estimateTransformPointToPointMetric(dst_points_, src_points_trans_, correspondences, tform_iter);
 
             this->transform_ = tform_iter*this->transform_;
             if (int(Base::Transform::Mode) == int(Eigen::Isometry)) {
@@ -38,6 +38,7 @@ namespace cilantro {
                   stiffness_weight_((typename TransformT::Scalar)1.0), huber_boundary_((typename TransformT::Scalar)1e-4),
                   max_gauss_newton_iterations_(10), gauss_newton_convergence_tol_((typename TransformT::Scalar)1e-5),
                   max_conjugate_gradient_iterations_(1000), conjugate_gradient_convergence_tol_((typename TransformT::Scalar)1e-5),
+                  num_cg_iterations_(0),
                   point_corr_eval_(point_corr_eval), plane_corr_eval_(plane_corr_eval), reg_eval_(reg_eval),
                   src_points_trans_(src_points_.rows(), src_points_.cols()), tforms_iter_(src_points_.cols())
         {
@@ -104,6 +105,51 @@ namespace cilantro {
             return *this;
         }
 
+        inline ConjugateGradientPreconditioner getConjugateGradientPreconditioner() const { return linear_solver_.getPreconditioner(); }
+
+        // MULTILEVEL needs a node hierarchy, which dense warp fields do not have
+        inline CombinedMetricDenseWarpFieldICP& setConjugateGradientPreconditioner(const ConjugateGradientPreconditioner &preconditioner) {
+            eigen_assert(preconditioner != ConjugateGradientPreconditioner::MULTILEVEL && "CombinedMetricDenseWarpFieldICP: MULTILEVEL preconditioner is only supported by sparse warp fields");
+            linear_solver_.setPreconditioner(preconditioner);
+            return *this;
+        }
+
+        inline bool getUseMatrixFreeConjugateGradient() const { return linear_solver_.getMatrixFree(); }
+
+        // If set, CG runs on a matrix-free normal equations operator (lower memory, parallel products)
+        inline CombinedMetricDenseWarpFieldICP& setUseMatrixFreeConjugateGradient(bool matrix_free) {
+            linear_solver_.setMatrixFree(matrix_free);
+            return *this;
+        }
+
+        inline bool getUseWarmStartedConjugateGradient() const { return linear_solver_.getWarmStart(); }
+
+        // If set, CG starts from the (optimally scaled) step of the previous Gauss-Newton or ICP iteration
+        inline CombinedMetricDenseWarpFieldICP& setUseWarmStartedConjugateGradient(bool warm_start) {
+            linear_solver_.setWarmStart(warm_start);
+            return *this;
+        }
+
+        inline bool getUseAdaptiveConjugateGradientTolerance() const { return linear_solver_.getAdaptiveTolerance(); }
+
+        // If set, each CG solve stops at an Eisenstat-Walker inexact Newton tolerance, never tighter than
+        // the conjugate gradient convergence tolerance
+        inline CombinedMetricDenseWarpFieldICP& setUseAdaptiveConjugateGradientTolerance(bool adaptive_tolerance) {
+            linear_solver_.setAdaptiveTolerance(adaptive_tolerance);
+            return *this;
+        }
+
+        inline WarpFieldLinearSolverType getLinearSolverType() const { return linear_solver_.getSolverType(); }
+
+        // SPARSE_LDLT solves each Gauss-Newton step exactly, reusing the symbolic factorization within an estimate() call
+        inline CombinedMetricDenseWarpFieldICP& setLinearSolverType(const WarpFieldLinearSolverType &solver_type) {
+            linear_solver_.setSolverType(solver_type);
+            return *this;
+        }
+
+        // Total number of CG iterations performed during the last estimate() call
+        inline size_t getNumberOfPerformedConjugateGradientIterations() const { return num_cg_iterations_; }
+
         inline typename TransformT::Scalar getHuberLossBoundary() const { return huber_boundary_; }
 
         inline CombinedMetricDenseWarpFieldICP& setHuberLossBoundary(typename TransformT::Scalar huber_boundary) {
@@ -126,6 +172,8 @@ namespace cilantro {
         typename TransformT::Scalar gauss_newton_convergence_tol_;
         size_t max_conjugate_gradient_iterations_;
         typename TransformT::Scalar conjugate_gradient_convergence_tol_;
+        size_t num_cg_iterations_;
+        WarpFieldLinearSolver<typename TransformT::Scalar,(int(TransformT::Mode) == int(Eigen::Isometry)) ? TransformT::Dim*(TransformT::Dim + 1)/2 : TransformT::Dim*(TransformT::Dim + 1)> linear_solver_;
 
         PointToPointCorrespondenceWeightEvaluator& point_corr_eval_;
         PointToPlaneCorrespondenceWeightEvaluator& plane_corr_eval_;
@@ -135,7 +183,10 @@ namespace cilantro {
         TransformSet<TransformT> tforms_iter_;
 
         // ICP interface
-        inline void initializeComputation() {}
+        inline void initializeComputation() {
+            num_cg_iterations_ = 0;
+            linear_solver_.reset();
+        }
 
         // ICP interface
         inline void updateCorrespondences() {
@@ -147,7 +198,9 @@ namespace cilantro {
             transformPoints(this->transform_, src_points_, src_points_trans_);
 
             CorrespondenceSearchCombinedMetricAdaptor<CorrespondenceSearchEngineT> corr_getter_proxy(this->correspondence_search_engine_);
-            estimateDenseWarpFieldCombinedMetric(dst_points_, dst_normals_, src_points_trans_, corr_getter_proxy.getPointToPointCorrespondences(), point_to_point_weight_, corr_getter_proxy.getPointToPlaneCorrespondences(), point_to_plane_weight_, regularization_neighborhoods_, stiffness_weight_, tforms_iter_, huber_boundary_, max_gauss_newton_iterations_, gauss_newton_convergence_tol_, max_conjugate_gradient_iterations_, conjugate_gradient_convergence_tol_, point_corr_eval_, plane_corr_eval_, reg_eval_);
+            const size_t cg_iterations_start = linear_solver_.getNumberOfPerformedIterations();
+            estimateDenseWarpFieldCombinedMetric(dst_points_, dst_normals_, src_points_trans_, corr_getter_proxy.getPointToPointCorrespondences(), point_to_point_weight_, corr_getter_proxy.getPointToPlaneCorrespondences(), point_to_plane_weight_, regularization_neighborhoods_, stiffness_weight_, tforms_iter_, huber_boundary_, max_gauss_newton_iterations_, gauss_newton_convergence_tol_, max_conjugate_gradient_iterations_, conjugate_gradient_convergence_tol_, point_corr_eval_, plane_corr_eval_, reg_eval_, &linear_solver_);
+            num_cg_iterations_ += linear_solver_.getNumberOfPerformedIterations() - cg_iterations_start;
             this->transform_.preApply(tforms_iter_);
 
             typename TransformT::Scalar max_delta_norm_sq = (typename TransformT::Scalar)0.0;
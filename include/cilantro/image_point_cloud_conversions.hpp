@@ -1,5 +1,11 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include <cilantro/space_transformations.hpp>
 
 namespace cilantro {
@@ -53,6 +59,196 @@ namespace cilantro {
         const MetricDepthT maxDepth;
     };
 
+    // Back-projection of depth images through pinhole intrinsics. Pixel rays are separable, so the per column
+    // ((x - cx)/fx) and per row ((y - cy)/fy) coefficients are tabulated once per image size and intrinsics
+    // and reused across frames, leaving one depth conversion and two multiplications per pixel. Coordinates are
+    // computed as z*((x - cx)/fx), which may differ in the last bits from (x - cx)*z/fx. When invalid pixels
+    // are dropped, rows are counted first and then written in parallel at their compacted offsets.
+    template <typename ScalarT>
+    class DepthImageBackProjector {
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        typedef ScalarT Scalar;
+
+        DepthImageBackProjector()
+                : image_w_(0), image_h_(0), intrinsics_(Eigen::Matrix<ScalarT,3,3>::Zero())
+        {}
+
+        DepthImageBackProjector(size_t image_w, size_t image_h, const Eigen::Ref<const Eigen::Matrix<ScalarT,3,3>> &intrinsics)
+                : image_w_(0), image_h_(0), intrinsics_(Eigen::Matrix<ScalarT,3,3>::Zero())
+        {
+            setIntrinsics(image_w, image_h, intrinsics);
+        }
+
+        // Rebuilds the ray tables only if the image size or intrinsics changed
+        DepthImageBackProjector& setIntrinsics(size_t image_w, size_t image_h, const Eigen::Ref<const Eigen::Matrix<ScalarT,3,3>> &intrinsics) {
+            if (image_w == image_w_ && image_h == image_h_ && intrinsics == intrinsics_) return *this;
+            image_w_ = image_w;
+            image_h_ = image_h;
+            intrinsics_ = intrinsics;
+            ray_x_.resize(image_w);
+            ray_y_.resize(image_h);
+            for (size_t x = 0; x < image_w; x++) ray_x_[x] = (x - intrinsics(0,2))/intrinsics(0,0);
+            for (size_t y = 0; y < image_h; y++) ray_y_[y] = (y - intrinsics(1,2))/intrinsics(1,1);
+            return *this;
+        }
+
+        inline size_t getImageWidth() const { return image_w_; }
+
+        inline size_t getImageHeight() const { return image_h_; }
+
+        inline const Eigen::Matrix<ScalarT,3,3>& getIntrinsics() const { return intrinsics_; }
+
+        template <class DepthConverterT>
+        inline const DepthImageBackProjector& depthImageToPoints(const typename DepthConverterT::RawDepth* depth_data,
+                                                                 const DepthConverterT &depth_converter,
+                                                                 VectorSet<ScalarT,3> &points,
+                                                                 bool keep_invalid = false) const
+        {
+            back_project_<DepthConverterT,false,false>(nullptr, depth_data, depth_converter, nullptr, points, nullptr, keep_invalid);
+            return *this;
+        }
+
+        template <class DepthConverterT>
+        inline const DepthImageBackProjector& depthImageToPoints(const typename DepthConverterT::RawDepth* depth_data,
+                                                                 const DepthConverterT &depth_converter,
+                                                                 const RigidTransform<ScalarT,3> &extrinsics,
+                                                                 VectorSet<ScalarT,3> &points,
+                                                                 bool keep_invalid = false) const
+        {
+            back_project_<DepthConverterT,false,true>(nullptr, depth_data, depth_converter, &extrinsics, points, nullptr, keep_invalid);
+            return *this;
+        }
+
+        template <class DepthConverterT>
+        inline const DepthImageBackProjector& RGBDImagesToPointsColors(const unsigned char* rgb_data,
+                                                                       const typename DepthConverterT::RawDepth* depth_data,
+                                                                       const DepthConverterT &depth_converter,
+                                                                       VectorSet<ScalarT,3> &points,
+                                                                       VectorSet<float,3> &colors,
+                                                                       bool keep_invalid = false) const
+        {
+            back_project_<DepthConverterT,true,false>(rgb_data, depth_data, depth_converter, nullptr, points, &colors, keep_invalid);
+            return *this;
+        }
+
+        template <class DepthConverterT>
+        inline const DepthImageBackProjector& RGBDImagesToPointsColors(const unsigned char* rgb_data,
+                                                                       const typename DepthConverterT::RawDepth* depth_data,
+                                                                       const DepthConverterT &depth_converter,
+                                                                       const RigidTransform<ScalarT,3> &extrinsics,
+                                                                       VectorSet<ScalarT,3> &points,
+                                                                       VectorSet<float,3> &colors,
+                                                                       bool keep_invalid = false) const
+        {
+            back_project_<DepthConverterT,true,true>(rgb_data, depth_data, depth_converter, &extrinsics, points, &colors, keep_invalid);
+            return *this;
+        }
+
+    private:
+        size_t image_w_;
+        size_t image_h_;
+        Eigen::Matrix<ScalarT,3,3> intrinsics_;
+        std::vector<ScalarT> ray_x_;
+        std::vector<ScalarT> ray_y_;
+
+        template <class DepthConverterT, bool WithColors, bool WithExtrinsics>
+        void back_project_(const unsigned char* rgb_data,
+                           const typename DepthConverterT::RawDepth* depth_data,
+                           const DepthConverterT &depth_converter_in,
+                           const RigidTransform<ScalarT,3> *extrinsics,
+                           VectorSet<ScalarT,3> &points,
+                           VectorSet<float,3> *colors,
+                           bool keep_invalid) const
+        {
+            // Local copy, so that its parameters are not reloaded on every (possibly aliasing) output store
+            const DepthConverterT depth_converter(depth_converter_in);
+            const float color_mult = 1.0f/255.0f;
+            const ScalarT * const ray_x = ray_x_.data();
+            Eigen::Matrix<ScalarT,3,3> rot(Eigen::Matrix<ScalarT,3,3>::Identity());
+            Vector<ScalarT,3> t(Vector<ScalarT,3>::Zero());
+            if (WithExtrinsics) {
+                rot = extrinsics->linear();
+                t = extrinsics->translation();
+            }
+
+            // Valid pixel counts per row, turned into output offsets
+            std::vector<size_t> row_start(image_h_ + 1);
+            row_start[0] = 0;
+            if (keep_invalid) {
+                for (size_t y = 0; y < image_h_; y++) row_start[y + 1] = row_start[y] + image_w_;
+            } else {
+                // Converting into a buffer first keeps both loops vectorizable (converters may branch)
+#pragma omp parallel
+                {
+                    std::vector<ScalarT> depth_row(image_w_);
+#pragma omp for
+                    for (size_t y = 0; y < image_h_; y++) {
+                        const typename DepthConverterT::RawDepth * const row = depth_data + y*image_w_;
+                        for (size_t x = 0; x < image_w_; x++) depth_row[x] = depth_converter.getMetricValue(row[x]);
+                        size_t count = 0;
+                        for (size_t x = 0; x < image_w_; x++) count += depth_row[x] > (ScalarT)0.0;
+                        row_start[y + 1] = count;
+                    }
+                }
+                for (size_t y = 0; y < image_h_; y++) row_start[y + 1] += row_start[y];
+            }
+
+            points.resize(3, row_start[image_h_]);
+            if (WithColors) colors->resize(3, row_start[image_h_]);
+
+#pragma omp parallel
+            {
+                std::vector<ScalarT> depth_row(image_w_);
+                std::vector<ScalarT> point_row(keep_invalid ? 0 : 3*(image_w_ + 1));
+                std::vector<size_t> index_row((WithColors && !keep_invalid) ? image_w_ + 1 : 0);
+#pragma omp for
+                for (size_t y = 0; y < image_h_; y++) {
+                    const typename DepthConverterT::RawDepth * const row = depth_data + y*image_w_;
+                    for (size_t x = 0; x < image_w_; x++) depth_row[x] = depth_converter.getMetricValue(row[x]);
+
+                    // Pixel ray (rx, ry, 1) mapped to the output frame: rx*rot.col(0) + ry*rot.col(1) + rot.col(2)
+                    const Vector<ScalarT,3> row_ray = ray_y_[y]*rot.col(1) + rot.col(2);
+                    ScalarT * const out = points.data() + 3*row_start[y];
+                    float * const out_colors = WithColors ? colors->data() + 3*row_start[y] : nullptr;
+                    const unsigned char * const rgb_row = WithColors ? rgb_data + 3*y*image_w_ : nullptr;
+
+                    if (keep_invalid) {
+                        for (size_t x = 0; x < image_w_; x++) {
+                            const ScalarT z = depth_row[x];
+                            out[3*x] = z*(ray_x[x]*rot(0,0) + row_ray[0]) + t[0];
+                            out[3*x + 1] = z*(ray_x[x]*rot(1,0) + row_ray[1]) + t[1];
+                            out[3*x + 2] = z*(ray_x[x]*rot(2,0) + row_ray[2]) + t[2];
+                        }
+                        if (WithColors) {
+                            for (size_t i = 0; i < 3*image_w_; i++) out_colors[i] = color_mult*static_cast<float>(rgb_row[i]);
+                        }
+                    } else {
+                        // Branchless compaction into a row buffer (with room for the trailing discarded write)
+                        size_t k = 0;
+                        for (size_t x = 0; x < image_w_; x++) {
+                            const ScalarT z = depth_row[x];
+                            point_row[3*k] = z*(ray_x[x]*rot(0,0) + row_ray[0]) + t[0];
+                            point_row[3*k + 1] = z*(ray_x[x]*rot(1,0) + row_ray[1]) + t[1];
+                            point_row[3*k + 2] = z*(ray_x[x]*rot(2,0) + row_ray[2]) + t[2];
+                            if (WithColors) index_row[k] = x;
+                            k += z > (ScalarT)0.0;
+                        }
+                        std::copy(point_row.begin(), point_row.begin() + 3*k, out);
+                        if (WithColors) {
+                            for (size_t i = 0; i < k; i++) {
+                                out_colors[3*i] = color_mult*static_cast<float>(rgb_row[3*index_row[i]]);
+                                out_colors[3*i + 1] = color_mult*static_cast<float>(rgb_row[3*index_row[i] + 1]);
+                                out_colors[3*i + 2] = color_mult*static_cast<float>(rgb_row[3*index_row[i] + 2]);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    };
+
     template <class DepthConverterT>
     void depthImageToPoints(const typename DepthConverterT::RawDepth* depth_data,
                             const DepthConverterT &depth_converter,
@@ -61,42 +257,7 @@ namespace cilantro {
                             VectorSet<typename DepthConverterT::MetricDepth,3> &points,
                             bool keep_invalid = false)
     {
-        if (keep_invalid) {
-            points.resize(3, image_w*image_h);
-            size_t k;
-#pragma omp parallel for private (k)
-            for (size_t y = 0; y < image_h; y++) {
-                k = y*image_w;
-                for (size_t x = 0; x < image_w; x++) {
-                    typename DepthConverterT::MetricDepth z = depth_converter.getMetricValue(depth_data[k]);
-                    points(0,k) = (x - intrinsics(0,2))*z/intrinsics(0,0);
-                    points(1,k) = (y - intrinsics(1,2))*z/intrinsics(1,1);
-                    points(2,k) = z;
-                    k++;
-                }
-            }
-        } else {
-            VectorSet<typename DepthConverterT::MetricDepth,3> points_tmp(3, image_w*image_h);
-            size_t k;
-            size_t valid_count = 0;
-#pragma omp parallel for private (k) reduction (+: valid_count)
-            for (size_t y = 0; y < image_h; y++) {
-                k = y*image_w;
-                for (size_t x = 0; x < image_w; x++) {
-                    typename DepthConverterT::MetricDepth z = depth_converter.getMetricValue(depth_data[k]);
-                    points_tmp(0,k) = (x - intrinsics(0,2))*z/intrinsics(0,0);
-                    points_tmp(1,k) = (y - intrinsics(1,2))*z/intrinsics(1,1);
-                    points_tmp(2,k) = z;
-                    k++;
-                    valid_count += z > (typename DepthConverterT::MetricDepth)0.0;
-                }
-            }
-            k = 0;
-            points.resize(3, valid_count);
-            for (size_t i = 0; i < points_tmp.cols(); i++) {
-                if (points_tmp(2,i) > (typename DepthConverterT::MetricDepth)0.0) points.col(k++) = points_tmp.col(i);
-            }
-        }
+        DepthImageBackProjector<typename DepthConverterT::MetricDepth>(image_w, image_h, intrinsics).depthImageToPoints(depth_data, depth_converter, points, keep_invalid);
     }
 
     template <class DepthConverterT>
@@ -108,43 +269,7 @@ namespace cilantro {
                             VectorSet<typename DepthConverterT::MetricDepth,3> &points,
                             bool keep_invalid = false)
     {
-        if (keep_invalid) {
-            points.resize(3, image_w*image_h);
-            size_t k;
-#pragma omp parallel for private (k)
-            for (size_t y = 0; y < image_h; y++) {
-                k = y*image_w;
-                for (size_t x = 0; x < image_w; x++) {
-                    typename DepthConverterT::MetricDepth z = depth_converter.getMetricValue(depth_data[k]);
-                    points.col(k++).noalias() = extrinsics*Vector<typename DepthConverterT::MetricDepth,3>((x - intrinsics(0,2))*z/intrinsics(0,0), (y - intrinsics(1,2))*z/intrinsics(1,1), z);
-                }
-            }
-        } else {
-            VectorSet<typename DepthConverterT::MetricDepth,3> points_tmp(3, image_w*image_h);
-            size_t k;
-            size_t valid_count = 0;
-#pragma omp parallel for private (k) reduction (+: valid_count)
-            for (size_t y = 0; y < image_h; y++) {
-                k = y*image_w;
-                for (size_t x = 0; x < image_w; x++) {
-                    typename DepthConverterT::MetricDepth z = depth_converter.getMetricValue(depth_data[k]);
-                    points_tmp(0,k) = (x - intrinsics(0,2))*z/intrinsics(0,0);
-                    points_tmp(1,k) = (y - intrinsics(1,2))*z/intrinsics(1,1);
-                    points_tmp(2,k) = z;
-                    k++;
-                    valid_count += z > (typename DepthConverterT::MetricDepth)0.0;
-                }
-            }
-            k = 0;
-            points.resize(3, valid_count);
-            for (size_t i = 0; i < points_tmp.cols(); i++) {
-                if (points_tmp(2,i) > (typename DepthConverterT::MetricDepth)0.0) points.col(k++) = points_tmp.col(i);
-            }
-#pragma omp parallel for
-            for (size_t i = 0; i < points.cols(); i++) {
-                points.col(i) = extrinsics*points.col(i);
-            }
-        }
+        DepthImageBackProjector<typename DepthConverterT::MetricDepth>(image_w, image_h, intrinsics).depthImageToPoints(depth_data, depth_converter, extrinsics, points, keep_invalid);
     }
 
     template <class DepthConverterT>
@@ -158,18 +283,7 @@ namespace cilantro {
     {
         if (keep_invalid) {
             size_t k;
-            points.resize(3, image_w*image_h);
-#pragma omp parallel for private (k)
-            for (size_t y = 0; y < image_h; y++) {
-                k = y*image_w;
-                for (size_t x = 0; x < image_w; x++) {
-                    typename DepthConverterT::MetricDepth z = depth_converter.getMetricValue(depth_data[k]);
-                    points(0,k) = (x - intrinsics(0,2))*z/intrinsics(0,0);
-                    points(1,k) = (y - intrinsics(1,2))*z/intrinsics(1,1);
-                    points(2,k) = z;
-                    k++;
-                }
-            }
+            DepthImageBackProjector<typename DepthConverterT::MetricDepth>(image_w, image_h, intrinsics).depthImageToPoints(depth_data, depth_converter, points, true);
             normals.setConstant(3, points.cols(), std::numeric_limits<typename DepthConverterT::MetricDepth>::quiet_NaN());
 #pragma omp parallel for private (k)
             for (size_t y = 1; y < image_h - 1; y++) {
@@ -188,17 +302,7 @@ namespace cilantro {
         } else {
             size_t k;
             VectorSet<typename DepthConverterT::MetricDepth,3> points_tmp(3, image_w*image_h);
-#pragma omp parallel for private (k)
-            for (size_t y = 0; y < image_h; y++) {
-                k = y*image_w;
-                for (size_t x = 0; x < image_w; x++) {
-                    typename DepthConverterT::MetricDepth z = depth_converter.getMetricValue(depth_data[k]);
-                    points_tmp(0,k) = (x - intrinsics(0,2))*z/intrinsics(0,0);
-                    points_tmp(1,k) = (y - intrinsics(1,2))*z/intrinsics(1,1);
-                    points_tmp(2,k) = z;
-                    k++;
-                }
-            }
+            DepthImageBackProjector<typename DepthConverterT::MetricDepth>(image_w, image_h, intrinsics).depthImageToPoints(depth_data, depth_converter, points_tmp, true);
             VectorSet<typename DepthConverterT::MetricDepth,3> normals_tmp(VectorSet<typename DepthConverterT::MetricDepth,3>::Constant(3, points_tmp.cols(), std::numeric_limits<typename DepthConverterT::MetricDepth>::quiet_NaN()));
             size_t valid_count = 0;
 #pragma omp parallel for private (k) reduction (+: valid_count)
@@ -241,18 +345,7 @@ namespace cilantro {
     {
         if (keep_invalid) {
             size_t k;
-            points.resize(3, image_w*image_h);
-#pragma omp parallel for private (k)
-            for (size_t y = 0; y < image_h; y++) {
-                k = y*image_w;
-                for (size_t x = 0; x < image_w; x++) {
-                    typename DepthConverterT::MetricDepth z = depth_converter.getMetricValue(depth_data[k]);
-                    points(0,k) = (x - intrinsics(0,2))*z/intrinsics(0,0);
-                    points(1,k) = (y - intrinsics(1,2))*z/intrinsics(1,1);
-                    points(2,k) = z;
-                    k++;
-                }
-            }
+            DepthImageBackProjector<typename DepthConverterT::MetricDepth>(image_w, image_h, intrinsics).depthImageToPoints(depth_data, depth_converter, points, true);
             normals.setConstant(3, points.cols(), std::numeric_limits<typename DepthConverterT::MetricDepth>::quiet_NaN());
 #pragma omp parallel for private (k)
             for (size_t y = 1; y < image_h - 1; y++) {
@@ -276,17 +369,7 @@ namespace cilantro {
         } else {
             size_t k;
             VectorSet<typename DepthConverterT::MetricDepth,3> points_tmp(3, image_w*image_h);
-#pragma omp parallel for private (k)
-            for (size_t y = 0; y < image_h; y++) {
-                k = y*image_w;
-                for (size_t x = 0; x < image_w; x++) {
-                    typename DepthConverterT::MetricDepth z = depth_converter.getMetricValue(depth_data[k]);
-                    points_tmp(0,k) = (x - intrinsics(0,2))*z/intrinsics(0,0);
-                    points_tmp(1,k) = (y - intrinsics(1,2))*z/intrinsics(1,1);
-                    points_tmp(2,k) = z;
-                    k++;
-                }
-            }
+            DepthImageBackProjector<typename DepthConverterT::MetricDepth>(image_w, image_h, intrinsics).depthImageToPoints(depth_data, depth_converter, points_tmp, true);
             VectorSet<typename DepthConverterT::MetricDepth,3> normals_tmp(VectorSet<typename DepthConverterT::MetricDepth,3>::Constant(3, points_tmp.cols(), std::numeric_limits<typename DepthConverterT::MetricDepth>::quiet_NaN()));
             size_t valid_count = 0;
 #pragma omp parallel for private (k) reduction (+: valid_count)
@@ -332,57 +415,7 @@ namespace cilantro {
                                   VectorSet<float,3> &colors,
                                   bool keep_invalid = false)
     {
-        const float color_mult = 1.0f/255.0f;
-
-        if (keep_invalid) {
-            points.resize(3, image_w*image_h);
-            colors.resize(3, image_w*image_h);
-            size_t k;
-#pragma omp parallel for private (k)
-            for (size_t y = 0; y < image_h; y++) {
-                k = y*image_w;
-                for (size_t x = 0; x < image_w; x++) {
-                    typename DepthConverterT::MetricDepth z = depth_converter.getMetricValue(depth_data[k]);
-                    points(0,k) = (x - intrinsics(0,2))*z/intrinsics(0,0);
-                    points(1,k) = (y - intrinsics(1,2))*z/intrinsics(1,1);
-                    points(2,k) = z;
-                    colors(0,k) = color_mult*static_cast<float>(rgb_data[3*k]);
-                    colors(1,k) = color_mult*static_cast<float>(rgb_data[3*k + 1]);
-                    colors(2,k) = color_mult*static_cast<float>(rgb_data[3*k + 2]);
-                    k++;
-                }
-            }
-        } else {
-            VectorSet<typename DepthConverterT::MetricDepth,3> points_tmp(3, image_w*image_h);
-            VectorSet<float,3> colors_tmp(3, image_w*image_h);
-            size_t k;
-            size_t valid_count = 0;
-#pragma omp parallel for private (k) reduction (+: valid_count)
-            for (size_t y = 0; y < image_h; y++) {
-                k = y*image_w;
-                for (size_t x = 0; x < image_w; x++) {
-                    typename DepthConverterT::MetricDepth z = depth_converter.getMetricValue(depth_data[k]);
-                    points_tmp(0,k) = (x - intrinsics(0,2))*z/intrinsics(0,0);
-                    points_tmp(1,k) = (y - intrinsics(1,2))*z/intrinsics(1,1);
-                    points_tmp(2,k) = z;
-                    colors_tmp(0,k) = color_mult*static_cast<float>(rgb_data[3*k]);
-                    colors_tmp(1,k) = color_mult*static_cast<float>(rgb_data[3*k + 1]);
-                    colors_tmp(2,k) = color_mult*static_cast<float>(rgb_data[3*k + 2]);
-                    k++;
-                    valid_count += z > (typename DepthConverterT::MetricDepth)0.0;
-                }
-            }
-            k = 0;
-            points.resize(3, valid_count);
-            colors.resize(3, valid_count);
-            for (size_t i = 0; i < points_tmp.cols(); i++) {
-                if (points_tmp(2,i) > (typename DepthConverterT::MetricDepth)0.0) {
-                    points.col(k) = points_tmp.col(i);
-                    colors.col(k) = colors_tmp.col(i);
-                    k++;
-                }
-            }
-        }
+        DepthImageBackProjector<typename DepthConverterT::MetricDepth>(image_w, image_h, intrinsics).RGBDImagesToPointsColors(rgb_data, depth_data, depth_converter, points, colors, keep_invalid);
     }
 
     template <class DepthConverterT>
@@ -396,59 +429,7 @@ namespace cilantro {
                                   VectorSet<float,3> &colors,
                                   bool keep_invalid = false)
     {
-        const float color_mult = 1.0f/255.0f;
-
-        if (keep_invalid) {
-            points.resize(3, image_w*image_h);
-            colors.resize(3, image_w*image_h);
-            size_t k;
-#pragma omp parallel for private (k)
-            for (size_t y = 0; y < image_h; y++) {
-                k = y*image_w;
-                for (size_t x = 0; x < image_w; x++) {
-                    typename DepthConverterT::MetricDepth z = depth_converter.getMetricValue(depth_data[k]);
-                    points.col(k).noalias() = extrinsics*Vector<typename DepthConverterT::MetricDepth,3>((x - intrinsics(0,2))*z/intrinsics(0,0), (y - intrinsics(1,2))*z/intrinsics(1,1), z);
-                    colors(0,k) = color_mult*static_cast<float>(rgb_data[3*k]);
-                    colors(1,k) = color_mult*static_cast<float>(rgb_data[3*k + 1]);
-                    colors(2,k) = color_mult*static_cast<float>(rgb_data[3*k + 2]);
-                    k++;
-                }
-            }
-        } else {
-            VectorSet<typename DepthConverterT::MetricDepth,3> points_tmp(3, image_w*image_h);
-            VectorSet<float,3> colors_tmp(3, image_w*image_h);
-            size_t k;
-            size_t valid_count = 0;
-#pragma omp parallel for private (k) reduction (+: valid_count)
-            for (size_t y = 0; y < image_h; y++) {
-                k = y*image_w;
-                for (size_t x = 0; x < image_w; x++) {
-                    typename DepthConverterT::MetricDepth z = depth_converter.getMetricValue(depth_data[k]);
-                    points_tmp(0,k) = (x - intrinsics(0,2))*z/intrinsics(0,0);
-                    points_tmp(1,k) = (y - intrinsics(1,2))*z/intrinsics(1,1);
-                    points_tmp(2,k) = z;
-                    colors_tmp(0,k) = color_mult*static_cast<float>(rgb_data[3*k]);
-                    colors_tmp(1,k) = color_mult*static_cast<float>(rgb_data[3*k + 1]);
-                    colors_tmp(2,k) = color_mult*static_cast<float>(rgb_data[3*k + 2]);
-                    k++;
-                    valid_count += z > (typename DepthConverterT::MetricDepth)0.0;
-                }
-            }
-            k = 0;
-            points.resize(3, valid_count);
-            colors.resize(3, valid_count);
-            for (size_t i = 0; i < points_tmp.cols(); i++) {
-                if (points_tmp(2,i) > (typename DepthConverterT::MetricDepth)0.0) {
-                    points.col(k) = points_tmp.col(i);
-                    colors.col(k) = colors_tmp.col(i);
-                    k++;
-                }
-            }
-#pragma omp parallel for
-            for (size_t i = 0; i < points.cols(); i++) {
-                points.col(i) = extrinsics*points.col(i);
-            }
-        }
+        DepthImageBackProjector<typename DepthConverterT::MetricDepth>(image_w, image_h, intrinsics).RGBDImagesToPointsColors(rgb_data, depth_data, depth_converter, extrinsics, points, colors, keep_invalid);
     }
 
     template <class DepthConverterT>
@@ -462,26 +443,9 @@ namespace cilantro {
                                          VectorSet<float,3> &colors,
                                          bool keep_invalid = false)
     {
-        const float color_mult = 1.0f/255.0f;
-
         if (keep_invalid) {
             size_t k;
-            points.resize(3, image_w*image_h);
-            colors.resize(3, points.cols());
-#pragma omp parallel for private (k)
-            for (size_t y = 0; y < image_h; y++) {
-                k = y*image_w;
-                for (size_t x = 0; x < image_w; x++) {
-                    typename DepthConverterT::MetricDepth z = depth_converter.getMetricValue(depth_data[k]);
-                    points(0,k) = (x - intrinsics(0,2))*z/intrinsics(0,0);
-                    points(1,k) = (y - intrinsics(1,2))*z/intrinsics(1,1);
-                    points(2,k) = z;
-                    colors(0,k) = color_mult*static_cast<float>(rgb_data[3*k]);
-                    colors(1,k) = color_mult*static_cast<float>(rgb_data[3*k + 1]);
-                    colors(2,k) = color_mult*static_cast<float>(rgb_data[3*k + 2]);
-                    k++;
-                }
-            }
+            DepthImageBackProjector<typename DepthConverterT::MetricDepth>(image_w, image_h, intrinsics).RGBDImagesToPointsColors(rgb_data, depth_data, depth_converter, points, colors, true);
             normals.setConstant(3, points.cols(), std::numeric_limits<typename DepthConverterT::MetricDepth>::quiet_NaN());
 #pragma omp parallel for private (k)
             for (size_t y = 1; y < image_h - 1; y++) {
@@ -500,21 +464,8 @@ namespace cilantro {
         } else {
             size_t k;
             VectorSet<typename DepthConverterT::MetricDepth,3> points_tmp(3, image_w*image_h);
-            VectorSet<float,3> colors_tmp(3, points_tmp.cols());
-#pragma omp parallel for private (k)
-            for (size_t y = 0; y < image_h; y++) {
-                k = y*image_w;
-                for (size_t x = 0; x < image_w; x++) {
-                    typename DepthConverterT::MetricDepth z = depth_converter.getMetricValue(depth_data[k]);
-                    points_tmp(0,k) = (x - intrinsics(0,2))*z/intrinsics(0,0);
-                    points_tmp(1,k) = (y - intrinsics(1,2))*z/intrinsics(1,1);
-                    points_tmp(2,k) = z;
-                    colors_tmp(0,k) = color_mult*static_cast<float>(rgb_data[3*k]);
-                    colors_tmp(1,k) = color_mult*static_cast<float>(rgb_data[3*k + 1]);
-                    colors_tmp(2,k) = color_mult*static_cast<float>(rgb_data[3*k + 2]);
-                    k++;
-                }
-            }
+            VectorSet<float,3> colors_tmp(3, image_w*image_h);
+            DepthImageBackProjector<typename DepthConverterT::MetricDepth>(image_w, image_h, intrinsics).RGBDImagesToPointsColors(rgb_data, depth_data, depth_converter, points_tmp, colors_tmp, true);
             VectorSet<typename DepthConverterT::MetricDepth,3> normals_tmp(VectorSet<typename DepthConverterT::MetricDepth,3>::Constant(3, points_tmp.cols(), std::numeric_limits<typename DepthConverterT::MetricDepth>::quiet_NaN()));
             size_t valid_count = 0;
 #pragma omp parallel for private (k) reduction (+: valid_count)
@@ -559,26 +510,9 @@ namespace cilantro {
                                          VectorSet<float,3> &colors,
                                          bool keep_invalid = false)
     {
-        const float color_mult = 1.0f/255.0f;
-
         if (keep_invalid) {
             size_t k;
-            points.resize(3, image_w*image_h);
-            colors.resize(3, points.cols());
-#pragma omp parallel for private (k)
-            for (size_t y = 0; y < image_h; y++) {
-                k = y*image_w;
-                for (size_t x = 0; x < image_w; x++) {
-                    typename DepthConverterT::MetricDepth z = depth_converter.getMetricValue(depth_data[k]);
-                    points(0,k) = (x - intrinsics(0,2))*z/intrinsics(0,0);
-                    points(1,k) = (y - intrinsics(1,2))*z/intrinsics(1,1);
-                    points(2,k) = z;
-                    colors(0,k) = color_mult*static_cast<float>(rgb_data[3*k]);
-                    colors(1,k) = color_mult*static_cast<float>(rgb_data[3*k + 1]);
-                    colors(2,k) = color_mult*static_cast<float>(rgb_data[3*k + 2]);
-                    k++;
-                }
-            }
+            DepthImageBackProjector<typename DepthConverterT::MetricDepth>(image_w, image_h, intrinsics).RGBDImagesToPointsColors(rgb_data, depth_data, depth_converter, points, colors, true);
             normals.setConstant(3, points.cols(), std::numeric_limits<typename DepthConverterT::MetricDepth>::quiet_NaN());
 #pragma omp parallel for private (k)
             for (size_t y = 1; y < image_h - 1; y++) {
@@ -602,21 +536,8 @@ namespace cilantro {
         } else {
             size_t k;
             VectorSet<typename DepthConverterT::MetricDepth,3> points_tmp(3, image_w*image_h);
-            VectorSet<float,3> colors_tmp(3, points_tmp.cols());
-#pragma omp parallel for private (k)
-            for (size_t y = 0; y < image_h; y++) {
-                k = y*image_w;
-                for (size_t x = 0; x < image_w; x++) {
-                    typename DepthConverterT::MetricDepth z = depth_converter.getMetricValue(depth_data[k]);
-                    points_tmp(0,k) = (x - intrinsics(0,2))*z/intrinsics(0,0);
-                    points_tmp(1,k) = (y - intrinsics(1,2))*z/intrinsics(1,1);
-                    points_tmp(2,k) = z;
-                    colors_tmp(0,k) = color_mult*static_cast<float>(rgb_data[3*k]);
-                    colors_tmp(1,k) = color_mult*static_cast<float>(rgb_data[3*k + 1]);
-                    colors_tmp(2,k) = color_mult*static_cast<float>(rgb_data[3*k + 2]);
-                    k++;
-                }
-            }
+            VectorSet<float,3> colors_tmp(3, image_w*image_h);
+            DepthImageBackProjector<typename DepthConverterT::MetricDepth>(image_w, image_h, intrinsics).RGBDImagesToPointsColors(rgb_data, depth_data, depth_converter, points_tmp, colors_tmp, true);
             VectorSet<typename DepthConverterT::MetricDepth,3> normals_tmp(VectorSet<typename DepthConverterT::MetricDepth,3>::Constant(3, points_tmp.cols(), std::numeric_limits<typename DepthConverterT::MetricDepth>::quiet_NaN()));
             size_t valid_count = 0;
 #pragma omp parallel for private (k) reduction (+: valid_count)
@@ -654,29 +575,235 @@ namespace cilantro {
         }
     }
 
+    namespace internal {
+        // The atomic z-buffer only pays off with more than one thread
+        inline bool useSerialRendering() {
+#ifdef _OPENMP
+            return omp_get_max_threads() == 1;
+#else
+            return true;
+#endif
+        }
+
+        // Projects a camera frame point; false if it is behind the camera or its splat misses the image
+        template <typename ScalarT>
+        inline bool projectSplat(const Vector<ScalarT,3> &pt_cam,
+                                 const Eigen::Ref<const Eigen::Matrix<ScalarT,3,3>> &intrinsics,
+                                 ptrdiff_t w, ptrdiff_t h, ptrdiff_t r,
+                                 ptrdiff_t &x, ptrdiff_t &y)
+        {
+            if (!(pt_cam(2) > (ScalarT)0.0)) return false;
+            x = (ptrdiff_t)std::llround(pt_cam(0)*intrinsics(0,0)/pt_cam(2) + intrinsics(0,2));
+            y = (ptrdiff_t)std::llround(pt_cam(1)*intrinsics(1,1)/pt_cam(2) + intrinsics(1,2));
+            return !(x + r < 0 || x - r >= w || y + r < 0 || y - r >= h);
+        }
+
+        // Single-threaded splatting: calls splat(pixel, i, pt_cam) for every pixel covered by point i, with
+        // points visited in index order
+        template <typename ScalarT, class SplatT>
+        void splatPointsSerial(const ConstVectorSetMatrixMap<ScalarT,3> &points,
+                               const RigidTransform<ScalarT,3> *to_cam,
+                               const Eigen::Ref<const Eigen::Matrix<ScalarT,3,3>> &intrinsics,
+                               size_t image_w, size_t image_h,
+                               size_t splat_radius,
+                               const SplatT &splat)
+        {
+            const ptrdiff_t r = (ptrdiff_t)splat_radius, w = (ptrdiff_t)image_w, h = (ptrdiff_t)image_h;
+            const size_t num_points = points.cols();
+            Vector<ScalarT,3> pt_cam;
+            ptrdiff_t x, y;
+            for (size_t i = 0; i < num_points; i++) {
+                if (to_cam != NULL) {
+                    pt_cam.noalias() = (*to_cam)*points.col(i);
+                } else {
+                    pt_cam = points.col(i);
+                }
+                if (!projectSplat<ScalarT>(pt_cam, intrinsics, w, h, r, x, y)) continue;
+
+                if (r == 0) {
+                    splat(y*w + x, i, pt_cam);
+                    continue;
+                }
+                const ptrdiff_t x0 = std::max<ptrdiff_t>(x - r, 0), x1 = std::min(x + r, w - 1);
+                const ptrdiff_t y0 = std::max<ptrdiff_t>(y - r, 0), y1 = std::min(y + r, h - 1);
+                for (ptrdiff_t yy = y0; yy <= y1; yy++) {
+                    for (ptrdiff_t xx = x0; xx <= x1; xx++) {
+                        splat(yy*w + xx, i, pt_cam);
+                    }
+                }
+            }
+        }
+
+        // Nearest point per pixel for a pinhole camera (points given in world coordinates, with to_cam mapping
+        // them to the camera frame, or in the camera frame if to_cam is NULL); each point covers the
+        // (2*splat_radius + 1)^2 pixels around its projection. Depths are compared as floats and ties go to the
+        // lower point index, so that the result does not depend on thread scheduling. Empty pixels get
+        // std::numeric_limits<size_t>::max().
+        // With multiple threads, pixels keep the atomic minimum of a 64-bit key made of the float depth bits
+        // (which order like the values for positive depths) and the point index. This limits the number of
+        // points to 2^32, and double depths that only differ beyond float precision count as ties.
+        template <typename ScalarT>
+        void renderNearestPointIndices(const ConstVectorSetMatrixMap<ScalarT,3> &points,
+                                       const RigidTransform<ScalarT,3> *to_cam,
+                                       const Eigen::Ref<const Eigen::Matrix<ScalarT,3,3>> &intrinsics,
+                                       size_t image_w, size_t image_h,
+                                       size_t splat_radius,
+                                       size_t* index_map_data)
+        {
+            const size_t empty = std::numeric_limits<size_t>::max();
+            const size_t num_pixels = image_w*image_h;
+
+            if (useSerialRendering()) {
+                // Only strictly nearer points win, so depth ties go to the lower index as below; NaN marks
+                // empty pixels, since !(depth >= NaN) holds for any depth
+                std::vector<float> z_buffer(num_pixels, std::numeric_limits<float>::quiet_NaN());
+                std::fill(index_map_data, index_map_data + num_pixels, empty);
+                splatPointsSerial<ScalarT>(points, to_cam, intrinsics, image_w, image_h, splat_radius,
+                                           [&z_buffer,index_map_data](size_t pixel, size_t i, const Vector<ScalarT,3> &pt_cam) {
+                    const float depth = static_cast<float>(pt_cam(2));
+                    if (depth >= z_buffer[pixel]) return;
+                    z_buffer[pixel] = depth;
+                    index_map_data[pixel] = i;
+                });
+                return;
+            }
+
+            const size_t num_points = points.cols();
+            eigen_assert(num_points <= ((uint64_t)1 << 32) && "renderNearestPointIndices(): point indices must fit in 32 bits");
+
+            const uint64_t empty_key = std::numeric_limits<uint64_t>::max();
+            std::vector<std::atomic<uint64_t>> z_buffer(num_pixels);
+#pragma omp parallel for
+            for (size_t i = 0; i < num_pixels; i++) {
+                z_buffer[i].store(empty_key, std::memory_order_relaxed);
+            }
+
+            const ptrdiff_t r = (ptrdiff_t)splat_radius, w = (ptrdiff_t)image_w, h = (ptrdiff_t)image_h;
+            Vector<ScalarT,3> pt_cam;
+            ptrdiff_t x, y;
+#pragma omp parallel for private (pt_cam, x, y)
+            for (size_t i = 0; i < num_points; i++) {
+                if (to_cam != NULL) {
+                    pt_cam.noalias() = (*to_cam)*points.col(i);
+                } else {
+                    pt_cam = points.col(i);
+                }
+                if (!projectSplat<ScalarT>(pt_cam, intrinsics, w, h, r, x, y)) continue;
+
+                const float depth = static_cast<float>(pt_cam(2));
+                uint32_t depth_bits;
+                std::memcpy(&depth_bits, &depth, sizeof(float));
+                const uint64_t key = (uint64_t(depth_bits) << 32) | uint64_t(i & 0xFFFFFFFF);
+
+                if (r == 0) {
+                    std::atomic<uint64_t> &pixel = z_buffer[y*w + x];
+                    uint64_t curr = pixel.load(std::memory_order_relaxed);
+                    while (key < curr && !pixel.compare_exchange_weak(curr, key, std::memory_order_relaxed));
+                    continue;
+                }
+                const ptrdiff_t x0 = std::max<ptrdiff_t>(x - r, 0), x1 = std::min(x + r, w - 1);
+                const ptrdiff_t y0 = std::max<ptrdiff_t>(y - r, 0), y1 = std::min(y + r, h - 1);
+                for (ptrdiff_t yy = y0; yy <= y1; yy++) {
+                    for (ptrdiff_t xx = x0; xx <= x1; xx++) {
+                        std::atomic<uint64_t> &pixel = z_buffer[yy*w + xx];
+                        uint64_t curr = pixel.load(std::memory_order_relaxed);
+                        while (key < curr && !pixel.compare_exchange_weak(curr, key, std::memory_order_relaxed));
+                    }
+                }
+            }
+
+#pragma omp parallel for
+            for (size_t i = 0; i < num_pixels; i++) {
+                const uint64_t key = z_buffer[i].load(std::memory_order_relaxed);
+                index_map_data[i] = (key == empty_key) ? empty : (size_t)(key & 0xFFFFFFFF);
+            }
+        }
+
+        template <class DepthConverterT>
+        void renderPointsColors(const ConstVectorSetMatrixMap<typename DepthConverterT::MetricDepth,3> &points,
+                                const ConstVectorSetMatrixMap<float,3> *colors,
+                                const RigidTransform<typename DepthConverterT::MetricDepth,3> *extrinsics,
+                                const Eigen::Ref<const Eigen::Matrix<typename DepthConverterT::MetricDepth,3,3>> &intrinsics,
+                                const DepthConverterT &depth_converter,
+                                unsigned char* rgb_data,
+                                typename DepthConverterT::RawDepth* depth_data,
+                                size_t image_w, size_t image_h,
+                                size_t splat_radius)
+        {
+            typedef typename DepthConverterT::MetricDepth ScalarT;
+
+            RigidTransform<ScalarT,3> to_cam;
+            if (extrinsics != NULL) to_cam = extrinsics->inverse();
+
+            // Single thread: write the outputs directly while splatting
+            if (useSerialRendering()) {
+                typedef typename DepthConverterT::RawDepth RawDepthT;
+                const size_t num_pixels = image_w*image_h;
+                const RigidTransform<ScalarT,3> *to_cam_ptr = (extrinsics != NULL) ? &to_cam : NULL;
+                std::fill(depth_data, depth_data + num_pixels, (RawDepthT)0);
+                if (colors == NULL) {
+                    // Depth only: keep the smallest raw value in place; for monotonic depth converters this is
+                    // the depth of the nearest point as picked below (up to float rounding of double depths)
+                    splatPointsSerial<ScalarT>(points, to_cam_ptr, intrinsics, image_w, image_h, splat_radius,
+                                               [&](size_t pixel, size_t, const Vector<ScalarT,3> &pt_cam) {
+                        const RawDepthT raw = depth_converter.getRawValue(pt_cam(2));
+                        if (depth_data[pixel] == (RawDepthT)0 || raw < depth_data[pixel]) depth_data[pixel] = raw;
+                    });
+                    return;
+                }
+                std::fill(rgb_data, rgb_data + 3*num_pixels, (unsigned char)0);
+                std::vector<float> z_buffer(num_pixels, std::numeric_limits<float>::quiet_NaN());
+                splatPointsSerial<ScalarT>(points, to_cam_ptr, intrinsics, image_w, image_h, splat_radius,
+                                           [&](size_t pixel, size_t i, const Vector<ScalarT,3> &pt_cam) {
+                    const float depth = static_cast<float>(pt_cam(2));
+                    if (depth >= z_buffer[pixel]) return;
+                    z_buffer[pixel] = depth;
+                    depth_data[pixel] = depth_converter.getRawValue(pt_cam(2));
+                    rgb_data[3*pixel] = static_cast<unsigned char>(255.0f*(*colors)(0,i));
+                    rgb_data[3*pixel + 1] = static_cast<unsigned char>(255.0f*(*colors)(1,i));
+                    rgb_data[3*pixel + 2] = static_cast<unsigned char>(255.0f*(*colors)(2,i));
+                });
+                return;
+            }
+
+            std::vector<size_t> index_map(image_w*image_h);
+            renderNearestPointIndices<ScalarT>(points, (extrinsics != NULL) ? &to_cam : NULL, intrinsics, image_w, image_h, splat_radius, index_map.data());
+
+            const size_t empty = std::numeric_limits<size_t>::max();
+#pragma omp parallel for
+            for (size_t i = 0; i < index_map.size(); i++) {
+                const size_t ind = index_map[i];
+                if (ind == empty) {
+                    depth_data[i] = (typename DepthConverterT::RawDepth)0;
+                    if (colors != NULL) {
+                        rgb_data[3*i] = (unsigned char)0;
+                        rgb_data[3*i + 1] = (unsigned char)0;
+                        rgb_data[3*i + 2] = (unsigned char)0;
+                    }
+                    continue;
+                }
+                const ScalarT depth = (extrinsics != NULL) ? (to_cam*points.col(ind))(2) : points(2,ind);
+                depth_data[i] = depth_converter.getRawValue(depth);
+                if (colors != NULL) {
+                    rgb_data[3*i] = static_cast<unsigned char>(255.0f*(*colors)(0,ind));
+                    rgb_data[3*i + 1] = static_cast<unsigned char>(255.0f*(*colors)(1,ind));
+                    rgb_data[3*i + 2] = static_cast<unsigned char>(255.0f*(*colors)(2,ind));
+                }
+            }
+        }
+    }
+
+    // Renders the nearest point per pixel; each point covers the (2*splat_radius + 1)^2 pixels around its
+    // projection. Results are deterministic (depth ties go to the lower point index).
     template <class DepthConverterT>
     void pointsToDepthImage(const ConstVectorSetMatrixMap<typename DepthConverterT::MetricDepth,3> &points,
                             const Eigen::Ref<const Eigen::Matrix<typename DepthConverterT::MetricDepth,3,3>> &intrinsics,
                             const DepthConverterT &depth_converter,
                             typename DepthConverterT::RawDepth* depth_data,
-                            size_t image_w, size_t image_h)
+                            size_t image_w, size_t image_h,
+                            size_t splat_radius = 0)
     {
-#pragma omp parallel for
-        for (size_t i = 0; i < image_w*image_h; i++) {
-            depth_data[i] = (typename DepthConverterT::RawDepth)0;
-        }
-#pragma omp parallel for
-        for (size_t i = 0; i < points.cols(); i++) {
-            if (points(2,i) <= (typename DepthConverterT::MetricDepth)0.0) continue;
-            size_t x = (size_t)std::llround(points(0,i)*intrinsics(0,0)/points(2,i) + intrinsics(0,2));
-            size_t y = (size_t)std::llround(points(1,i)*intrinsics(1,1)/points(2,i) + intrinsics(1,2));
-            if (x >= image_w || y >= image_h) continue;
-            size_t ind = y*image_w + x;
-            typename DepthConverterT::RawDepth depth_val = depth_converter.getRawValue(points(2,i));
-            if (depth_data[ind] == (typename DepthConverterT::RawDepth)0 || depth_val < depth_data[ind]) {
-                depth_data[ind] = depth_val;
-            }
-        }
+        internal::renderPointsColors<DepthConverterT>(points, NULL, NULL, intrinsics, depth_converter, NULL, depth_data, image_w, image_h, splat_radius);
     }
 
     template <class DepthConverterT>
@@ -685,29 +812,10 @@ namespace cilantro {
                             const Eigen::Ref<const Eigen::Matrix<typename DepthConverterT::MetricDepth,3,3>> &intrinsics,
                             const DepthConverterT &depth_converter,
                             typename DepthConverterT::RawDepth* depth_data,
-                            size_t image_w, size_t image_h)
+                            size_t image_w, size_t image_h,
+                            size_t splat_radius = 0)
     {
-        const RigidTransform<typename DepthConverterT::MetricDepth,3> to_cam(extrinsics.inverse());
-
-#pragma omp parallel for
-        for (size_t i = 0; i < image_w*image_h; i++) {
-            depth_data[i] = (typename DepthConverterT::RawDepth)0;
-        }
-
-        Vector<typename DepthConverterT::MetricDepth,3> pt_cam;
-#pragma omp parallel for private (pt_cam)
-        for (size_t i = 0; i < points.cols(); i++) {
-            pt_cam.noalias() = to_cam*points.col(i);
-            if (pt_cam(2) <= (typename DepthConverterT::MetricDepth)0.0) continue;
-            size_t x = (size_t)std::llround(pt_cam(0)*intrinsics(0,0)/pt_cam(2) + intrinsics(0,2));
-            size_t y = (size_t)std::llround(pt_cam(1)*intrinsics(1,1)/pt_cam(2) + intrinsics(1,2));
-            if (x >= image_w || y >= image_h) continue;
-            size_t ind = y*image_w + x;
-            typename DepthConverterT::RawDepth depth_val = depth_converter.getRawValue(pt_cam(2));
-            if (depth_data[ind] == (typename DepthConverterT::RawDepth)0 || depth_val < depth_data[ind]) {
-                depth_data[ind] = depth_val;
-            }
-        }
+        internal::renderPointsColors<DepthConverterT>(points, NULL, &extrinsics, intrinsics, depth_converter, NULL, depth_data, image_w, image_h, splat_radius);
     }
 
     template <class DepthConverterT>
@@ -717,30 +825,10 @@ namespace cilantro {
                                   const DepthConverterT &depth_converter,
                                   unsigned char* rgb_data,
                                   typename DepthConverterT::RawDepth* depth_data,
-                                  size_t image_w, size_t image_h)
+                                  size_t image_w, size_t image_h,
+                                  size_t splat_radius = 0)
     {
-#pragma omp parallel for
-        for (size_t i = 0; i < image_w*image_h; i++) {
-            rgb_data[3*i] = (unsigned char)0;
-            rgb_data[3*i + 1] = (unsigned char)0;
-            rgb_data[3*i + 2] = (unsigned char)0;
-            depth_data[i] = (typename DepthConverterT::RawDepth)0;
-        }
-#pragma omp parallel for
-        for (size_t i = 0; i < points.cols(); i++) {
-            if (points(2,i) <= (typename DepthConverterT::MetricDepth)0.0) continue;
-            size_t x = (size_t)std::llround(points(0,i)*intrinsics(0,0)/points(2,i) + intrinsics(0,2));
-            size_t y = (size_t)std::llround(points(1,i)*intrinsics(1,1)/points(2,i) + intrinsics(1,2));
-            if (x >= image_w || y >= image_h) continue;
-            size_t ind = y*image_w + x;
-            typename DepthConverterT::RawDepth depth_val = depth_converter.getRawValue(points(2,i));
-            if (depth_data[ind] == (typename DepthConverterT::RawDepth)0 || depth_val < depth_data[ind]) {
-                rgb_data[3*ind] = static_cast<unsigned char>(255.0f*colors(0,i));
-                rgb_data[3*ind + 1] = static_cast<unsigned char>(255.0f*colors(1,i));
-                rgb_data[3*ind + 2] = static_cast<unsigned char>(255.0f*colors(2,i));
-                depth_data[ind] = depth_val;
-            }
-        }
+        internal::renderPointsColors<DepthConverterT>(points, &colors, NULL, intrinsics, depth_converter, rgb_data, depth_data, image_w, image_h, splat_radius);
     }
 
     template <class DepthConverterT>
@@ -751,60 +839,20 @@ namespace cilantro {
                                   const DepthConverterT &depth_converter,
                                   unsigned char* rgb_data,
                                   typename DepthConverterT::RawDepth* depth_data,
-                                  size_t image_w, size_t image_h)
+                                  size_t image_w, size_t image_h,
+                                  size_t splat_radius = 0)
     {
-        const RigidTransform<typename DepthConverterT::MetricDepth,3> to_cam(extrinsics.inverse());
-
-#pragma omp parallel for
-        for (size_t i = 0; i < image_w*image_h; i++) {
-            rgb_data[3*i] = (unsigned char)0;
-            rgb_data[3*i + 1] = (unsigned char)0;
-            rgb_data[3*i + 2] = (unsigned char)0;
-            depth_data[i] = (typename DepthConverterT::RawDepth)0;
-        }
-
-        Vector<typename DepthConverterT::MetricDepth,3> pt_cam;
-#pragma omp parallel for private (pt_cam)
-        for (size_t i = 0; i < points.cols(); i++) {
-            pt_cam.noalias() = to_cam*points.col(i);
-            if (pt_cam(2) <= (typename DepthConverterT::MetricDepth)0.0) continue;
-            size_t x = (size_t)std::llround(pt_cam(0)*intrinsics(0,0)/pt_cam(2) + intrinsics(0,2));
-            size_t y = (size_t)std::llround(pt_cam(1)*intrinsics(1,1)/pt_cam(2) + intrinsics(1,2));
-            if (x >= image_w || y >= image_h) continue;
-            size_t ind = y*image_w + x;
-            typename DepthConverterT::RawDepth depth_val = depth_converter.getRawValue(pt_cam(2));
-            if (depth_data[ind] == (typename DepthConverterT::RawDepth)0 || depth_val < depth_data[ind]) {
-                rgb_data[3*ind] = static_cast<unsigned char>(255.0f*colors(0,i));
-                rgb_data[3*ind + 1] = static_cast<unsigned char>(255.0f*colors(1,i));
-                rgb_data[3*ind + 2] = static_cast<unsigned char>(255.0f*colors(2,i));
-                depth_data[ind] = depth_val;
-            }
-        }
+        internal::renderPointsColors<DepthConverterT>(points, &colors, &extrinsics, intrinsics, depth_converter, rgb_data, depth_data, image_w, image_h, splat_radius);
     }
 
     template <typename PointT>
     void pointsToIndexMap(const ConstVectorSetMatrixMap<PointT,3> &points,
                           const Eigen::Ref<const Eigen::Matrix<PointT,3,3>> &intrinsics,
                           size_t* index_map_data,
-                          size_t image_w, size_t image_h)
+                          size_t image_w, size_t image_h,
+                          size_t splat_radius = 0)
     {
-        const size_t empty = std::numeric_limits<size_t>::max();
-
-#pragma omp parallel for
-        for (size_t i = 0; i < image_w*image_h; i++) {
-            index_map_data[i] = empty;
-        }
-#pragma omp parallel for
-        for (size_t i = 0; i < points.cols(); i++) {
-            if (points(2,i) <= (PointT)0.0) continue;
-            size_t x = (size_t)std::llround(points(0,i)*intrinsics(0,0)/points(2,i) + intrinsics(0,2));
-            size_t y = (size_t)std::llround(points(1,i)*intrinsics(1,1)/points(2,i) + intrinsics(1,2));
-            if (x >= image_w || y >= image_h) continue;
-            size_t ind = y*image_w + x;
-            if (index_map_data[ind] == empty || points(2,i) < points(2,index_map_data[ind])) {
-                index_map_data[ind] = i;
-            }
-        }
+        internal::renderNearestPointIndices<PointT>(points, NULL, intrinsics, image_w, image_h, splat_radius, index_map_data);
     }
 
     template <typename PointT>
@@ -812,32 +860,10 @@ namespace cilantro {
                           const RigidTransform<PointT,3> &extrinsics,
                           const Eigen::Ref<const Eigen::Matrix<PointT,3,3>> &intrinsics,
                           size_t* index_map_data,
-                          size_t image_w, size_t image_h)
+                          size_t image_w, size_t image_h,
+                          size_t splat_radius = 0)
     {
         const RigidTransform<PointT,3> to_cam(extrinsics.inverse());
-        const size_t empty = std::numeric_limits<size_t>::max();
-
-#pragma omp parallel for
-        for (size_t i = 0; i < image_w*image_h; i++) {
-            index_map_data[i] = empty;
-        }
-
-        VectorSet<PointT,3> points_cam(3, points.cols());
-#pragma omp parallel for
-        for (size_t i = 0; i < points.cols(); i++) {
-            points_cam.col(i).noalias() = to_cam*points.col(i);
-        }
-
-#pragma omp parallel for
-        for (size_t i = 0; i < points.cols(); i++) {
-            if (points_cam(2,i) <= (PointT)0.0) continue;
-            size_t x = (size_t)std::llround(points_cam(0,i)*intrinsics(0,0)/points_cam(2,i) + intrinsics(0,2));
-            size_t y = (size_t)std::llround(points_cam(1,i)*intrinsics(1,1)/points_cam(2,i) + intrinsics(1,2));
-            if (x >= image_w || y >= image_h) continue;
-            size_t ind = y*image_w + x;
-            if (index_map_data[ind] == empty || points_cam(2,i) < points_cam(2,index_map_data[ind])) {
-                index_map_data[ind] = i;
-            }
-        }
+        internal::renderNearestPointIndices<PointT>(points, &to_cam, intrinsics, image_w, image_h, splat_radius, index_map_data);
     }
 }
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <cilantro/data_containers.hpp>
+#include <cilantro/symmetric_eigen_decomposition.hpp>
+
+namespace cilantro {
+    // Covariance based normal estimation for organized (depth image) point clouds. Integral images of the
+    // valid pixel count, the point coordinates and their outer products (in double precision) give the
+    // moments of any axis aligned pixel window in O(1), so that the cost per pixel does not depend on the
+    // window size. Around depth discontinuities, a pixel's window is shrunk until it contains no pixel on a
+    // discontinuity, so that surfaces at different depths are not blended; pixels on or next to a discontinuity
+    // (whose window would shrink below radius 1) get no normal.
+    template <typename ScalarT>
+    class IntegralImageNormalEstimation {
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        typedef ScalarT Scalar;
+
+        // Points are stored in row major pixel order (image_w*image_h of them, in the camera frame), as
+        // produced by depthImageToPoints with keep_invalid set; pixels with non-positive depth are invalid
+        IntegralImageNormalEstimation(const ConstVectorSetMatrixMap<ScalarT,3> &points, size_t image_w, size_t image_h)
+                : points_(points),
+                  image_w_(image_w),
+                  image_h_(image_h),
+                  view_point_(Vector<ScalarT,3>::Zero())
+        {
+            build_integral_image_();
+        }
+
+        inline size_t getImageWidth() const { return image_w_; }
+
+        inline size_t getImageHeight() const { return image_h_; }
+
+        inline const Vector<ScalarT,3>& getViewPoint() const { return view_point_; }
+
+        inline IntegralImageNormalEstimation& setViewPoint(const Eigen::Ref<const Vector<ScalarT,3>> &vp) {
+            view_point_ = vp;
+            return *this;
+        }
+
+        // Normals over (2*window_radius + 1)^2 pixel windows (window_radius must be positive), shrunk near
+        // discontinuities; neighboring pixels whose depths differ by more than max_depth_change_factor times the
+        // smaller depth are on a discontinuity. Outputs are organized (one column per pixel), with NaN entries
+        // for invalid pixels, pixels on or next to a discontinuity and windows with fewer than 3 valid points.
+        inline const IntegralImageNormalEstimation& estimateNormalsAndCurvature(VectorSet<ScalarT,3> &normals,
+                                                                                VectorSet<ScalarT,1> &curvatures,
+                                                                                size_t window_radius,
+                                                                                ScalarT max_depth_change_factor = (ScalarT)0.02) const
+        {
+            compute_(normals, curvatures, window_radius, max_depth_change_factor);
+            return *this;
+        }
+
+        inline VectorSet<ScalarT,3> estimateNormals(size_t window_radius, ScalarT max_depth_change_factor = (ScalarT)0.02) const {
+            VectorSet<ScalarT,3> normals;
+            VectorSet<ScalarT,1> curvatures;
+            compute_(normals, curvatures, window_radius, max_depth_change_factor);
+            return normals;
+        }
+
+        inline VectorSet<ScalarT,1> estimateCurvature(size_t window_radius, ScalarT max_depth_change_factor = (ScalarT)0.02) const {
+            VectorSet<ScalarT,3> normals;
+            VectorSet<ScalarT,1> curvatures;
+            compute_(normals, curvatures, window_radius, max_depth_change_factor);
+            return curvatures;
+        }
+
+    private:
+        // Count, sum (x, y, z) and sum of outer products (xx, xy, xz, yy, yz, zz)
+        typedef Eigen::Matrix<double,10,1> Moments_;
+
+        ConstVectorSetMatrixMap<ScalarT,3> points_;
+        size_t image_w_;
+        size_t image_h_;
+        Vector<ScalarT,3> view_point_;
+
+        // (image_w + 1)*(image_h + 1) entries, with a leading row and column of zeros
+        Eigen::Matrix<double,10,Eigen::Dynamic> integral_;
+
+        inline bool is_valid_(size_t k) const { return points_(2,k) > (ScalarT)0.0; }
+
+        void build_integral_image_() {
+            const size_t stride = image_w_ + 1;
+            integral_.resize(10, stride*(image_h_ + 1));
+            integral_.leftCols(stride).setZero();
+
+            // Row prefix sums, then column prefix sums over blocks of contiguous columns
+#pragma omp parallel for
+            for (size_t y = 0; y < image_h_; y++) {
+                Moments_ acc(Moments_::Zero());
+                integral_.col((y + 1)*stride).setZero();
+                for (size_t x = 0; x < image_w_; x++) {
+                    const size_t k = y*image_w_ + x;
+                    if (is_valid_(k)) {
+                        const Eigen::Vector3d p = points_.col(k).template cast<double>();
+                        acc[0] += 1.0;
+                        acc.template segment<3>(1) += p;
+                        acc[4] += p[0]*p[0]; acc[5] += p[0]*p[1]; acc[6] += p[0]*p[2];
+                        acc[7] += p[1]*p[1]; acc[8] += p[1]*p[2]; acc[9] += p[2]*p[2];
+                    }
+                    integral_.col((y + 1)*stride + x + 1) = acc;
+                }
+            }
+
+            const size_t block_size = 64;
+#pragma omp parallel for
+            for (size_t x0 = 1; x0 < stride; x0 += block_size) {
+                const size_t x1 = std::min(x0 + block_size, stride);
+                for (size_t y = 2; y <= image_h_; y++) {
+                    integral_.middleCols(y*stride + x0, x1 - x0) += integral_.middleCols((y - 1)*stride + x0, x1 - x0);
+                }
+            }
+        }
+
+        // Chebyshev distance (capped at max_dist) of each pixel to the nearest pixel on a depth discontinuity,
+        // as a row distance transform followed by a windowed column pass
+        void compute_discontinuity_distances_(std::vector<int> &dist, int max_dist, ScalarT max_depth_change_factor) const {
+            const size_t num_pixels = image_w_*image_h_;
+            std::vector<unsigned char> edge(num_pixels);
+#pragma omp parallel for
+            for (size_t y = 0; y < image_h_; y++) {
+                for (size_t x = 0; x < image_w_; x++) {
+                    const size_t k = y*image_w_ + x;
+                    edge[k] = 0;
+                    if (!is_valid_(k)) continue;
+                    const ScalarT z = points_(2,k);
+                    const size_t nbrs[4] = {(x > 0) ? k - 1 : k, (x + 1 < image_w_) ? k + 1 : k,
+                                            (y > 0) ? k - image_w_ : k, (y + 1 < image_h_) ? k + image_w_ : k};
+                    for (size_t n = 0; n < 4; n++) {
+                        const ScalarT zn = points_(2,nbrs[n]);
+                        if (zn > (ScalarT)0.0 && std::abs(zn - z) > max_depth_change_factor*std::min(z, zn)) {
+                            edge[k] = 1;
+                            break;
+                        }
+                    }
+                }
+            }
+
+            std::vector<int> row_dist(num_pixels);
+#pragma omp parallel for
+            for (size_t y = 0; y < image_h_; y++) {
+                int* const r = row_dist.data() + y*image_w_;
+                const unsigned char* const e = edge.data() + y*image_w_;
+                int d = max_dist;
+                for (size_t x = 0; x < image_w_; x++) {
+                    d = e[x] ? 0 : std::min(d + 1, max_dist);
+                    r[x] = d;
+                }
+                d = max_dist;
+                for (size_t x = image_w_; x-- > 0;) {
+                    d = e[x] ? 0 : std::min(d + 1, max_dist);
+                    r[x] = std::min(r[x], d);
+                }
+            }
+
+            dist.resize(num_pixels);
+#pragma omp parallel for
+            for (size_t y = 0; y < image_h_; y++) {
+                int* const d = dist.data() + y*image_w_;
+                std::copy(row_dist.begin() + y*image_w_, row_dist.begin() + (y + 1)*image_w_, d);
+                for (int t = 1; t < max_dist; t++) {
+                    if (y >= (size_t)t) {
+                        const int* const r = row_dist.data() + (y - t)*image_w_;
+                        for (size_t x = 0; x < image_w_; x++) d[x] = std::min(d[x], std::max(t, r[x]));
+                    }
+                    if (y + t < image_h_) {
+                        const int* const r = row_dist.data() + (y + t)*image_w_;
+                        for (size_t x = 0; x < image_w_; x++) d[x] = std::min(d[x], std::max(t, r[x]));
+                    }
+                }
+            }
+        }
+
+        void compute_(VectorSet<ScalarT,3> &normals,
+                      VectorSet<ScalarT,1> &curvatures,
+                      size_t window_radius,
+                      ScalarT max_depth_change_factor) const
+        {
+            eigen_assert(window_radius > 0 && "IntegralImageNormalEstimation: window_radius must be positive");
+            const size_t stride = image_w_ + 1;
+            normals.resize(3, image_w_*image_h_);
+            curvatures.resize(1, image_w_*image_h_);
+
+            // A window of radius r around a pixel avoids all discontinuities iff r is below its distance to them
+            std::vector<int> dist;
+            compute_discontinuity_distances_(dist, (int)window_radius + 1, max_depth_change_factor);
+
+#pragma omp parallel for
+            for (size_t y = 0; y < image_h_; y++) {
+                for (size_t x = 0; x < image_w_; x++) {
+                    const size_t k = y*image_w_ + x;
+                    const int r = dist[k] - 1;
+                    if (!is_valid_(k) || r < 1) {
+                        normals.col(k).setConstant(std::numeric_limits<ScalarT>::quiet_NaN());
+                        curvatures[k] = std::numeric_limits<ScalarT>::quiet_NaN();
+                        continue;
+                    }
+
+                    const size_t x0 = (x >= (size_t)r) ? x - r : 0, x1 = std::min(x + r + 1, image_w_);
+                    const size_t y0 = (y >= (size_t)r) ? y - r : 0, y1 = std::min(y + r + 1, image_h_);
+                    const Moments_ m = integral_.col(y1*stride + x1) - integral_.col(y0*stride + x1) -
+                                       integral_.col(y1*stride + x0) + integral_.col(y0*stride + x0);
+                    if (m[0] < 3.0) {
+                        normals.col(k).setConstant(std::numeric_limits<ScalarT>::quiet_NaN());
+                        curvatures[k] = std::numeric_limits<ScalarT>::quiet_NaN();
+                        continue;
+                    }
+
+                    Eigen::Matrix3d outer;
+                    outer << m[4], m[5], m[6],
+                             m[5], m[7], m[8],
+                             m[6], m[8], m[9];
+                    const Eigen::Vector3d sum = m.template segment<3>(1);
+                    const Eigen::Matrix<ScalarT,3,3> cov = ((outer - sum*sum.transpose()/m[0])/(m[0] - 1.0)).template cast<ScalarT>();
+
+                    ScalarT eigenvalue;
+                    computeSymmetricSmallestEigenPair<ScalarT,3>(cov, eigenvalue, normals.col(k));
+                    if (normals.col(k).dot(view_point_ - points_.col(k)) < (ScalarT)0.0) {
+                        normals.col(k) *= (ScalarT)(-1.0);
+                    }
+                    curvatures[k] = eigenvalue/cov.trace();
+                }
+            }
+        }
+    };
+
+    typedef IntegralImageNormalEstimation<float> IntegralImageNormalEstimationf;
+    typedef IntegralImageNormalEstimation<double> IntegralImageNormalEstimationd;
+}
@@ -228,6 +228,15 @@ namespace cilantro {
             }
         }
 
+        // Runs a search that reports every candidate to a custom result adaptor (with the interface of
+        // KNNSearchResultAdaptor and RadiusSearchResultAdaptor), e.g. to process neighbors as they are found
+        template <class ResultAdaptorT>
+        inline void findNeighbors(const Eigen::Ref<const Vector<ScalarT,EigenDim>> &query_pt,
+                                  ResultAdaptorT &results) const
+        {
+            kd_tree_.findNeighbors(results, query_pt.data(), params_);
+        }
+
         template <NeighborhoodType NT>
         inline typename std::enable_if<NT == NeighborhoodType::KNN, void>::type search(const Eigen::Ref<const Vector<ScalarT,EigenDim>> &query_pt,
                                                                                        const NeighborhoodSpecification<ScalarT> &nh,
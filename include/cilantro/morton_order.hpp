@@ -0,0 +1,57 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <cilantro/data_containers.hpp>
+
+namespace cilantro {
+    // Morton (Z-order) code of a point, given its coordinates normalized to [0,1) over a bounding box; each
+    // coordinate is quantized to 64/dim bits, which are interleaved. Out of range coordinates are clamped and
+    // NaN coordinates map to cell 0.
+    template <typename ScalarT, ptrdiff_t EigenDim>
+    inline uint64_t getMortonCode(const Eigen::Ref<const Vector<ScalarT,EigenDim>> &normalized_point) {
+        const size_t dim = normalized_point.rows();
+        const size_t bits = 64/dim;
+        const uint64_t max_cell = (bits < 64) ? (uint64_t(1) << bits) - 1 : std::numeric_limits<uint64_t>::max();
+
+        uint64_t code = 0;
+        for (size_t d = 0; d < dim; d++) {
+            // Written so that NaN fails the first test: casting it to an integer is undefined
+            const ScalarT c = normalized_point[d]*(ScalarT)max_cell;
+            const uint64_t cell = (c > (ScalarT)0.0) ? ((c < (ScalarT)max_cell) ? (uint64_t)c : max_cell) : 0;
+            for (size_t b = 0; b < bits; b++) {
+                code |= ((cell >> b) & uint64_t(1)) << (b*dim + d);
+            }
+        }
+        return code;
+    }
+
+    // Permutation that sorts points in Morton order over their bounding box: consecutive indices are close in
+    // space, which improves the memory locality of per-point neighborhood queries processed in that order
+    template <typename ScalarT, ptrdiff_t EigenDim>
+    std::vector<size_t> getMortonOrder(const ConstVectorSetMatrixMap<ScalarT,EigenDim> &points) {
+        std::vector<size_t> order(points.cols());
+        if (points.cols() == 0) return order;
+
+        const Vector<ScalarT,EigenDim> min_pt = points.rowwise().minCoeff();
+        const Vector<ScalarT,EigenDim> range = points.rowwise().maxCoeff() - min_pt;
+        Vector<ScalarT,EigenDim> scale(points.rows(), 1);
+        for (size_t d = 0; d < (size_t)points.rows(); d++) {
+            scale[d] = (range[d] > (ScalarT)0.0) ? (ScalarT)1.0/range[d] : (ScalarT)0.0;
+        }
+
+        std::vector<std::pair<uint64_t,size_t>> codes(points.cols());
+#pragma omp parallel for
+        for (size_t i = 0; i < codes.size(); i++) {
+            codes[i].first = getMortonCode<ScalarT,EigenDim>((points.col(i) - min_pt).cwiseProduct(scale));
+            codes[i].second = i;
+        }
+        std::sort(codes.begin(), codes.end());
+
+        for (size_t i = 0; i < codes.size(); i++) {
+            order[i] = codes[i].second;
+        }
+        return order;
+    }
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <Eigen/Sparse>
+#include <cilantro/block_amd_ordering.hpp>
+#include <cilantro/block_diagonal_preconditioner.hpp>
+#include <cilantro/sparse_normal_equation_operator.hpp>
+
+namespace cilantro {
+    // Multigrid V-cycle preconditioner for Eigen's iterative solvers (drop-in replacement for
+    // Eigen::DiagonalPreconditioner) for systems of BlockSize x BlockSize node blocks over a node hierarchy
+    // (e.g. SparseWarpFieldHierarchy). Coarse operators are Galerkin projections A_{l+1} = P_l^T*A_l*P_l of the
+    // system matrix through the given prolongations; the coarsest one is factorized directly, all other levels
+    // get one damped block-Jacobi sweep before and after the coarse correction (which keeps the preconditioner
+    // symmetric). Without prolongations it reduces to BlockDiagonalPreconditioner.
+    template <typename ScalarT, ptrdiff_t BlockSize>
+    class MultilevelPreconditioner {
+        typedef Eigen::Matrix<ScalarT,Eigen::Dynamic,1> Vector;
+        typedef Eigen::SparseMatrix<ScalarT> SparseMatrix;
+
+    public:
+        typedef typename Vector::StorageIndex StorageIndex;
+
+        enum {
+            ColsAtCompileTime = Eigen::Dynamic,
+            MaxColsAtCompileTime = Eigen::Dynamic
+        };
+
+        MultilevelPreconditioner() : size_(0), coarse_solver_ok_(false), is_initialized_(false) {}
+
+        template <typename MatT>
+        explicit MultilevelPreconditioner(const MatT &mat) : size_(0), coarse_solver_ok_(false), is_initialized_(false) { compute(mat); }
+
+        // prolongations[l] maps level l+1 unknowns to level l unknowns (level 0 being the system's unknowns)
+        inline MultilevelPreconditioner& setProlongationOperators(const std::vector<SparseMatrix> &prolongations) {
+            prolongations_ = prolongations;
+            is_initialized_ = false;
+            return *this;
+        }
+
+        inline const std::vector<SparseMatrix>& getProlongationOperators() const { return prolongations_; }
+
+        inline size_t getNumberOfLevels() const { return prolongations_.size() + 1; }
+
+        inline Eigen::Index rows() const { return size_; }
+
+        inline Eigen::Index cols() const { return size_; }
+
+        template <typename MatT>
+        inline MultilevelPreconditioner& analyzePattern(const MatT &) { return *this; }
+
+        // mat must stay alive while the preconditioner is applied (as is the case within Eigen's solvers)
+        template <typename MatT>
+        MultilevelPreconditioner& factorize(const MatT &mat) {
+            fine_multiply_ = [&mat](const Vector &x, Vector &y) { y.noalias() = mat*x; };
+            smoothers_.resize(getNumberOfLevels());
+            smoothers_[0].factorize(mat);
+            coarse_matrices_.resize(prolongations_.size());
+            if (!prolongations_.empty()) {
+                const SparseMatrix PtA(prolongations_[0].transpose()*mat);
+                coarse_matrices_[0] = PtA*prolongations_[0];
+            }
+            return factorize_levels_(mat.cols());
+        }
+
+        // Matrix-free normal equations: the first coarse operator is formed as (P_0^T*At)*(P_0^T*At)^T
+        MultilevelPreconditioner& factorize(const SparseNormalEquationOperator<ScalarT> &op) {
+            fine_multiply_ = [&op](const Vector &x, Vector &y) { op.multiply(x, y); };
+            smoothers_.resize(getNumberOfLevels());
+            smoothers_[0].factorize(op);
+            coarse_matrices_.resize(prolongations_.size());
+            if (!prolongations_.empty()) {
+                const SparseMatrix PtAt(prolongations_[0].transpose()*op.getJacobianTranspose());
+                coarse_matrices_[0] = PtAt*PtAt.transpose();
+            }
+            return factorize_levels_(op.cols());
+        }
+
+        template <typename MatT>
+        inline MultilevelPreconditioner& compute(const MatT &mat) { return factorize(mat); }
+
+        template <typename RhsT, typename DestT>
+        void _solve_impl(const RhsT &b, DestT &x) const {
+            rhs_[0] = b;
+            v_cycle_(0);
+            x = solutions_[0];
+        }
+
+        template <typename RhsT>
+        inline const Eigen::Solve<MultilevelPreconditioner,RhsT> solve(const Eigen::MatrixBase<RhsT> &b) const {
+            eigen_assert(is_initialized_ && "MultilevelPreconditioner is not initialized.");
+            eigen_assert(size_ == (size_t)b.rows() && "MultilevelPreconditioner::solve(): invalid number of rows of the right hand side matrix b");
+            return Eigen::Solve<MultilevelPreconditioner,RhsT>(*this, b.derived());
+        }
+
+        inline Eigen::ComputationInfo info() const { return Eigen::Success; }
+
+    private:
+        size_t size_;
+        std::vector<SparseMatrix> prolongations_;
+        // coarse_matrices_[l] is the operator of level l+1
+        std::vector<SparseMatrix> coarse_matrices_;
+        std::function<void(const Vector&,Vector&)> fine_multiply_;
+        std::vector<BlockDiagonalPreconditioner<ScalarT,BlockSize>> smoothers_;
+        std::vector<ScalarT> damping_;
+        Eigen::SimplicialLDLT<SparseMatrix,Eigen::Lower,BlockAMDOrdering<typename SparseMatrix::StorageIndex,BlockSize>> coarse_solver_;
+        bool coarse_solver_ok_;
+        bool is_initialized_;
+
+        // Per level work vectors
+        mutable std::vector<Vector> rhs_;
+        mutable std::vector<Vector> solutions_;
+        mutable std::vector<Vector> residuals_;
+
+        inline void multiply_(size_t level, const Vector &x, Vector &y) const {
+            if (level == 0) {
+                fine_multiply_(x, y);
+            } else {
+                y.noalias() = coarse_matrices_[level - 1]*x;
+            }
+        }
+
+        MultilevelPreconditioner& factorize_levels_(size_t size) {
+            size_ = size;
+            const size_t num_levels = getNumberOfLevels();
+
+            for (size_t l = 1; l < num_levels; l++) {
+                if (l < coarse_matrices_.size()) {
+                    const SparseMatrix PtA(prolongations_[l].transpose()*coarse_matrices_[l - 1]);
+                    coarse_matrices_[l] = PtA*prolongations_[l];
+                }
+                if (l < num_levels - 1) smoothers_[l].factorize(coarse_matrices_[l - 1]);
+            }
+
+            rhs_.resize(num_levels);
+            solutions_.resize(num_levels);
+            residuals_.resize(num_levels);
+
+            // Damping of 4/3 over the spectral radius of the block-Jacobi preconditioned operator, as estimated
+            // by a few power iterations
+            damping_.resize(num_levels);
+            for (size_t l = 0; l + 1 < num_levels; l++) {
+                Vector &v = solutions_[l];
+                Vector &Av = residuals_[l];
+                v = Vector::LinSpaced(prolongations_[l].rows(), (ScalarT)1.0, (ScalarT)2.0).array().sin();
+                ScalarT lambda = (ScalarT)1.0;
+                for (size_t it = 0; it < 10; it++) {
+                    v.normalize();
+                    multiply_(l, v, Av);
+                    v = smoothers_[l].solve(Av);
+                    lambda = v.norm();
+                    if (!(lambda > (ScalarT)0.0)) break;
+                }
+                damping_[l] = (lambda > (ScalarT)0.0) ? (ScalarT)(4.0/3.0)/lambda : (ScalarT)1.0;
+            }
+
+            if (num_levels > 1) {
+                coarse_solver_.compute(coarse_matrices_.back());
+                coarse_solver_ok_ = coarse_solver_.info() == Eigen::Success;
+                if (!coarse_solver_ok_) smoothers_.back().factorize(coarse_matrices_.back());
+            }
+
+            is_initialized_ = true;
+            return *this;
+        }
+
+        // Computes solutions_[level] from rhs_[level], starting from zero
+        void v_cycle_(size_t level) const {
+            const Vector &b = rhs_[level];
+            Vector &x = solutions_[level];
+
+            if (level + 1 == getNumberOfLevels()) {
+                if (level > 0 && coarse_solver_ok_) {
+                    x = coarse_solver_.solve(b);
+                } else {
+                    x = smoothers_[level].solve(b);
+                }
+                return;
+            }
+
+            Vector &r = residuals_[level];
+
+            // Pre-smoothing
+            x = damping_[level]*smoothers_[level].solve(b);
+
+            // Coarse correction
+            multiply_(level, x, r);
+            r = b - r;
+            rhs_[level + 1].noalias() = prolongations_[level].transpose()*r;
+            v_cycle_(level + 1);
+            x.noalias() += prolongations_[level]*solutions_[level + 1];
+
+            // Post-smoothing
+            multiply_(level, x, r);
+            r = b - r;
+            x += damping_[level]*smoothers_[level].solve(r);
+        }
+    };
+}
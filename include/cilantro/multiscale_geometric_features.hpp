@@ -0,0 +1,190 @@
+#pragma once
+
+#include <cilantro/normal_estimation.hpp>
+
+namespace cilantro {
+    // Per scale local shape descriptors, from the eigenvalues l1 >= l2 >= l3 of the neighborhood covariance
+    enum struct GeometricFeature {
+        CURVATURE,      // l3/(l1 + l2 + l3) (surface variation)
+        LINEARITY,      // (l1 - l2)/l1
+        PLANARITY,      // (l2 - l3)/l1
+        SCATTERING      // l3/l1
+    };
+
+    // Local geometric features of 3D points over several neighborhood radii. Each point is queried once, at
+    // the largest radius, and every neighbor found is binned by the smallest scale whose radius contains it;
+    // since neighborhoods are nested, accumulating the moments bin by bin gives the statistics of all scales
+    // in turn, without a separate search (or sorting the neighbors) per scale. Features are stored in a matrix with
+    // NumberOfFeaturesPerScale rows per scale (in the order the radii were given), so that they can be fed
+    // directly to clustering (KMeans, MeanShift) as dynamic dimension points.
+    template <typename ScalarT>
+    class MultiScaleGeometricFeatures3 {
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        typedef ScalarT Scalar;
+
+        enum { NumberOfFeaturesPerScale = 4 };
+
+        MultiScaleGeometricFeatures3(const ConstVectorSetMatrixMap<ScalarT,3> &points, size_t max_leaf_size = 10)
+                : points_(points),
+                  kd_tree_ptr_(new KDTree<ScalarT,3,KDTreeDistanceAdaptors::L2>(points, max_leaf_size)),
+                  kd_tree_owned_(true),
+                  view_point_(Vector<ScalarT,3>::Zero())
+        {}
+
+        MultiScaleGeometricFeatures3(const KDTree<ScalarT,3,KDTreeDistanceAdaptors::L2> &kd_tree)
+                : points_(kd_tree.getPointsMatrixMap()),
+                  kd_tree_ptr_(&kd_tree),
+                  kd_tree_owned_(false),
+                  view_point_(Vector<ScalarT,3>::Zero())
+        {}
+
+        ~MultiScaleGeometricFeatures3() {
+            if (kd_tree_owned_) delete kd_tree_ptr_;
+        }
+
+        inline const Vector<ScalarT,3>& getViewPoint() const { return view_point_; }
+
+        inline MultiScaleGeometricFeatures3& setViewPoint(const Eigen::Ref<const Vector<ScalarT,3>> &vp) {
+            view_point_ = vp;
+            return *this;
+        }
+
+        // Row of a feature in the feature matrix
+        static inline size_t getFeatureIndex(size_t scale, GeometricFeature feature) {
+            return NumberOfFeaturesPerScale*scale + static_cast<size_t>(feature);
+        }
+
+        // Features (and normals, oriented towards the view point) for all radii; points with fewer than 3
+        // neighbors at a scale get NaN entries for it
+        const MultiScaleGeometricFeatures3& compute(const std::vector<ScalarT> &radii,
+                                                    VectorSet<ScalarT,Eigen::Dynamic> &features,
+                                                    std::vector<VectorSet<ScalarT,3>> &normals) const
+        {
+            compute_<true>(radii, features, normals);
+            return *this;
+        }
+
+        const MultiScaleGeometricFeatures3& compute(const std::vector<ScalarT> &radii,
+                                                    VectorSet<ScalarT,Eigen::Dynamic> &features) const
+        {
+            std::vector<VectorSet<ScalarT,3>> normals;
+            compute_<false>(radii, features, normals);
+            return *this;
+        }
+
+        inline VectorSet<ScalarT,Eigen::Dynamic> compute(const std::vector<ScalarT> &radii) const {
+            VectorSet<ScalarT,Eigen::Dynamic> features;
+            compute(radii, features);
+            return features;
+        }
+
+    private:
+        ConstVectorSetMatrixMap<ScalarT,3> points_;
+        const KDTree<ScalarT,3,KDTreeDistanceAdaptors::L2> *kd_tree_ptr_;
+        bool kd_tree_owned_;
+        Vector<ScalarT,3> view_point_;
+
+        // Radius search result adaptor that bins neighbor indices by scale as they are found; squared radii
+        // are ascending and the last one bounds the search
+        class ScaleBinningAdaptor_ {
+        public:
+            ScaleBinningAdaptor_(const std::vector<ScalarT> &radii_sq, std::vector<std::vector<size_t>> &bins)
+                    : radii_sq_(radii_sq), bins_(bins), count_(0)
+            {}
+
+            inline size_t size() const { return count_; }
+
+            inline bool full() const { return true; }
+
+            inline bool addPoint(ScalarT dist, size_t index) {
+                if (dist >= radii_sq_.back()) return true;
+                // Branchless: neighbors land in scales in no particular order
+                size_t s = 0;
+                for (size_t j = 0; j < radii_sq_.size() - 1; j++) s += (dist >= radii_sq_[j]);
+                bins_[s].emplace_back(index);
+                count_++;
+                return true;
+            }
+
+            inline ScalarT worstDist() const { return radii_sq_.back(); }
+
+        private:
+            const std::vector<ScalarT> &radii_sq_;
+            std::vector<std::vector<size_t>> &bins_;
+            size_t count_;
+        };
+
+        template <bool ComputeNormals>
+        void compute_(const std::vector<ScalarT> &radii,
+                      VectorSet<ScalarT,Eigen::Dynamic> &features,
+                      std::vector<VectorSet<ScalarT,3>> &normals) const
+        {
+            const size_t num_scales = radii.size();
+            const size_t num_points = points_.cols();
+
+            features.resize(NumberOfFeaturesPerScale*num_scales, num_points);
+            if (ComputeNormals) normals.assign(num_scales, VectorSet<ScalarT,3>(3, num_points));
+            if (num_scales == 0) return;
+
+            // Scales in ascending radius order
+            std::vector<size_t> scale_order(num_scales);
+            for (size_t s = 0; s < num_scales; s++) scale_order[s] = s;
+            std::sort(scale_order.begin(), scale_order.end(), [&radii](size_t a, size_t b) { return radii[a] < radii[b]; });
+            std::vector<ScalarT> radii_sq(num_scales);
+            for (size_t s = 0; s < num_scales; s++) {
+                radii_sq[s] = radii[scale_order[s]]*radii[scale_order[s]];
+            }
+
+            const std::vector<size_t> order = getMortonOrder<ScalarT,3>(points_);
+
+            std::vector<std::vector<size_t>> bins(num_scales);
+#pragma omp parallel for shared (features, normals) firstprivate (bins)
+            for (size_t k = 0; k < num_points; k++) {
+                const size_t i = order[k];
+                for (size_t s = 0; s < num_scales; s++) bins[s].clear();
+
+                ScaleBinningAdaptor_ adaptor(radii_sq, bins);
+                kd_tree_ptr_->findNeighbors(points_.col(i), adaptor);
+
+                internal::NeighborhoodMoments<ScalarT,3> moments(3);
+                for (size_t s = 0; s < num_scales; s++) {
+                    for (size_t j = 0; j < bins[s].size(); j++) {
+                        moments.add((points_.col(bins[s][j]) - points_.col(i)).template cast<double>());
+                    }
+                    const size_t scale = scale_order[s];
+                    auto point_features = features.col(i).template segment<NumberOfFeaturesPerScale>(NumberOfFeaturesPerScale*scale);
+                    if (moments.count < 3) {
+                        point_features.setConstant(std::numeric_limits<ScalarT>::quiet_NaN());
+                        if (ComputeNormals) normals[scale].col(i).setConstant(std::numeric_limits<ScalarT>::quiet_NaN());
+                        continue;
+                    }
+
+                    // Ascending eigenvalues
+                    Vector<ScalarT,3> eigenvalues;
+                    Eigen::Matrix<ScalarT,3,3> eigenvectors;
+                    computeSymmetricEigenDecomposition<ScalarT,3>(moments.getCovariance(), eigenvalues, eigenvectors);
+                    eigenvalues = eigenvalues.cwiseMax((ScalarT)0.0);
+
+                    const ScalarT sum = eigenvalues.sum();
+                    const ScalarT inv_largest = (eigenvalues[2] > (ScalarT)0.0) ? (ScalarT)1.0/eigenvalues[2] : (ScalarT)0.0;
+                    point_features[static_cast<size_t>(GeometricFeature::CURVATURE)] = (sum > (ScalarT)0.0) ? eigenvalues[0]/sum : (ScalarT)0.0;
+                    point_features[static_cast<size_t>(GeometricFeature::LINEARITY)] = (eigenvalues[2] - eigenvalues[1])*inv_largest;
+                    point_features[static_cast<size_t>(GeometricFeature::PLANARITY)] = (eigenvalues[1] - eigenvalues[0])*inv_largest;
+                    point_features[static_cast<size_t>(GeometricFeature::SCATTERING)] = eigenvalues[0]*inv_largest;
+
+                    if (ComputeNormals) {
+                        normals[scale].col(i) = eigenvectors.col(0);
+                        if (normals[scale].col(i).dot(view_point_ - points_.col(i)) < (ScalarT)0.0) {
+                            normals[scale].col(i) *= (ScalarT)(-1.0);
+                        }
+                    }
+                }
+            }
+        }
+    };
+
+    typedef MultiScaleGeometricFeatures3<float> MultiScaleGeometricFeatures3f;
+    typedef MultiScaleGeometricFeatures3<double> MultiScaleGeometricFeatures3d;
+}
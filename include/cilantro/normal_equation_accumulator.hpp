@@ -0,0 +1,83 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+namespace cilantro {
+    namespace internal {
+        // Accumulates the normal equations (AtA, Atb) of a small, fixed-size linear least squares problem.
+        // Only the upper triangle of the symmetric AtA is stored (row-major packed), in a flat array that
+        // is cheap to zero, merge and vectorize. Inputs of any scalar type are accumulated in AccumScalarT.
+        template <ptrdiff_t NumUnknowns, typename AccumScalarT = double>
+        struct SymmetricNormalEquationAccumulator {
+            enum {
+                NumVariables = NumUnknowns,
+                NumUpperEntries = NumUnknowns*(NumUnknowns + 1)/2
+            };
+
+            typedef AccumScalarT Scalar;
+
+            AccumScalarT AtA[NumUpperEntries];
+            AccumScalarT Atb[NumUnknowns];
+
+            inline SymmetricNormalEquationAccumulator() { setZero(); }
+
+            inline SymmetricNormalEquationAccumulator& setZero() {
+                for (size_t k = 0; k < NumUpperEntries; k++) AtA[k] = (AccumScalarT)0.0;
+                for (size_t k = 0; k < NumUnknowns; k++) Atb[k] = (AccumScalarT)0.0;
+                return *this;
+            }
+
+            // Adds the weighted equation a.dot(x) = b, i.e. AtA += w*a*a^T, Atb += w*b*a
+            template <typename InputScalarT>
+            inline SymmetricNormalEquationAccumulator& addEquation(const InputScalarT * a, InputScalarT b, InputScalarT w) {
+                AccumScalarT wa[NumUnknowns];
+                for (size_t i = 0; i < NumUnknowns; i++) wa[i] = (AccumScalarT)w*(AccumScalarT)a[i];
+
+                size_t k = 0;
+                for (size_t i = 0; i < NumUnknowns; i++) {
+                    for (size_t j = i; j < NumUnknowns; j++) {
+                        AtA[k++] += wa[i]*(AccumScalarT)a[j];
+                    }
+                    Atb[i] += wa[i]*(AccumScalarT)b;
+                }
+                return *this;
+            }
+
+            inline SymmetricNormalEquationAccumulator& operator+=(const SymmetricNormalEquationAccumulator &other) {
+                for (size_t k = 0; k < NumUpperEntries; k++) AtA[k] += other.AtA[k];
+                for (size_t k = 0; k < NumUnknowns; k++) Atb[k] += other.Atb[k];
+                return *this;
+            }
+
+            // Unpacks the stored system into full (symmetric) Eigen matrices
+            template <typename OutputScalarT>
+            inline const SymmetricNormalEquationAccumulator& getSystem(Eigen::Matrix<OutputScalarT,NumUnknowns,NumUnknowns> &AtA_full,
+                                                                       Eigen::Matrix<OutputScalarT,NumUnknowns,1> &Atb_full) const
+            {
+                size_t k = 0;
+                for (size_t i = 0; i < NumUnknowns; i++) {
+                    for (size_t j = i; j < NumUnknowns; j++) {
+                        AtA_full(i,j) = AtA_full(j,i) = (OutputScalarT)AtA[k++];
+                    }
+                    Atb_full[i] = (OutputScalarT)Atb[i];
+                }
+                return *this;
+            }
+
+            // Solves AtA*x = Atb in AccumScalarT precision
+            template <typename OutputScalarT>
+            inline const SymmetricNormalEquationAccumulator& solve(Eigen::Matrix<OutputScalarT,NumUnknowns,1> &x) const {
+                Eigen::Matrix<AccumScalarT,NumUnknowns,NumUnknowns> AtA_full;
+                Eigen::Matrix<AccumScalarT,NumUnknowns,1> Atb_full;
+                getSystem(AtA_full, Atb_full);
+                x = AtA_full.ldlt().solve(Atb_full).template cast<OutputScalarT>();
+                return *this;
+            }
+        };
+
+        template <ptrdiff_t NumUnknowns, typename AccumScalarT>
+        struct SymmetricNormalEquationReductions {
+#pragma omp declare reduction (+: SymmetricNormalEquationAccumulator<NumUnknowns,AccumScalarT>: omp_out += omp_in) initializer(omp_priv = SymmetricNormalEquationAccumulator<NumUnknowns,AccumScalarT>())
+        };
+    }
+}
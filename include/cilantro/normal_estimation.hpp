@@ -2,8 +2,36 @@
 
 //#include <cilantro/principal_component_analysis.hpp>
 #include <cilantro/kd_tree.hpp>
+#include <cilantro/morton_order.hpp>
+#include <cilantro/symmetric_eigen_decomposition.hpp>
 
 namespace cilantro {
+    namespace internal {
+        // Neighborhood moments (count, sum and sum of outer products), in double precision and relative to a
+        // reference point (e.g. the query point) for accuracy, from which the covariance follows in a single pass
+        template <typename ScalarT, ptrdiff_t EigenDim>
+        struct NeighborhoodMoments {
+            EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+            NeighborhoodMoments(size_t dim) : count(0), sum(Vector<double,EigenDim>::Zero(dim,1)), outer_sum(Eigen::Matrix<double,EigenDim,EigenDim>::Zero(dim,dim)) {}
+
+            inline void add(const Vector<double,EigenDim> &pt) {
+                count++;
+                sum += pt;
+                outer_sum.noalias() += pt*pt.transpose();
+            }
+
+            // Sample covariance (requires count > 1)
+            inline Eigen::Matrix<ScalarT,EigenDim,EigenDim> getCovariance() const {
+                return ((outer_sum - (1.0/count)*sum*sum.transpose())/(double)(count - 1)).template cast<ScalarT>();
+            }
+
+            size_t count;
+            Vector<double,EigenDim> sum;
+            Eigen::Matrix<double,EigenDim,EigenDim> outer_sum;
+        };
+    }
+
     template <typename ScalarT, ptrdiff_t EigenDim>
     class NormalEstimation {
     public:
@@ -193,6 +221,57 @@ namespace cilantro {
             }
         }
 
+        // Radius search result adaptor that accumulates neighbors as they are found
+        class RadiusMomentsAdaptor_ {
+        public:
+            RadiusMomentsAdaptor_(const ConstVectorSetMatrixMap<ScalarT,EigenDim> &points,
+                                  const Eigen::Ref<const Vector<ScalarT,EigenDim>> &query_pt,
+                                  ScalarT radius, internal::NeighborhoodMoments<ScalarT,EigenDim> &moments)
+                    : points_(points), query_pt_(query_pt), radius_(radius), moments_(moments)
+            {}
+
+            inline size_t size() const { return moments_.count; }
+
+            inline bool full() const { return true; }
+
+            inline bool addPoint(ScalarT dist, size_t index) {
+                if (dist < radius_) moments_.add((points_.col(index) - query_pt_).template cast<double>());
+                return true;
+            }
+
+            inline ScalarT worstDist() const { return radius_; }
+
+        private:
+            const ConstVectorSetMatrixMap<ScalarT,EigenDim> &points_;
+            const Vector<ScalarT,EigenDim> query_pt_;
+            const ScalarT radius_;
+            internal::NeighborhoodMoments<ScalarT,EigenDim> &moments_;
+        };
+
+        template <NeighborhoodType NT>
+        inline typename std::enable_if<NT == NeighborhoodType::KNN, void>::type accumulate_(size_t i, const NeighborhoodSpecification<ScalarT> &nh_sq, NeighborSet<ScalarT> &nn, internal::NeighborhoodMoments<ScalarT,EigenDim> &moments) const {
+            kd_tree_ptr_->kNNSearch(points_.col(i), nh_sq.maxNumberOfNeighbors, nn);
+            for (size_t j = 0; j < nn.size(); j++) {
+                moments.add((points_.col(nn[j].index) - points_.col(i)).template cast<double>());
+            }
+        }
+
+        template <NeighborhoodType NT>
+        inline typename std::enable_if<NT == NeighborhoodType::RADIUS, void>::type accumulate_(size_t i, const NeighborhoodSpecification<ScalarT> &nh_sq, NeighborSet<ScalarT> &, internal::NeighborhoodMoments<ScalarT,EigenDim> &moments) const {
+            RadiusMomentsAdaptor_ adaptor(points_, points_.col(i), nh_sq.radius, moments);
+            kd_tree_ptr_->findNeighbors(points_.col(i), adaptor);
+        }
+
+        template <NeighborhoodType NT>
+        inline typename std::enable_if<NT == NeighborhoodType::KNN_IN_RADIUS, void>::type accumulate_(size_t i, const NeighborhoodSpecification<ScalarT> &nh_sq, NeighborSet<ScalarT> &nn, internal::NeighborhoodMoments<ScalarT,EigenDim> &moments) const {
+            kd_tree_ptr_->kNNSearch(points_.col(i), nh_sq.maxNumberOfNeighbors, nn);
+            for (size_t j = 0; j < nn.size() && nn[j].value < nh_sq.radius; j++) {
+                moments.add((points_.col(nn[j].index) - points_.col(i)).template cast<double>());
+            }
+        }
+
+        // Points are processed in Morton order, so that consecutive queries (per thread) touch nearby tree nodes
+        // and points
         template <NeighborhoodType NT>
         void compute_(VectorSet<ScalarT,EigenDim> &normals,
                       VectorSet<ScalarT,1> &curvatures,
@@ -207,50 +286,30 @@ namespace cilantro {
             normals.resize(dim, num_points);
             curvatures.resize(1, num_points);
 
+            const std::vector<size_t> order = getMortonOrder<ScalarT,EigenDim>(points_);
+
             NeighborSet<ScalarT> nn;
 #pragma omp parallel for shared (normals) private (nn)
-            for (size_t i = 0; i < num_points; i++) {
-                kd_tree_ptr_->template search<NT>(points_.col(i), nh_sq, nn);
-                if (nn.size() < dim) {
+            for (size_t k = 0; k < num_points; k++) {
+                const size_t i = order[k];
+                internal::NeighborhoodMoments<ScalarT,EigenDim> moments(dim);
+                accumulate_<NT>(i, nh_sq, nn, moments);
+                if (moments.count < dim) {
                     normals.col(i).setConstant(std::numeric_limits<ScalarT>::quiet_NaN());
                     curvatures[i] = std::numeric_limits<ScalarT>::quiet_NaN();
                     continue;
                 }
 
-//                VectorSet<ScalarT,EigenDim> neighborhood(dim, nn.size());
-//                for (size_t j = 0; j < nn.size(); j++) {
-//                    neighborhood.col(j) = points_.col(nn[j].index);
-//                }
-//                PrincipalComponentAnalysis<ScalarT,EigenDim> pca(neighborhood, false);
-//                normals.col(i) = pca.getEigenVectors().col(dim-1);
-//                if (normals.col(i).dot(view_point_ - points_.col(i)) < (ScalarT)0.0) {
-//                    normals.col(i) *= (ScalarT)(-1.0);
-//                }
-//                curvatures[i] = pca.getEigenValues()[dim-1]/pca.getEigenValues().sum();
-
-                Vector<ScalarT,EigenDim> mean(Vector<ScalarT,EigenDim>::Zero(points_.rows(), 1));
-                for (size_t j = 0; j < nn.size(); j++) {
-                    mean += points_.col(nn[j].index);
-                }
-                mean *= (ScalarT)(1.0)/(nn.size());
+                const Eigen::Matrix<ScalarT,EigenDim,EigenDim> cov = moments.getCovariance();
 
-                Eigen::Matrix<ScalarT,EigenDim,EigenDim> cov(Eigen::Matrix<ScalarT,EigenDim,EigenDim>::Zero(points_.rows(), points_.rows()));
-                for (size_t j = 0; j < nn.size(); j++) {
-                    Vector<ScalarT,EigenDim> tmp = points_.col(nn[j].index) - mean;
-                    cov += tmp*tmp.transpose();
+                ScalarT eigenvalue;
+                computeSymmetricSmallestEigenPair<ScalarT,EigenDim>(cov, eigenvalue, normals.col(i));
+                if (normals.col(i).dot(view_point_ - points_.col(i)) < (ScalarT)0.0) {
+                    normals.col(i) *= (ScalarT)(-1.0);
                 }
-                cov *= (ScalarT)(1.0)/(nn.size() - 1);
-
-                Eigen::SelfAdjointEigenSolver<Eigen::Matrix<ScalarT,EigenDim,EigenDim>> eig(cov);
-                if (eig.eigenvectors().col(0).dot(view_point_ - points_.col(i)) < (ScalarT)0.0) {
-                    normals.col(i) = -eig.eigenvectors().col(0);
-                } else {
-                    normals.col(i) = eig.eigenvectors().col(0);
-                }
-                curvatures[i] = eig.eigenvalues()[0]/eig.eigenvalues().sum();
+                curvatures[i] = eigenvalue/cov.trace();
             }
         }
-
     };
 
     typedef NormalEstimation<float,2> NormalEstimation2f;
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <cilantro/point_cloud.hpp>
+#include <cilantro/integral_image_normal_estimation.hpp>
+
+namespace cilantro {
+    // Point cloud that keeps the pixel structure of the depth image it was generated from: data is stored
+    // with one column per pixel, in row major order, so that pixel neighbors are found in O(1). Invalid
+    // pixels (no depth measurement) are flagged in a validity mask, and hold NaN points (and normals), which
+    // stay invalid under rigid transformations. The accumulated transformation of the points from the camera
+    // frame is kept, so that depth-based operations (e.g. normal estimation) still see camera frame depths.
+    template <typename ScalarT>
+    class OrganizedPointCloud {
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        typedef ScalarT Scalar;
+
+        enum { Dimension = 3 };
+
+        VectorSet<ScalarT,3> points;
+        VectorSet<ScalarT,3> normals;
+        VectorSet<float,3> colors;
+
+        OrganizedPointCloud()
+                : width_(0), height_(0), num_valid_(0), camera_pose_(RigidTransform<ScalarT,3>::Identity())
+        {}
+
+        // Points in the camera frame, as produced by depthImageToPoints with keep_invalid set; pixels with
+        // non-positive (or NaN) depth are invalid
+        OrganizedPointCloud(const ConstVectorSetMatrixMap<ScalarT,3> &points, size_t width, size_t height)
+                : points(points), width_(width), height_(height), camera_pose_(RigidTransform<ScalarT,3>::Identity())
+        {
+            update_validity_();
+        }
+
+        template <class DepthConverterT, class = typename std::enable_if<std::is_same<typename DepthConverterT::MetricDepth,ScalarT>::value>::type>
+        OrganizedPointCloud(const typename DepthConverterT::RawDepth* depth_data,
+                            const DepthConverterT &depth_converter,
+                            size_t image_w, size_t image_h,
+                            const Eigen::Ref<const Eigen::Matrix<ScalarT,3,3>> &intrinsics)
+        {
+            fromDepthImage(DepthImageBackProjector<ScalarT>(image_w, image_h, intrinsics), depth_data, depth_converter);
+        }
+
+        template <class DepthConverterT, class = typename std::enable_if<std::is_same<typename DepthConverterT::MetricDepth,ScalarT>::value>::type>
+        OrganizedPointCloud(const unsigned char* rgb_data,
+                            const typename DepthConverterT::RawDepth* depth_data,
+                            const DepthConverterT &depth_converter,
+                            size_t image_w, size_t image_h,
+                            const Eigen::Ref<const Eigen::Matrix<ScalarT,3,3>> &intrinsics)
+        {
+            fromRGBDImages(DepthImageBackProjector<ScalarT>(image_w, image_h, intrinsics), rgb_data, depth_data, depth_converter);
+        }
+
+        inline size_t getWidth() const { return width_; }
+
+        inline size_t getHeight() const { return height_; }
+
+        // Number of pixels
+        inline size_t size() const { return points.cols(); }
+
+        inline size_t getNumberOfValidPoints() const { return num_valid_; }
+
+        inline bool isEmpty() const { return num_valid_ == 0; }
+
+        inline bool hasNormals() const { return points.cols() > 0 && normals.cols() == points.cols(); }
+
+        inline bool hasColors() const { return points.cols() > 0 && colors.cols() == points.cols(); }
+
+        inline size_t getIndex(size_t x, size_t y) const { return y*width_ + x; }
+
+        inline bool isValid(size_t index) const { return valid_[index] != 0; }
+
+        inline bool isValid(size_t x, size_t y) const { return valid_[y*width_ + x] != 0; }
+
+        inline const std::vector<unsigned char>& getValidityMask() const { return valid_; }
+
+        // Transformation from the camera frame to the current frame of the points
+        inline const RigidTransform<ScalarT,3>& getCameraPose() const { return camera_pose_; }
+
+        // All pixels (including invalid ones), without copying
+        inline ConstVectorSetMatrixMap<ScalarT,3> getPointsMatrixMap() const { return points; }
+
+        inline ConstVectorSetMatrixMap<ScalarT,3> getNormalsMatrixMap() const { return normals; }
+
+        inline ConstVectorSetMatrixMap<float,3> getColorsMatrixMap() const { return colors; }
+
+        std::vector<size_t> getValidPointIndices() const {
+            std::vector<size_t> res;
+            res.reserve(num_valid_);
+            for (size_t i = 0; i < valid_.size(); i++) {
+                if (valid_[i]) res.emplace_back(i);
+            }
+            return res;
+        }
+
+        // Unorganized copy of the valid points
+        PointCloud<ScalarT,3> toPointCloud() const {
+            const std::vector<size_t> indices(getValidPointIndices());
+            const bool has_normals = hasNormals();
+            const bool has_colors = hasColors();
+            PointCloud<ScalarT,3> res;
+            res.points.resize(3, indices.size());
+            if (has_normals) res.normals.resize(3, indices.size());
+            if (has_colors) res.colors.resize(3, indices.size());
+#pragma omp parallel for
+            for (size_t i = 0; i < indices.size(); i++) {
+                res.points.col(i) = points.col(indices[i]);
+                if (has_normals) res.normals.col(i) = normals.col(indices[i]);
+                if (has_colors) res.colors.col(i) = colors.col(indices[i]);
+            }
+            return res;
+        }
+
+        OrganizedPointCloud& clear() {
+            points.resize(Eigen::NoChange, 0);
+            normals.resize(Eigen::NoChange, 0);
+            colors.resize(Eigen::NoChange, 0);
+            width_ = 0;
+            height_ = 0;
+            valid_.clear();
+            num_valid_ = 0;
+            camera_pose_.setIdentity();
+            return *this;
+        }
+
+        // Normals from integral images over (2*window_radius + 1)^2 pixel windows (see
+        // IntegralImageNormalEstimation; window_radius must be positive); valid pixels on or next to a depth
+        // discontinuity get NaN normals.
+        // Estimation runs on the camera frame points (oriented towards the camera), and normals are then
+        // rotated to the current frame.
+        OrganizedPointCloud& estimateNormals(size_t window_radius, ScalarT max_depth_change_factor = (ScalarT)0.02) {
+            if (camera_pose_.matrix().isIdentity()) {
+                normals = IntegralImageNormalEstimation<ScalarT>(points, width_, height_).estimateNormals(window_radius, max_depth_change_factor);
+                return *this;
+            }
+            VectorSet<ScalarT,3> camera_points(3, points.cols());
+            transformPoints(camera_pose_.inverse(), points, camera_points);
+            normals = IntegralImageNormalEstimation<ScalarT>(camera_points, width_, height_).estimateNormals(window_radius, max_depth_change_factor);
+            transformNormals(camera_pose_, normals);
+            return *this;
+        }
+
+        // Rigid transformations only, so that camera frame depths can be recovered
+        inline OrganizedPointCloud& transform(const RigidTransform<ScalarT,3> &tform) {
+            if (hasNormals()) {
+                transformPointsNormals(tform, points, normals);
+            } else {
+                transformPoints(tform, points);
+            }
+            camera_pose_ = tform*camera_pose_;
+            return *this;
+        }
+
+        inline OrganizedPointCloud transformed(const RigidTransform<ScalarT,3> &tform) const {
+            OrganizedPointCloud cloud(*this);
+            cloud.transform(tform);
+            return cloud;
+        }
+
+        // The back projector holds the intrinsics (and ray tables), and can be reused across frames
+        template <class DepthConverterT, class = typename std::enable_if<std::is_same<typename DepthConverterT::MetricDepth,ScalarT>::value>::type>
+        inline OrganizedPointCloud& fromDepthImage(const DepthImageBackProjector<ScalarT> &back_projector,
+                                                   const typename DepthConverterT::RawDepth* depth_data,
+                                                   const DepthConverterT &depth_converter)
+        {
+            normals.resize(Eigen::NoChange, 0);
+            colors.resize(Eigen::NoChange, 0);
+            back_projector.depthImageToPoints(depth_data, depth_converter, points, true);
+            width_ = back_projector.getImageWidth();
+            height_ = back_projector.getImageHeight();
+            camera_pose_.setIdentity();
+            update_validity_();
+            return *this;
+        }
+
+        template <class DepthConverterT, class = typename std::enable_if<std::is_same<typename DepthConverterT::MetricDepth,ScalarT>::value>::type>
+        inline OrganizedPointCloud& fromRGBDImages(const DepthImageBackProjector<ScalarT> &back_projector,
+                                                   const unsigned char* rgb_data,
+                                                   const typename DepthConverterT::RawDepth* depth_data,
+                                                   const DepthConverterT &depth_converter)
+        {
+            normals.resize(Eigen::NoChange, 0);
+            back_projector.RGBDImagesToPointsColors(rgb_data, depth_data, depth_converter, points, colors, true);
+            width_ = back_projector.getImageWidth();
+            height_ = back_projector.getImageHeight();
+            camera_pose_.setIdentity();
+            update_validity_();
+            return *this;
+        }
+
+        template <class DepthConverterT, class = typename std::enable_if<std::is_same<typename DepthConverterT::MetricDepth,ScalarT>::value>::type>
+        inline OrganizedPointCloud& fromDepthImage(const typename DepthConverterT::RawDepth* depth_data,
+                                                   const DepthConverterT &depth_converter,
+                                                   size_t image_w, size_t image_h,
+                                                   const Eigen::Ref<const Eigen::Matrix<ScalarT,3,3>> &intrinsics)
+        {
+            return fromDepthImage(DepthImageBackProjector<ScalarT>(image_w, image_h, intrinsics), depth_data, depth_converter);
+        }
+
+        template <class DepthConverterT, class = typename std::enable_if<std::is_same<typename DepthConverterT::MetricDepth,ScalarT>::value>::type>
+        inline OrganizedPointCloud& fromRGBDImages(const unsigned char* rgb_data,
+                                                   const typename DepthConverterT::RawDepth* depth_data,
+                                                   const DepthConverterT &depth_converter,
+                                                   size_t image_w, size_t image_h,
+                                                   const Eigen::Ref<const Eigen::Matrix<ScalarT,3,3>> &intrinsics)
+        {
+            return fromRGBDImages(DepthImageBackProjector<ScalarT>(image_w, image_h, intrinsics), rgb_data, depth_data, depth_converter);
+        }
+
+    private:
+        size_t width_;
+        size_t height_;
+        std::vector<unsigned char> valid_;
+        size_t num_valid_;
+        RigidTransform<ScalarT,3> camera_pose_;
+
+        void update_validity_() {
+            valid_.resize(points.cols());
+            size_t num_valid = 0;
+#pragma omp parallel for reduction (+: num_valid)
+            for (size_t i = 0; i < valid_.size(); i++) {
+                valid_[i] = points(2,i) > (ScalarT)0.0;
+                if (valid_[i]) {
+                    num_valid++;
+                } else {
+                    points.col(i).setConstant(std::numeric_limits<ScalarT>::quiet_NaN());
+                }
+            }
+            num_valid_ = num_valid;
+        }
+    };
+
+    typedef OrganizedPointCloud<float> OrganizedPointCloud3f;
+    typedef OrganizedPointCloud<double> OrganizedPointCloud3d;
+}
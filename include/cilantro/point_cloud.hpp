@@ -147,37 +147,47 @@ namespace cilantro {
             return *this;
         }
 
+        // Indices must be below size(); out of range indices are ignored (they used to count towards clearing
+        // the whole cloud) and trigger an assertion in debug builds
         PointCloud& remove(const std::vector<size_t> &indices) {
             if (indices.empty()) return *this;
 
-            std::set<size_t> indices_set(indices.begin(), indices.end());
-            if (indices_set.size() >= size()) {
+            // Removal mask instead of an ordered set; removed columns are swapped with the last kept ones
+            std::vector<unsigned char> remove_mask(size(), 0);
+            size_t num_to_remove = 0;
+            for (size_t i = 0; i < indices.size(); i++) {
+                eigen_assert(indices[i] < remove_mask.size() && "PointCloud::remove(): index out of range");
+                if (indices[i] < remove_mask.size() && !remove_mask[indices[i]]) {
+                    remove_mask[indices[i]] = 1;
+                    num_to_remove++;
+                }
+            }
+            if (num_to_remove >= size()) {
                 clear();
                 return *this;
             }
 
             size_t valid_ind = size() - 1;
-            while (indices_set.find(valid_ind) != indices_set.end()) {
+            while (remove_mask[valid_ind]) {
                 valid_ind--;
             }
 
             const bool has_normals = hasNormals();
             const bool has_colors = hasColors();
 
-            auto ind_it = indices_set.begin();
-            while (ind_it != indices_set.end() && *ind_it < valid_ind) {
-                points.col(*ind_it).swap(points.col(valid_ind));
+            for (size_t i = 0; i < valid_ind; i++) {
+                if (!remove_mask[i]) continue;
+                points.col(i).swap(points.col(valid_ind));
                 if (has_normals) {
-                    normals.col(*ind_it).swap(normals.col(valid_ind));
+                    normals.col(i).swap(normals.col(valid_ind));
                 }
                 if (has_colors) {
-                    colors.col(*ind_it).swap(colors.col(valid_ind));
+                    colors.col(i).swap(colors.col(valid_ind));
                 }
                 valid_ind--;
-                while (*ind_it < valid_ind && indices_set.find(valid_ind) != indices_set.end()) {
+                while (i < valid_ind && remove_mask[valid_ind]) {
                     valid_ind--;
                 }
-                ++ind_it;
             }
 
             const size_t original_size = size();
@@ -0,0 +1,335 @@
+#pragma once
+
+#include <cilantro/point_cloud.hpp>
+#include <cilantro/timer.hpp>
+
+namespace cilantro {
+    // Wall clock time of each preprocessing stage, in ms (validity filtering and cropping run as one pass)
+    struct PointCloudPreprocessingTimings {
+        PointCloudPreprocessingTimings() : filtering(0.0), downsampling(0.0), normalEstimation(0.0), total(0.0) {}
+
+        double filtering;
+        double downsampling;
+        double normalEstimation;
+        double total;
+    };
+
+    // Validity filtering, axis aligned cropping, voxel grid downsampling and normal estimation for 3D point
+    // clouds, as one configurable step. Filtering and cropping are a single pass that yields the indices of
+    // the points to keep; downsampling finds the voxel of each point in a hash table (in expected constant
+    // time, instead of inserting every point into an ordered map), groups points by voxel with a counting
+    // sort, and averages each group in parallel. Bins are output in the order of their first kept point.
+    // Compared to removeInvalidData() followed by gridDownsample(), which reorders points (remove() swaps
+    // columns), the output is the same set of voxel averages (up to summation order rounding), in a
+    // different order; only on a cloud that needs no filtering does it match gridDownsample column by column.
+    // Scratch buffers are kept between calls, so that processing a stream of similarly sized clouds does
+    // not allocate after the first ones.
+    template <typename ScalarT>
+    class PointCloudPreprocessor {
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        typedef ScalarT Scalar;
+
+        PointCloudPreprocessor()
+                : crop_enabled_(false),
+                  crop_min_(Vector<ScalarT,3>::Constant(-std::numeric_limits<ScalarT>::infinity())),
+                  crop_max_(Vector<ScalarT,3>::Constant(std::numeric_limits<ScalarT>::infinity())),
+                  voxel_size_((ScalarT)0.0),
+                  min_points_in_voxel_(1),
+                  estimate_normals_(false),
+                  normal_neighborhood_(NeighborhoodType::KNN, 10, (ScalarT)0.0),
+                  view_point_(Vector<ScalarT,3>::Zero())
+        {}
+
+        inline bool getCropEnabled() const { return crop_enabled_; }
+
+        inline const Vector<ScalarT,3>& getCropBoxMin() const { return crop_min_; }
+
+        inline const Vector<ScalarT,3>& getCropBoxMax() const { return crop_max_; }
+
+        // Points outside [min_pt, max_pt] are dropped
+        inline PointCloudPreprocessor& setCropBox(const Eigen::Ref<const Vector<ScalarT,3>> &min_pt,
+                                                  const Eigen::Ref<const Vector<ScalarT,3>> &max_pt)
+        {
+            crop_enabled_ = true;
+            crop_min_ = min_pt;
+            crop_max_ = max_pt;
+            return *this;
+        }
+
+        inline PointCloudPreprocessor& disableCrop() {
+            crop_enabled_ = false;
+            return *this;
+        }
+
+        inline ScalarT getVoxelSize() const { return voxel_size_; }
+
+        inline size_t getMinPointsInVoxel() const { return min_points_in_voxel_; }
+
+        // A non-positive voxel size disables downsampling
+        inline PointCloudPreprocessor& setVoxelSize(ScalarT voxel_size, size_t min_points_in_voxel = 1) {
+            voxel_size_ = voxel_size;
+            min_points_in_voxel_ = min_points_in_voxel;
+            return *this;
+        }
+
+        inline bool getNormalEstimationEnabled() const { return estimate_normals_; }
+
+        inline const NeighborhoodSpecification<ScalarT>& getNormalEstimationNeighborhood() const { return normal_neighborhood_; }
+
+        // Normals of the output points (input normals are then not used)
+        inline PointCloudPreprocessor& setNormalEstimation(const NeighborhoodSpecification<ScalarT> &nh) {
+            estimate_normals_ = true;
+            normal_neighborhood_ = nh;
+            return *this;
+        }
+
+        inline PointCloudPreprocessor& disableNormalEstimation() {
+            estimate_normals_ = false;
+            return *this;
+        }
+
+        inline const Vector<ScalarT,3>& getViewPoint() const { return view_point_; }
+
+        inline PointCloudPreprocessor& setViewPoint(const Eigen::Ref<const Vector<ScalarT,3>> &vp) {
+            view_point_ = vp;
+            return *this;
+        }
+
+        inline const PointCloudPreprocessingTimings& getTimings() const { return timings_; }
+
+        // Output must not be the input
+        PointCloudPreprocessor& process(const PointCloud<ScalarT,3> &input, PointCloud<ScalarT,3> &output) {
+            Timer total_timer(true), timer(true);
+
+            const bool has_normals = input.hasNormals();
+            const bool has_colors = input.hasColors();
+            const bool keep_normals = has_normals && !estimate_normals_;
+
+            filter_(input, has_normals, has_colors);
+            timings_.filtering = timer.stopAndGetElapsedTime();
+
+            timer.start();
+            if (voxel_size_ > (ScalarT)0.0) {
+                downsample_(input, keep_normals, has_colors, output);
+            } else {
+                gather_(input, keep_normals, has_colors, output);
+            }
+            timings_.downsampling = timer.stopAndGetElapsedTime();
+
+            timer.start();
+            if (estimate_normals_) {
+                if (output.isEmpty()) {
+                    output.normals.resize(3, 0);
+                } else {
+                    NormalEstimation<ScalarT,3> ne(output.points);
+                    ne.setViewPoint(view_point_).estimateNormalsAndCurvature(output.normals, curvatures_, normal_neighborhood_);
+                }
+            }
+            timings_.normalEstimation = timer.stopAndGetElapsedTime();
+
+            timings_.total = total_timer.stopAndGetElapsedTime();
+            return *this;
+        }
+
+        // In place; the previous buffers of the cloud are kept as scratch space for the next call
+        inline PointCloudPreprocessor& process(PointCloud<ScalarT,3> &cloud) {
+            process(cloud, swap_cloud_);
+            cloud.points.swap(swap_cloud_.points);
+            cloud.normals.swap(swap_cloud_.normals);
+            cloud.colors.swap(swap_cloud_.colors);
+            return *this;
+        }
+
+        inline PointCloud<ScalarT,3> processed(const PointCloud<ScalarT,3> &input) {
+            PointCloud<ScalarT,3> output;
+            process(input, output);
+            return output;
+        }
+
+    private:
+        bool crop_enabled_;
+        Vector<ScalarT,3> crop_min_;
+        Vector<ScalarT,3> crop_max_;
+        ScalarT voxel_size_;
+        size_t min_points_in_voxel_;
+        bool estimate_normals_;
+        NeighborhoodSpecification<ScalarT> normal_neighborhood_;
+        Vector<ScalarT,3> view_point_;
+
+        PointCloudPreprocessingTimings timings_;
+
+        // Scratch buffers
+        std::vector<unsigned char> keep_mask_;
+        std::vector<size_t> kept_;
+        std::vector<size_t> block_counts_;
+        Eigen::Matrix<ptrdiff_t,3,Eigen::Dynamic> voxel_coords_;
+        std::vector<size_t> voxel_table_;
+        std::vector<size_t> bin_first_;
+        std::vector<size_t> point_bins_;
+        std::vector<size_t> bin_offsets_;
+        std::vector<size_t> bin_points_;
+        std::vector<std::pair<size_t,size_t>> voxel_runs_;
+        VectorSet<ScalarT,1> curvatures_;
+        PointCloud<ScalarT,3> swap_cloud_;
+
+        // Indices (ascending) of the points that have finite data and lie in the crop box, counted and then
+        // written per block, in parallel
+        void filter_(const PointCloud<ScalarT,3> &input, bool has_normals, bool has_colors) {
+            const size_t num_points = input.points.cols();
+            const size_t block_size = 4096;
+            const size_t num_blocks = (num_points + block_size - 1)/block_size;
+            block_counts_.assign(num_blocks + 1, 0);
+            keep_mask_.resize(num_points);
+            kept_.resize(num_points);
+
+            const bool crop = crop_enabled_;
+            const Vector<ScalarT,3> crop_min(crop_min_), crop_max(crop_max_);
+            auto keep = [&](size_t i) {
+                return input.points.col(i).allFinite() &&
+                       (!has_normals || input.normals.col(i).allFinite()) &&
+                       (!has_colors || input.colors.col(i).allFinite()) &&
+                       (!crop || ((input.points.col(i).array() >= crop_min.array()).all() && (input.points.col(i).array() <= crop_max.array()).all()));
+            };
+
+#pragma omp parallel for
+            for (size_t b = 0; b < num_blocks; b++) {
+                const size_t end = std::min((b + 1)*block_size, num_points);
+                size_t count = 0;
+                for (size_t i = b*block_size; i < end; i++) {
+                    keep_mask_[i] = keep(i);
+                    count += keep_mask_[i];
+                }
+                block_counts_[b + 1] = count;
+            }
+            for (size_t b = 0; b < num_blocks; b++) block_counts_[b + 1] += block_counts_[b];
+
+            // Compaction, each block at its offset
+#pragma omp parallel for
+            for (size_t b = 0; b < num_blocks; b++) {
+                const size_t end = std::min((b + 1)*block_size, num_points);
+                size_t k = block_counts_[b];
+                for (size_t i = b*block_size; i < end; i++) {
+                    if (keep_mask_[i]) kept_[k++] = i;
+                }
+            }
+            kept_.resize(block_counts_[num_blocks]);
+        }
+
+        void gather_(const PointCloud<ScalarT,3> &input, bool keep_normals, bool has_colors, PointCloud<ScalarT,3> &output) {
+            const size_t num_kept = kept_.size();
+            output.points.resize(3, num_kept);
+            output.normals.resize(3, keep_normals ? num_kept : 0);
+            output.colors.resize(3, has_colors ? num_kept : 0);
+#pragma omp parallel for
+            for (size_t k = 0; k < num_kept; k++) {
+                output.points.col(k) = input.points.col(kept_[k]);
+                if (keep_normals) output.normals.col(k) = input.normals.col(kept_[k]);
+                if (has_colors) output.colors.col(k) = input.colors.col(kept_[k]);
+            }
+        }
+
+        static inline size_t hash_voxel_(const Eigen::Matrix<ptrdiff_t,3,1> &c) {
+            return (size_t)(((uint64_t)c[0]*73856093ull) ^ ((uint64_t)c[1]*19349663ull) ^ ((uint64_t)c[2]*83492791ull))*(size_t)0x9E3779B97F4A7C15ull;
+        }
+
+        // Open addressing lookup of the bin of voxel_coords_.col(k); inserts a new bin if there is none
+        inline size_t find_or_insert_bin_(size_t k) {
+            const size_t mask = voxel_table_.size() - 1;
+            size_t slot = hash_voxel_(voxel_coords_.col(k)) & mask;
+            while (true) {
+                const size_t bin = voxel_table_[slot];
+                if (bin == std::numeric_limits<size_t>::max()) {
+                    voxel_table_[slot] = bin_first_.size();
+                    bin_first_.emplace_back(k);
+                    return bin_first_.size() - 1;
+                }
+                if (voxel_coords_.col(bin_first_[bin]) == voxel_coords_.col(k)) return bin;
+                slot = (slot + 1) & mask;
+            }
+        }
+
+        void rehash_voxel_table_(size_t capacity) {
+            voxel_table_.assign(capacity, std::numeric_limits<size_t>::max());
+            for (size_t bin = 0; bin < bin_first_.size(); bin++) {
+                size_t slot = hash_voxel_(voxel_coords_.col(bin_first_[bin])) & (capacity - 1);
+                while (voxel_table_[slot] != std::numeric_limits<size_t>::max()) slot = (slot + 1) & (capacity - 1);
+                voxel_table_[slot] = bin;
+            }
+        }
+
+        void downsample_(const PointCloud<ScalarT,3> &input, bool keep_normals, bool has_colors, PointCloud<ScalarT,3> &output) {
+            const size_t num_kept = kept_.size();
+            const ScalarT inv_size = (ScalarT)1.0/voxel_size_;
+
+            // Voxel coordinates as in GridAccumulator
+            voxel_coords_.resize(3, num_kept);
+#pragma omp parallel for
+            for (size_t k = 0; k < num_kept; k++) {
+                for (size_t j = 0; j < 3; j++) {
+                    voxel_coords_(j,k) = std::floor(input.points(j,kept_[k])*inv_size);
+                }
+            }
+
+            // Bins are numbered in order of their first point; the table is kept at most half full
+            bin_first_.clear();
+            point_bins_.resize(num_kept);
+            rehash_voxel_table_(std::max<size_t>(voxel_table_.size(), 1024));
+            for (size_t k = 0; k < num_kept; k++) {
+                if (2*(bin_first_.size() + 1) > voxel_table_.size()) rehash_voxel_table_(2*voxel_table_.size());
+                point_bins_[k] = find_or_insert_bin_(k);
+            }
+
+            // Counting sort of the points by bin (stable, so each bin keeps ascending point order)
+            const size_t num_bins = bin_first_.size();
+            bin_offsets_.assign(num_bins + 1, 0);
+            for (size_t k = 0; k < num_kept; k++) bin_offsets_[point_bins_[k] + 1]++;
+            for (size_t v = 0; v < num_bins; v++) bin_offsets_[v + 1] += bin_offsets_[v];
+            bin_points_.resize(num_kept);
+            bin_first_.assign(bin_offsets_.begin(), bin_offsets_.end() - 1);
+            for (size_t k = 0; k < num_kept; k++) bin_points_[bin_first_[point_bins_[k]]++] = kept_[k];
+
+            voxel_runs_.resize(num_bins);
+            for (size_t v = 0; v < num_bins; v++) voxel_runs_[v] = std::pair<size_t,size_t>(bin_offsets_[v], bin_offsets_[v + 1]);
+
+            const size_t min_count = std::max<size_t>(min_points_in_voxel_, 1);
+            size_t num_out = 0;
+            for (size_t v = 0; v < voxel_runs_.size(); v++) {
+                if (voxel_runs_[v].second - voxel_runs_[v].first >= min_count) voxel_runs_[num_out++] = voxel_runs_[v];
+            }
+            voxel_runs_.resize(num_out);
+
+            output.points.resize(3, num_out);
+            output.normals.resize(3, keep_normals ? num_out : 0);
+            output.colors.resize(3, has_colors ? num_out : 0);
+#pragma omp parallel for
+            for (size_t v = 0; v < num_out; v++) {
+                const size_t begin = voxel_runs_[v].first, end = voxel_runs_[v].second;
+                const size_t first = bin_points_[begin];
+                Vector<ScalarT,3> point_sum(input.points.col(first));
+                Vector<ScalarT,3> normal_sum(keep_normals ? Vector<ScalarT,3>(input.normals.col(first)) : Vector<ScalarT,3>::Zero());
+                Vector<float,3> color_sum(has_colors ? Vector<float,3>(input.colors.col(first)) : Vector<float,3>::Zero());
+                for (size_t k = begin + 1; k < end; k++) {
+                    const size_t i = bin_points_[k];
+                    point_sum += input.points.col(i);
+                    if (keep_normals) {
+                        if (normal_sum.dot(input.normals.col(i)) < (ScalarT)0.0) {
+                            normal_sum -= input.normals.col(i);
+                        } else {
+                            normal_sum += input.normals.col(i);
+                        }
+                    }
+                    if (has_colors) color_sum += input.colors.col(i);
+                }
+                const ScalarT scale = (ScalarT)1.0/(end - begin);
+                output.points.col(v) = scale*point_sum;
+                if (keep_normals) output.normals.col(v) = (scale*normal_sum).normalized();
+                if (has_colors) output.colors.col(v) = ((float)scale)*color_sum;
+            }
+        }
+    };
+
+    typedef PointCloudPreprocessor<float> PointCloudPreprocessorf;
+    typedef PointCloudPreprocessor<double> PointCloudPreprocessord;
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <random>
+#include <algorithm>
+#include <cilantro/grid_accumulator.hpp>
+#include <cilantro/accumulators.hpp>
+
+namespace cilantro {
+    // Draws fixed-size random index subsets from a partition of the point indices into buckets,
+    // spreading the samples as evenly as possible across buckets. All per-point work is done once at
+    // construction; each call to sampleIndices() costs O(number of samples + number of buckets).
+    class BucketIndexSampler {
+    public:
+        BucketIndexSampler(size_t num_samples)
+                : num_samples_(num_samples), rng_(std::random_device()())
+        {}
+
+        inline size_t getNumberOfSamples() const { return num_samples_; }
+
+        inline BucketIndexSampler& setNumberOfSamples(size_t num_samples) {
+            num_samples_ = num_samples;
+            return *this;
+        }
+
+        inline BucketIndexSampler& setSeed(size_t seed) {
+            rng_.seed(seed);
+            return *this;
+        }
+
+        inline const std::vector<std::vector<size_t>>& getBuckets() const { return buckets_; }
+
+        // Indices are returned in ascending order, without repetitions
+        const BucketIndexSampler& sampleIndices(std::vector<size_t> &indices) {
+            indices.clear();
+            if (buckets_.empty()) return *this;
+
+            // Visit buckets by increasing size, so that quota left unused by small buckets goes to larger ones
+            size_t samples_left = num_samples_;
+            size_t buckets_left = bucket_order_.size();
+            for (size_t b = 0; b < bucket_order_.size(); b++) {
+                std::vector<size_t> &bucket = buckets_[bucket_order_[b]];
+                const size_t quota = std::min(bucket.size(), (samples_left + buckets_left - 1)/buckets_left);
+                // Partial Fisher-Yates shuffle: the first quota entries become a uniform random subset
+                for (size_t j = 0; j < quota; j++) {
+                    std::swap(bucket[j], bucket[std::uniform_int_distribution<size_t>(j, bucket.size() - 1)(rng_)]);
+                    indices.emplace_back(bucket[j]);
+                }
+                samples_left -= quota;
+                buckets_left--;
+            }
+            std::sort(indices.begin(), indices.end());
+
+            return *this;
+        }
+
+        inline std::vector<size_t> sampleIndices() {
+            std::vector<size_t> indices;
+            sampleIndices(indices);
+            return indices;
+        }
+
+    protected:
+        size_t num_samples_;
+        std::mt19937 rng_;
+        std::vector<std::vector<size_t>> buckets_;
+        std::vector<size_t> bucket_order_;
+
+        inline void finalize_buckets_() {
+            size_t k = 0;
+            for (size_t b = 0; b < buckets_.size(); b++) {
+                if (!buckets_[b].empty()) buckets_[k++].swap(buckets_[b]);
+            }
+            buckets_.resize(k);
+
+            bucket_order_.resize(buckets_.size());
+            for (size_t b = 0; b < bucket_order_.size(); b++) bucket_order_[b] = b;
+            std::sort(bucket_order_.begin(), bucket_order_.end(), [this](size_t b1, size_t b2) { return buckets_[b1].size() < buckets_[b2].size(); });
+        }
+    };
+
+    // Uniform random sampling
+    class UniformRandomPointSampler : public BucketIndexSampler {
+    public:
+        UniformRandomPointSampler(size_t num_points, size_t num_samples)
+                : BucketIndexSampler(num_samples)
+        {
+            buckets_.resize(1);
+            buckets_[0].resize(num_points);
+            for (size_t i = 0; i < num_points; i++) buckets_[0][i] = i;
+            finalize_buckets_();
+        }
+    };
+
+    // Normal-space sampling: points are bucketed by normal direction and samples are spread uniformly over
+    // the occupied normal buckets, so that small but well-oriented surface patches are not drowned out
+    template <typename ScalarT, ptrdiff_t EigenDim>
+    class NormalSpacePointSampler : public BucketIndexSampler {
+    public:
+        NormalSpacePointSampler(const ConstVectorSetMatrixMap<ScalarT,EigenDim> &normals,
+                                size_t num_samples,
+                                size_t num_bins_per_dimension = 8)
+                : BucketIndexSampler(num_samples)
+        {
+            // Normal components lie in [-1,1]
+            GridAccumulator<ScalarT,EigenDim,IndexAccumulatorProxy> normal_grid(normals, (ScalarT)2.0/(ScalarT)std::max<size_t>(num_bins_per_dimension, 1), IndexAccumulatorProxy());
+            const auto& bins = normal_grid.getOccupiedBinIterators();
+            buckets_.resize(bins.size());
+            for (size_t b = 0; b < bins.size(); b++) {
+                buckets_[b] = std::move(bins[b]->second.indices);
+            }
+            finalize_buckets_();
+        }
+    };
+
+    // Covariance (stability) based sampling for point-to-plane registration, after Gelfand et al.,
+    // "Geometrically Stable Sampling for the ICP Algorithm" (3DIM 2003). Each point's constraint vector
+    // [p x n; n] is assigned to the eigenvector of the constraint covariance it constrains the most,
+    // relative to the eigenvalue; samples are then spread evenly over these six directions, which favors
+    // points that lock down otherwise weakly constrained degrees of freedom.
+    template <typename ScalarT>
+    class CovarianceStablePointSampler : public BucketIndexSampler {
+    public:
+        CovarianceStablePointSampler(const ConstVectorSetMatrixMap<ScalarT,3> &points,
+                                     const ConstVectorSetMatrixMap<ScalarT,3> &normals,
+                                     size_t num_samples)
+                : BucketIndexSampler(num_samples)
+        {
+            buckets_.resize(6);
+            if (points.cols() == 0 || points.cols() != normals.cols()) {
+                finalize_buckets_();
+                return;
+            }
+
+            // Center and scale points so that rotational and translational terms are commensurate
+            const Vector<ScalarT,3> mu(points.rowwise().mean());
+            const ScalarT scale = std::max((points.colwise() - mu).colwise().norm().mean(), std::numeric_limits<ScalarT>::epsilon());
+
+            Eigen::Matrix<ScalarT,6,Eigen::Dynamic> constraints(6, points.cols());
+#pragma omp parallel for
+            for (size_t i = 0; i < (size_t)points.cols(); i++) {
+                constraints.template block<3,1>(0,i) = ((points.col(i) - mu)/scale).cross(normals.col(i));
+                constraints.template block<3,1>(3,i) = normals.col(i);
+            }
+
+            Eigen::SelfAdjointEigenSolver<Eigen::Matrix<ScalarT,6,6>> eig(constraints*constraints.transpose());
+            const Vector<ScalarT,6> inv_sqrt_eigenvalues = eig.eigenvalues().cwiseMax(std::numeric_limits<ScalarT>::epsilon()).cwiseSqrt().cwiseInverse();
+
+            std::vector<unsigned char> assignment(points.cols());
+#pragma omp parallel for
+            for (size_t i = 0; i < (size_t)points.cols(); i++) {
+                size_t best;
+                (eig.eigenvectors().transpose()*constraints.col(i)).cwiseAbs().cwiseProduct(inv_sqrt_eigenvalues).maxCoeff(&best);
+                assignment[i] = (unsigned char)best;
+            }
+            for (size_t i = 0; i < (size_t)points.cols(); i++) {
+                buckets_[assignment[i]].emplace_back(i);
+            }
+
+            finalize_buckets_();
+        }
+    };
+
+    typedef NormalSpacePointSampler<float,2> NormalSpacePointSampler2f;
+    typedef NormalSpacePointSampler<double,2> NormalSpacePointSampler2d;
+    typedef NormalSpacePointSampler<float,3> NormalSpacePointSampler3f;
+    typedef NormalSpacePointSampler<double,3> NormalSpacePointSampler3d;
+
+    typedef CovarianceStablePointSampler<float> CovarianceStablePointSampler3f;
+    typedef CovarianceStablePointSampler<double> CovarianceStablePointSampler3d;
+}
@@ -2,6 +2,7 @@
 
 #include <cilantro/data_containers.hpp>
 #include <cilantro/omp_reductions.hpp>
+#include <cilantro/symmetric_eigen_decomposition.hpp>
 
 namespace cilantro {
     template <typename ScalarT, ptrdiff_t EigenDim>
@@ -30,13 +31,13 @@ namespace cilantro {
                 }
                 cov *= (ScalarT)(1.0)/(data.cols()-1);
 
-                Eigen::SelfAdjointEigenSolver<Eigen::Matrix<ScalarT,EigenDim,EigenDim>> eig(cov);
-                eigenvectors_ = eig.eigenvectors().rowwise().reverse();
+                computeSymmetricEigenDecomposition<ScalarT,EigenDim>(cov, eigenvalues_, eigenvectors_);
+                eigenvectors_ = eigenvectors_.rowwise().reverse().eval();
                 if (eigenvectors_.determinant() < (ScalarT)0.0) {
                     auto last_col = eigenvectors_.col(data.rows() - 1);
                     last_col = -last_col;
                 }
-                eigenvalues_ = eig.eigenvalues().reverse();
+                eigenvalues_ = eigenvalues_.reverse().eval();
             } else {
                 mean_ = data.rowwise().mean();
 
@@ -47,13 +48,13 @@ namespace cilantro {
                 }
                 cov *= (ScalarT)(1.0)/(data.cols()-1);
 
-                Eigen::SelfAdjointEigenSolver<Eigen::Matrix<ScalarT,EigenDim,EigenDim>> eig(cov);
-                eigenvectors_ = eig.eigenvectors().rowwise().reverse();
+                computeSymmetricEigenDecomposition<ScalarT,EigenDim>(cov, eigenvalues_, eigenvectors_);
+                eigenvectors_ = eigenvectors_.rowwise().reverse().eval();
                 if (eigenvectors_.determinant() < (ScalarT)0.0) {
                     auto last_col = eigenvectors_.col(data.rows() - 1);
                     last_col = -last_col;
                 }
-                eigenvalues_ = eig.eigenvalues().reverse();
+                eigenvalues_ = eigenvalues_.reverse().eval();
             }
         }
 
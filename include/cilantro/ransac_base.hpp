@@ -3,7 +3,10 @@
 #include <vector>
 #include <algorithm>
 #include <random>
+#include <limits>
+#include <atomic>
 #include <Eigen/Dense>
+#include <cilantro/timer.hpp>
 
 namespace cilantro {
     // CRTP base class
@@ -26,7 +29,10 @@ namespace cilantro {
                   max_iter_(max_iter),
                   inlier_dist_thresh_(inlier_dist_thresh),
                   re_estimate_(re_estimate),
-                  iteration_count_(0)
+                  time_budget_(std::numeric_limits<double>::infinity()),
+                  cancellation_flag_(NULL),
+                  iteration_count_(0),
+                  terminated_early_(false)
         {}
 
         inline size_t getSampleSize() const { return sample_size_; }
@@ -64,6 +70,22 @@ namespace cilantro {
             return *static_cast<ModelEstimatorT*>(this);
         }
 
+        // Wall-clock budget (in milliseconds) for a single estimate() call; checked between hypotheses
+        inline double getTimeBudget() const { return time_budget_; }
+
+        inline ModelEstimatorT& setTimeBudget(double time_budget_ms) {
+            time_budget_ = time_budget_ms;
+            return *static_cast<ModelEstimatorT*>(this);
+        }
+
+        inline const std::atomic<bool>* getCancellationFlag() const { return cancellation_flag_; }
+
+        // estimate() stops before the next hypothesis once *flag becomes true (NULL disables)
+        inline ModelEstimatorT& setCancellationFlag(const std::atomic<bool> *flag) {
+            cancellation_flag_ = flag;
+            return *static_cast<ModelEstimatorT*>(this);
+        }
+
         ModelEstimatorT& estimate() {
             ModelEstimatorT& estimator = *static_cast<ModelEstimatorT*>(this);
             const size_t num_points = estimator.getDataPointsCount();
@@ -84,8 +106,18 @@ namespace cilantro {
             ResidualVector curr_residuals;
             std::vector<size_t> curr_inliers;
 
+            Timer timer(true);
+            terminated_early_ = false;
             iteration_count_ = 0;
             while (iteration_count_ < max_iter_) {
+                // Stop between hypotheses if out of time or cancelled; the best model so far is kept
+                if ((cancellation_flag_ != NULL && cancellation_flag_->load(std::memory_order_relaxed)) ||
+                    timer.getElapsedTimeSinceStart() >= time_budget_)
+                {
+                    terminated_early_ = true;
+                    break;
+                }
+
                 // Pick a random sample
                 if (std::distance(sample_start_it, perm.end()) < sample_size_) {
                     std::shuffle(perm.begin(), perm.end(), rng);
@@ -118,8 +150,8 @@ namespace cilantro {
                 if (model_inliers_.size() >= inlier_count_thresh_) break;
             }
 
-            // Re-estimate
-            if (re_estimate_) {
+            // Re-estimate (unless stopped before any usable hypothesis was found)
+            if (re_estimate_ && !(terminated_early_ && model_inliers_.empty())) {
                 estimator.estimateModel(model_inliers_, model_params_);
                 estimator.computeResiduals(model_params_, model_residuals_);
                 model_inliers_.resize(num_points);
@@ -180,6 +212,9 @@ namespace cilantro {
 
         inline size_t getNumberOfInliers() const { return model_inliers_.size(); }
 
+        // True if the last estimate() call was stopped by the time budget or the cancellation flag
+        inline bool hasTerminatedEarly() const { return terminated_early_; }
+
     private:
         // Parameters
         size_t sample_size_;
@@ -187,9 +222,12 @@ namespace cilantro {
         size_t max_iter_;
         ResidualScalar inlier_dist_thresh_;
         bool re_estimate_;
+        double time_budget_;
+        const std::atomic<bool> *cancellation_flag_;
 
         // Object state and results
         size_t iteration_count_;
+        bool terminated_early_;
         Model model_params_;
         ResidualVector model_residuals_;
         std::vector<size_t> model_inliers_;
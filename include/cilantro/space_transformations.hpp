@@ -47,8 +47,6 @@ namespace cilantro {
 
         TransformSet(size_t size) : TransformSetBase<TransformT>(size) {}
 
-        TransformSet(const TransformSet<TransformT> &other) : TransformSetBase<TransformT>(other) {}
-
         TransformSet(size_t size, const TransformT &tform) : TransformSetBase<TransformT>(size, tform) {}
 
         TransformSet& setIdentity() {
@@ -109,6 +107,15 @@ namespace cilantro {
         }
     };
 
+    namespace internal {
+        // Transform applied to the i-th point, for both single transforms and transform sets
+        template <class TransformT>
+        inline const TransformT& getPointTransform(const TransformT &tform, size_t) { return tform; }
+
+        template <class TransformT>
+        inline const TransformT& getPointTransform(const TransformSet<TransformT> &tforms, size_t i) { return tforms[i]; }
+    }
+
     template <typename ScalarT, ptrdiff_t EigenDim>
     using RigidTransformSet = TransformSet<RigidTransform<ScalarT,EigenDim>>;
 
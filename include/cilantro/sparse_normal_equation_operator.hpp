@@ -0,0 +1,248 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <Eigen/Sparse>
+
+namespace cilantro {
+    template <typename ScalarT>
+    class SparseNormalEquationOperator;
+}
+
+namespace Eigen {
+    namespace internal {
+        template <typename ScalarT>
+        struct traits<cilantro::SparseNormalEquationOperator<ScalarT>> : public traits<Eigen::SparseMatrix<ScalarT>> {};
+    }
+}
+
+namespace cilantro {
+    // Matrix-free representation of the normal equations matrix At*At^T of a sparse least squares problem,
+    // given the transposed Jacobian At (one column per equation). Products with dense vectors are evaluated
+    // as At*(At^T*x) in two parallel gathers (one over the equations, one over the unknowns) into preallocated
+    // buffers, without ever forming At*At^T; memory use is that of a row-major copy of At. As in
+    // SparseNormalEquationProduct, the equations touching each unknown are computed once and reused for as
+    // long as the structure of At stays the same (only the values are refilled). Usable as the
+    // matrix type of Eigen's iterative solvers
+    // (e.g. Eigen::ConjugateGradient<SparseNormalEquationOperator<ScalarT>,Eigen::Lower|Eigen::Upper,...>).
+    // Products write into internal buffers, so an instance must not be used from several threads at once.
+    template <typename ScalarT>
+    class SparseNormalEquationOperator : public Eigen::EigenBase<SparseNormalEquationOperator<ScalarT>> {
+    public:
+        typedef ScalarT Scalar;
+        typedef ScalarT RealScalar;
+        typedef typename Eigen::SparseMatrix<ScalarT>::StorageIndex StorageIndex;
+
+        enum {
+            ColsAtCompileTime = Eigen::Dynamic,
+            MaxColsAtCompileTime = Eigen::Dynamic,
+            // The operator is symmetric; declaring it row-major keeps Eigen's CG from wrapping it in a Transpose
+            IsRowMajor = true
+        };
+
+        SparseNormalEquationOperator() : At_(NULL), num_symbolic_analyses_(0) {}
+
+        SparseNormalEquationOperator(const Eigen::SparseMatrix<ScalarT> &At) : num_symbolic_analyses_(0) { setJacobianTranspose(At); }
+
+        // At must be compressed and outlive the operator (or the next call to this method)
+        SparseNormalEquationOperator& setJacobianTranspose(const Eigen::SparseMatrix<ScalarT> &At) {
+            eigen_assert(At.isCompressed() && "SparseNormalEquationOperator::setJacobianTranspose(): At must be compressed");
+            At_ = &At;
+            if (!has_same_structure_(At)) analyze_pattern_(At);
+            gather_values_(At);
+            equation_values_.resize(At.cols());
+            return *this;
+        }
+
+        inline const Eigen::SparseMatrix<ScalarT>& getJacobianTranspose() const { return *At_; }
+
+        inline Eigen::Index rows() const { return (At_ == NULL) ? 0 : At_->rows(); }
+
+        inline Eigen::Index cols() const { return (At_ == NULL) ? 0 : At_->rows(); }
+
+        // Number of symbolic analyses (structure changes of At) so far
+        inline size_t getNumberOfSymbolicAnalyses() const { return num_symbolic_analyses_; }
+
+        // result = At*At^T*x
+        template <typename DestT>
+        inline void multiply(const Eigen::Ref<const Eigen::Matrix<ScalarT,Eigen::Dynamic,1>> &x, DestT &result) const {
+            result.resize(At_->rows());
+            multiply_(x, result, (ScalarT)1.0, false);
+        }
+
+        // result += alpha*At*At^T*x
+        template <typename DestT>
+        inline void multiplyAdd(const Eigen::Ref<const Eigen::Matrix<ScalarT,Eigen::Dynamic,1>> &x,
+                                DestT &result, ScalarT alpha) const
+        {
+            multiply_(x, result, alpha, true);
+        }
+
+        // Diagonal BlockSize x BlockSize blocks of At*At^T, side by side (block k in columns
+        // [BlockSize*k, BlockSize*(k + 1)), the last one possibly partial); each block is computed by one task,
+        // from the (sorted) equation lists of its unknowns
+        template <ptrdiff_t BlockSize>
+        void computeDiagonalBlocks(Eigen::Matrix<ScalarT,BlockSize,Eigen::Dynamic> &blocks) const {
+            const StorageIndex num_unknowns = (StorageIndex)At_->rows();
+            const StorageIndex num_blocks = (num_unknowns + BlockSize - 1)/BlockSize;
+
+            blocks.setZero(BlockSize, BlockSize*num_blocks);
+#pragma omp parallel for schedule(dynamic, 64)
+            for (StorageIndex b = 0; b < num_blocks; b++) {
+                const StorageIndex block_start = BlockSize*b;
+                const StorageIndex block_end = std::min<StorageIndex>(block_start + BlockSize, num_unknowns);
+                for (StorageIndex i = block_start; i < block_end; i++) {
+                    for (StorageIndex j = i; j < block_end; j++) {
+                        ScalarT dot = (ScalarT)0.0;
+                        StorageIndex p = eq_outer_[i], q = eq_outer_[j];
+                        while (p < eq_outer_[i + 1] && q < eq_outer_[j + 1]) {
+                            if (eq_indices_[p] < eq_indices_[q]) {
+                                p++;
+                            } else if (eq_indices_[q] < eq_indices_[p]) {
+                                q++;
+                            } else {
+                                dot += row_values_[p++]*row_values_[q++];
+                            }
+                        }
+                        blocks(i - block_start, j) = dot;
+                        blocks(j - block_start, i) = dot;
+                    }
+                }
+            }
+        }
+
+        template <typename RhsT>
+        inline Eigen::Product<SparseNormalEquationOperator,RhsT,Eigen::AliasFreeProduct> operator*(const Eigen::MatrixBase<RhsT> &x) const {
+            return Eigen::Product<SparseNormalEquationOperator,RhsT,Eigen::AliasFreeProduct>(*this, x.derived());
+        }
+
+    private:
+        const Eigen::SparseMatrix<ScalarT> *At_;
+        size_t num_symbolic_analyses_;
+
+        // Structure of the At the equation map was computed for
+        Eigen::Index At_rows_;
+        std::vector<StorageIndex> At_outer_;
+        std::vector<StorageIndex> At_inner_;
+
+        // For unknown i, the entries At(i,e) (as positions in At's value array) of the equations e touching it,
+        // in eq_entries_[eq_outer_[i]..eq_outer_[i+1]), along with the equations themselves; row_values_ holds
+        // the values of those entries (i.e. At in row-major order), refilled on every setJacobianTranspose()
+        std::vector<StorageIndex> eq_outer_;
+        std::vector<StorageIndex> eq_entries_;
+        std::vector<StorageIndex> eq_indices_;
+        std::vector<ScalarT> row_values_;
+
+        // At^T*x of the last product
+        mutable Eigen::Matrix<ScalarT,Eigen::Dynamic,1> equation_values_;
+
+        bool has_same_structure_(const Eigen::SparseMatrix<ScalarT> &At) const {
+            if (At_outer_.empty() || At.rows() != At_rows_ || At.outerSize() + 1 != (Eigen::Index)At_outer_.size() ||
+                At.nonZeros() != (Eigen::Index)At_inner_.size())
+            {
+                return false;
+            }
+            return std::equal(At_outer_.begin(), At_outer_.end(), At.outerIndexPtr()) &&
+                   std::equal(At_inner_.begin(), At_inner_.end(), At.innerIndexPtr());
+        }
+
+        void analyze_pattern_(const Eigen::SparseMatrix<ScalarT> &At) {
+            const StorageIndex num_unknowns = (StorageIndex)At.rows();
+            const StorageIndex num_eq = (StorageIndex)At.cols();
+            const StorageIndex * const At_outer = At.outerIndexPtr();
+            const StorageIndex * const At_inner = At.innerIndexPtr();
+
+            At_rows_ = At.rows();
+            At_outer_.assign(At_outer, At_outer + num_eq + 1);
+            At_inner_.assign(At_inner, At_inner + At.nonZeros());
+
+            eq_outer_.assign(num_unknowns + 1, 0);
+            for (StorageIndex k = 0; k < At_outer[num_eq]; k++) eq_outer_[At_inner[k] + 1]++;
+            for (StorageIndex i = 0; i < num_unknowns; i++) eq_outer_[i + 1] += eq_outer_[i];
+            eq_entries_.resize(At_outer[num_eq]);
+            eq_indices_.resize(At_outer[num_eq]);
+            row_values_.resize(At_outer[num_eq]);
+            std::vector<StorageIndex> next(eq_outer_.begin(), eq_outer_.end() - 1);
+            for (StorageIndex e = 0; e < num_eq; e++) {
+                for (StorageIndex k = At_outer[e]; k < At_outer[e + 1]; k++) {
+                    const StorageIndex pos = next[At_inner[k]]++;
+                    eq_entries_[pos] = k;
+                    eq_indices_[pos] = e;
+                }
+            }
+
+            num_symbolic_analyses_++;
+        }
+
+        void gather_values_(const Eigen::SparseMatrix<ScalarT> &At) {
+            const StorageIndex num_entries = (StorageIndex)eq_entries_.size();
+            const ScalarT * const At_values = At.valuePtr();
+#pragma omp parallel for
+            for (StorageIndex p = 0; p < num_entries; p++) {
+                row_values_[p] = At_values[eq_entries_[p]];
+            }
+        }
+
+        // result = alpha*At*At^T*x (+ result, if accumulate)
+        template <typename DestT>
+        void multiply_(const Eigen::Ref<const Eigen::Matrix<ScalarT,Eigen::Dynamic,1>> &x,
+                       DestT &result, ScalarT alpha, bool accumulate) const
+        {
+            const StorageIndex num_unknowns = (StorageIndex)At_->rows();
+            const StorageIndex num_eq = (StorageIndex)At_->cols();
+            const StorageIndex * const At_outer = At_->outerIndexPtr();
+            const StorageIndex * const At_inner = At_->innerIndexPtr();
+            const ScalarT * const At_values = At_->valuePtr();
+            const StorageIndex * const eq_outer = eq_outer_.data();
+            const StorageIndex * const eq_indices = eq_indices_.data();
+            const ScalarT * const row_values = row_values_.data();
+            ScalarT * const At_x = equation_values_.data();
+
+#pragma omp parallel
+            {
+                // At^T*x, one equation per iteration
+#pragma omp for
+                for (StorageIndex e = 0; e < num_eq; e++) {
+                    ScalarT dot = (ScalarT)0.0;
+                    for (StorageIndex k = At_outer[e]; k < At_outer[e + 1]; k++) {
+                        dot += At_values[k]*x[At_inner[k]];
+                    }
+                    At_x[e] = dot;
+                }
+
+                // At*(At^T*x), one unknown per iteration (the implicit barrier above makes At_x complete)
+#pragma omp for schedule(dynamic, 256)
+                for (StorageIndex i = 0; i < num_unknowns; i++) {
+                    ScalarT sum = (ScalarT)0.0;
+                    for (StorageIndex p = eq_outer[i]; p < eq_outer[i + 1]; p++) {
+                        sum += row_values[p]*At_x[eq_indices[p]];
+                    }
+                    if (accumulate) {
+                        result.coeffRef(i) += alpha*sum;
+                    } else {
+                        result.coeffRef(i) = alpha*sum;
+                    }
+                }
+            }
+        }
+    };
+}
+
+namespace Eigen {
+    namespace internal {
+        template <typename ScalarT, typename RhsT>
+        struct generic_product_impl<cilantro::SparseNormalEquationOperator<ScalarT>,RhsT,SparseShape,DenseShape,GemvProduct>
+                : generic_product_impl_base<cilantro::SparseNormalEquationOperator<ScalarT>,RhsT,generic_product_impl<cilantro::SparseNormalEquationOperator<ScalarT>,RhsT>>
+        {
+            template <typename DestT>
+            static void evalTo(DestT &dst, const cilantro::SparseNormalEquationOperator<ScalarT> &lhs, const RhsT &rhs) {
+                lhs.multiply(rhs, dst);
+            }
+
+            template <typename DestT>
+            static void scaleAndAddTo(DestT &dst, const cilantro::SparseNormalEquationOperator<ScalarT> &lhs, const RhsT &rhs, const ScalarT &alpha) {
+                lhs.multiplyAdd(rhs, dst, alpha);
+            }
+        };
+    }
+}
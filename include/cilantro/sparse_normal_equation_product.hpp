@@ -0,0 +1,183 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <Eigen/Sparse>
+
+namespace cilantro {
+    // Parallel evaluation of the normal equations matrix At*At^T of a sparse least squares problem, given the
+    // transposed Jacobian At (one column per equation). The symbolic pattern of the product, together with
+    // the equations touching each unknown, is computed once and reused for as long as the structure of At
+    // stays the same (e.g. across the Gauss-Newton iterations of an estimation call); every call then only
+    // refills the values, one output column per task (row-partitioned, as the product is symmetric).
+    template <typename ScalarT>
+    class SparseNormalEquationProduct {
+    public:
+        typedef Eigen::SparseMatrix<ScalarT> SparseMatrix;
+        typedef typename SparseMatrix::StorageIndex StorageIndex;
+
+        SparseNormalEquationProduct() : num_symbolic_analyses_(0) {}
+
+        // Returns At*At^T (full, with both triangles); the reference stays valid until the next call
+        const SparseMatrix& compute(const SparseMatrix &At_in) {
+            const SparseMatrix &At = At_in.isCompressed() ? At_in : (At_compressed_ = At_in);
+            if (has_same_structure_(At)) {
+                compute_values_(At);
+            } else {
+                analyze_pattern_(At);
+            }
+            return AtA_;
+        }
+
+        inline const SparseMatrix& getMatrix() const { return AtA_; }
+
+        // Number of symbolic analyses (structure changes of At) so far
+        inline size_t getNumberOfSymbolicAnalyses() const { return num_symbolic_analyses_; }
+
+        // Drops the cached pattern
+        inline SparseNormalEquationProduct& reset() {
+            At_outer_.clear();
+            At_inner_.clear();
+            AtA_.resize(0,0);
+            return *this;
+        }
+
+    private:
+        size_t num_symbolic_analyses_;
+
+        // Structure of the At the pattern was computed for
+        Eigen::Index At_rows_;
+        std::vector<StorageIndex> At_outer_;
+        std::vector<StorageIndex> At_inner_;
+
+        // For unknown i, the entries At(i,e) (as positions in At's value array) of the equations e touching it,
+        // in eq_entries_[eq_outer_[i]..eq_outer_[i+1]), along with the equations themselves
+        std::vector<StorageIndex> eq_outer_;
+        std::vector<StorageIndex> eq_entries_;
+        std::vector<StorageIndex> eq_indices_;
+
+        SparseMatrix At_compressed_;
+        SparseMatrix AtA_;
+
+        bool has_same_structure_(const SparseMatrix &At) const {
+            if (At_outer_.empty() || At.rows() != At_rows_ || At.outerSize() + 1 != (Eigen::Index)At_outer_.size() ||
+                At.nonZeros() != (Eigen::Index)At_inner_.size())
+            {
+                return false;
+            }
+            return std::equal(At_outer_.begin(), At_outer_.end(), At.outerIndexPtr()) &&
+                   std::equal(At_inner_.begin(), At_inner_.end(), At.innerIndexPtr());
+        }
+
+        // Also computes the values
+        void analyze_pattern_(const SparseMatrix &At) {
+            const StorageIndex num_unknowns = (StorageIndex)At.rows();
+            const StorageIndex num_eq = (StorageIndex)At.cols();
+            const StorageIndex * const At_outer = At.outerIndexPtr();
+            const StorageIndex * const At_inner = At.innerIndexPtr();
+
+            At_rows_ = At.rows();
+            At_outer_.assign(At_outer, At_outer + num_eq + 1);
+            At_inner_.assign(At_inner, At_inner + At.nonZeros());
+
+            // Equations per unknown (transposed structure of At)
+            eq_outer_.assign(num_unknowns + 1, 0);
+            for (StorageIndex k = 0; k < At_outer[num_eq]; k++) eq_outer_[At_inner[k] + 1]++;
+            for (StorageIndex i = 0; i < num_unknowns; i++) eq_outer_[i + 1] += eq_outer_[i];
+            eq_entries_.resize(At_outer[num_eq]);
+            eq_indices_.resize(At_outer[num_eq]);
+            std::vector<StorageIndex> next(eq_outer_.begin(), eq_outer_.end() - 1);
+            for (StorageIndex e = 0; e < num_eq; e++) {
+                for (StorageIndex k = At_outer[e]; k < At_outer[e + 1]; k++) {
+                    const StorageIndex pos = next[At_inner[k]]++;
+                    eq_entries_[pos] = k;
+                    eq_indices_[pos] = e;
+                }
+            }
+
+            // Column i of At*At^T is the union of the unknowns of the equations touching unknown i. Columns are
+            // built (pattern and values) in per thread buffers, and copied into place once all sizes are known
+            const ScalarT * const At_values = At.valuePtr();
+            std::vector<StorageIndex> col_start(num_unknowns + 1, 0);
+#pragma omp parallel
+            {
+                std::vector<StorageIndex> marker(num_unknowns, -1);
+                std::vector<ScalarT> accumulator(num_unknowns, (ScalarT)0.0);
+                std::vector<StorageIndex> local_cols, local_inner;
+                std::vector<ScalarT> local_values;
+#pragma omp for schedule(dynamic, 256)
+                for (StorageIndex i = 0; i < num_unknowns; i++) {
+                    const size_t local_start = local_inner.size();
+                    for (StorageIndex p = eq_outer_[i]; p < eq_outer_[i + 1]; p++) {
+                        const ScalarT a_ie = At_values[eq_entries_[p]];
+                        const StorageIndex e = eq_indices_[p];
+                        for (StorageIndex k = At_outer[e]; k < At_outer[e + 1]; k++) {
+                            if (marker[At_inner[k]] != i) {
+                                marker[At_inner[k]] = i;
+                                local_inner.emplace_back(At_inner[k]);
+                            }
+                            accumulator[At_inner[k]] += a_ie*At_values[k];
+                        }
+                    }
+                    std::sort(local_inner.begin() + local_start, local_inner.end());
+                    for (size_t k = local_start; k < local_inner.size(); k++) {
+                        local_values.emplace_back(accumulator[local_inner[k]]);
+                        accumulator[local_inner[k]] = (ScalarT)0.0;
+                    }
+                    local_cols.emplace_back(i);
+                    col_start[i + 1] = (StorageIndex)(local_inner.size() - local_start);
+                }
+
+#pragma omp single
+                {
+                    for (StorageIndex i = 0; i < num_unknowns; i++) col_start[i + 1] += col_start[i];
+                    AtA_ = SparseMatrix(num_unknowns, num_unknowns);
+                    AtA_.resizeNonZeros(col_start[num_unknowns]);
+                    std::copy(col_start.begin(), col_start.end(), AtA_.outerIndexPtr());
+                }
+
+                size_t local_start = 0;
+                for (size_t c = 0; c < local_cols.size(); c++) {
+                    const StorageIndex i = local_cols[c];
+                    const size_t col_size = col_start[i + 1] - col_start[i];
+                    std::copy(local_inner.begin() + local_start, local_inner.begin() + local_start + col_size, AtA_.innerIndexPtr() + col_start[i]);
+                    std::copy(local_values.begin() + local_start, local_values.begin() + local_start + col_size, AtA_.valuePtr() + col_start[i]);
+                    local_start += col_size;
+                }
+            }
+
+            num_symbolic_analyses_++;
+        }
+
+        void compute_values_(const SparseMatrix &At) {
+            const StorageIndex num_unknowns = (StorageIndex)AtA_.rows();
+            const StorageIndex * const At_outer = At.outerIndexPtr();
+            const StorageIndex * const At_inner = At.innerIndexPtr();
+            const ScalarT * const At_values = At.valuePtr();
+            const StorageIndex * const AtA_outer = AtA_.outerIndexPtr();
+            const StorageIndex * const AtA_inner = AtA_.innerIndexPtr();
+            ScalarT * const AtA_values = AtA_.valuePtr();
+
+            // Scatter each column into a per thread dense accumulator, then gather it over the pattern (which
+            // also clears the accumulator)
+#pragma omp parallel
+            {
+                std::vector<ScalarT> accumulator(num_unknowns, (ScalarT)0.0);
+#pragma omp for schedule(dynamic, 256)
+                for (StorageIndex i = 0; i < num_unknowns; i++) {
+                    for (StorageIndex p = eq_outer_[i]; p < eq_outer_[i + 1]; p++) {
+                        const ScalarT a_ie = At_values[eq_entries_[p]];
+                        const StorageIndex e = eq_indices_[p];
+                        for (StorageIndex k = At_outer[e]; k < At_outer[e + 1]; k++) {
+                            accumulator[At_inner[k]] += a_ie*At_values[k];
+                        }
+                    }
+                    for (StorageIndex k = AtA_outer[i]; k < AtA_outer[i + 1]; k++) {
+                        AtA_values[k] = accumulator[AtA_inner[k]];
+                        accumulator[AtA_inner[k]] = (ScalarT)0.0;
+                    }
+                }
+            }
+        }
+    };
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <Eigen/Sparse>
+#include <cilantro/grid_downsampler.hpp>
+#include <cilantro/kd_tree.hpp>
+#include <cilantro/warp_field_utilities.hpp>
+
+namespace cilantro {
+    // Coarse-to-fine hierarchy of control nodes for sparse warp fields (e.g. CombinedMetricSparseWarpFieldICP).
+    // Level 0 nodes are grid-downsampled from the points at the given node resolution, and each further level
+    // grid-downsamples the nodes of the previous one at a resolution level_resolution_ratio times coarser.
+    // For every level, provides the point-to-node (skinning) and node-to-node (regularization) neighborhoods
+    // of the warp field estimators; consecutive levels are linked by node-to-coarser-node neighborhoods, which
+    // prolongate transforms (coarse solutions as fine initializations) and Gauss-Newton steps (the
+    // prolongation operators of the MULTILEVEL conjugate gradient preconditioner).
+    // Neighborhood values are squared distances; regularization neighborhoods start with the node itself.
+    template <class TransformT, class WeightEvaluatorT = RBFKernelWeightEvaluator<typename TransformT::Scalar,typename TransformT::Scalar,true>>
+    class SparseWarpFieldHierarchy {
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        typedef typename TransformT::Scalar Scalar;
+
+        enum {
+            Dimension = TransformT::Dim,
+            // Gauss-Newton unknowns per node
+            NumberOfParameters = (int(TransformT::Mode) == int(Eigen::Isometry)) ? TransformT::Dim*(TransformT::Dim + 1)/2 : TransformT::Dim*(TransformT::Dim + 1)
+        };
+
+        // Stops adding levels early once a level has a single node or downsampling no longer reduces the node count
+        SparseWarpFieldHierarchy(const ConstVectorSetMatrixMap<Scalar,TransformT::Dim> &points,
+                                 Scalar node_resolution,
+                                 size_t max_num_levels,
+                                 Scalar level_resolution_ratio = (Scalar)2.0,
+                                 size_t num_skinning_neighbors = 4,
+                                 size_t num_regularization_neighbors = 8)
+                : num_skinning_neighbors_(num_skinning_neighbors),
+                  num_regularization_neighbors_(num_regularization_neighbors)
+        {
+            Scalar resolution = node_resolution;
+            for (size_t l = 0; l < max_num_levels; l++) {
+                VectorSet<Scalar,TransformT::Dim> level_nodes = (l == 0) ? PointsGridDownsampler<Scalar,TransformT::Dim>(points, resolution).getDownsampledPoints()
+                                                                         : PointsGridDownsampler<Scalar,TransformT::Dim>(nodes_.back(), resolution).getDownsampledPoints();
+                if (l > 0 && (nodes_.back().cols() < 2 || level_nodes.cols() >= nodes_.back().cols())) break;
+
+                node_resolutions_.emplace_back(resolution);
+                nodes_.emplace_back(std::move(level_nodes));
+                weight_evaluators_.emplace_back(resolution);
+                resolution *= level_resolution_ratio;
+            }
+
+            const size_t num_levels = nodes_.size();
+            skinning_neighborhoods_.resize(num_levels);
+            regularization_neighborhoods_.resize(num_levels);
+            prolongation_neighborhoods_.resize((num_levels > 0) ? num_levels - 1 : 0);
+            for (size_t l = 0; l < num_levels; l++) {
+                const KDTree<Scalar,TransformT::Dim,KDTreeDistanceAdaptors::L2> tree(nodes_[l]);
+                tree.search(points, kNNNeighborhood<Scalar>(num_skinning_neighbors_), skinning_neighborhoods_[l]);
+                tree.search(nodes_[l], kNNNeighborhood<Scalar>(num_regularization_neighbors_ + 1), regularization_neighborhoods_[l]);
+                if (l > 0) tree.search(nodes_[l - 1], kNNNeighborhood<Scalar>(num_skinning_neighbors_), prolongation_neighborhoods_[l - 1]);
+            }
+        }
+
+        inline size_t getNumberOfLevels() const { return nodes_.size(); }
+
+        inline Scalar getNodeResolution(size_t level) const { return node_resolutions_[level]; }
+
+        inline size_t getNumberOfNodes(size_t level) const { return nodes_[level].cols(); }
+
+        inline const VectorSet<Scalar,TransformT::Dim>& getNodes(size_t level) const { return nodes_[level]; }
+
+        // Point-to-node neighborhoods of a level (src_to_ctrl_neighborhoods of the sparse warp field estimators)
+        inline const std::vector<NeighborSet<Scalar>>& getSkinningNeighborhoods(size_t level) const { return skinning_neighborhoods_[level]; }
+
+        // Node-to-node neighborhoods of a level (ctrl_regularization_neighborhoods of the sparse warp field estimators)
+        inline const std::vector<NeighborSet<Scalar>>& getRegularizationNeighborhoods(size_t level) const { return regularization_neighborhoods_[level]; }
+
+        // Neighborhoods of the nodes of level in the nodes of level + 1
+        inline const std::vector<NeighborSet<Scalar>>& getProlongationNeighborhoods(size_t level) const { return prolongation_neighborhoods_[level]; }
+
+        // Interpolation weights from the nodes of level (by default, an RBF kernel with the level's node resolution as sigma)
+        inline WeightEvaluatorT& weightEvaluator(size_t level) { return weight_evaluators_[level]; }
+
+        inline const WeightEvaluatorT& weightEvaluator(size_t level) const { return weight_evaluators_[level]; }
+
+        inline size_t getNumberOfSkinningNeighbors() const { return num_skinning_neighbors_; }
+
+        inline size_t getNumberOfRegularizationNeighbors() const { return num_regularization_neighbors_; }
+
+        // Interpolates the transforms of the nodes of level + 1 at the nodes of level
+        inline const SparseWarpFieldHierarchy& prolongateTransforms(size_t level,
+                                                                    const TransformSet<TransformT> &coarse_transforms,
+                                                                    TransformSet<TransformT> &fine_transforms) const
+        {
+            resampleTransforms(coarse_transforms, prolongation_neighborhoods_[level], fine_transforms, weight_evaluators_[level + 1]);
+            return *this;
+        }
+
+        inline TransformSet<TransformT> prolongateTransforms(size_t level, const TransformSet<TransformT> &coarse_transforms) const {
+            TransformSet<TransformT> fine_transforms;
+            prolongateTransforms(level, coarse_transforms, fine_transforms);
+            return fine_transforms;
+        }
+
+        // Linear interpolation of the Gauss-Newton unknowns of the nodes of level + 1 at the nodes of level, with
+        // the weights of prolongateTransforms
+        Eigen::SparseMatrix<Scalar> getProlongationOperator(size_t level) const {
+            const std::vector<NeighborSet<Scalar>> &nbhds = prolongation_neighborhoods_[level];
+            const WeightEvaluatorT &evaluator = weight_evaluators_[level + 1];
+
+            std::vector<Eigen::Triplet<Scalar>> entries;
+            entries.reserve(NumberOfParameters*num_skinning_neighbors_*nbhds.size());
+            for (size_t i = 0; i < nbhds.size(); i++) {
+                Scalar total_weight = (Scalar)0.0;
+                for (size_t j = 0; j < nbhds[i].size(); j++) {
+                    total_weight += evaluator(i, nbhds[i][j].index, nbhds[i][j].value);
+                }
+                if (total_weight == (Scalar)0.0) continue;
+                for (size_t j = 0; j < nbhds[i].size(); j++) {
+                    const Scalar weight = evaluator(i, nbhds[i][j].index, nbhds[i][j].value)/total_weight;
+                    for (size_t c = 0; c < NumberOfParameters; c++) {
+                        entries.emplace_back(NumberOfParameters*i + c, NumberOfParameters*nbhds[i][j].index + c, weight);
+                    }
+                }
+            }
+
+            Eigen::SparseMatrix<Scalar> prolongation(NumberOfParameters*nodes_[level].cols(), NumberOfParameters*nodes_[level + 1].cols());
+            prolongation.setFromTriplets(entries.begin(), entries.end());
+            return prolongation;
+        }
+
+        // Prolongation operators from level up to the coarsest level (as expected by the MULTILEVEL
+        // preconditioner of a solver for the given level)
+        std::vector<Eigen::SparseMatrix<Scalar>> getProlongationOperators(size_t level = 0) const {
+            std::vector<Eigen::SparseMatrix<Scalar>> prolongations;
+            for (size_t l = level; l + 1 < nodes_.size(); l++) {
+                prolongations.emplace_back(getProlongationOperator(l));
+            }
+            return prolongations;
+        }
+
+    private:
+        size_t num_skinning_neighbors_;
+        size_t num_regularization_neighbors_;
+        std::vector<Scalar> node_resolutions_;
+        std::vector<VectorSet<Scalar,TransformT::Dim>> nodes_;
+        std::vector<WeightEvaluatorT> weight_evaluators_;
+        std::vector<std::vector<NeighborSet<Scalar>>> skinning_neighborhoods_;
+        std::vector<std::vector<NeighborSet<Scalar>>> regularization_neighborhoods_;
+        std::vector<std::vector<NeighborSet<Scalar>>> prolongation_neighborhoods_;
+    };
+}
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <cmath>
+#include <Eigen/Dense>
+#include <cilantro/data_containers.hpp>
+
+namespace cilantro {
+    namespace internal {
+        // Unit vector orthogonal to v
+        template <typename ScalarT>
+        inline Eigen::Matrix<ScalarT,3,1> anyOrthogonalUnitVector(const Eigen::Matrix<ScalarT,3,1> &v) {
+            if (std::abs(v[0]) > std::abs(v[2])) {
+                return Eigen::Matrix<ScalarT,3,1>(-v[1], v[0], (ScalarT)0.0).normalized();
+            } else {
+                return Eigen::Matrix<ScalarT,3,1>((ScalarT)0.0, -v[2], v[1]).normalized();
+            }
+        }
+
+        // Null vector of the (numerically) rank 2 symmetric mat, as the largest cross product of two of its
+        // rows; returns false if mat has (numerically) rank 1 or 0
+        template <typename ScalarT>
+        inline bool symmetricNullVector3(const Eigen::Matrix<ScalarT,3,3> &mat, Eigen::Matrix<ScalarT,3,1> &vec) {
+            const Eigen::Matrix<ScalarT,3,1> c01 = mat.col(0).cross(mat.col(1));
+            const Eigen::Matrix<ScalarT,3,1> c02 = mat.col(0).cross(mat.col(2));
+            const Eigen::Matrix<ScalarT,3,1> c12 = mat.col(1).cross(mat.col(2));
+            const ScalarT n01 = c01.squaredNorm(), n02 = c02.squaredNorm(), n12 = c12.squaredNorm();
+
+            ScalarT max_norm;
+            if (n01 >= n02 && n01 >= n12) {
+                vec = c01;
+                max_norm = n01;
+            } else if (n02 >= n12) {
+                vec = c02;
+                max_norm = n02;
+            } else {
+                vec = c12;
+                max_norm = n12;
+            }
+
+            // Cross products of rank 1 rows are rounding noise of the order of eps*|mat|^2
+            const ScalarT noise = (ScalarT)8.0*std::numeric_limits<ScalarT>::epsilon()*mat.squaredNorm();
+            if (!(max_norm > noise*noise)) return false;
+            vec /= std::sqrt(max_norm);
+            return true;
+        }
+
+        // Closed-form eigen-decomposition of a symmetric 2x2 matrix
+        template <typename ScalarT>
+        bool computeSymmetricEigenDecomposition2(const Eigen::Matrix<ScalarT,2,2> &mat,
+                                                 Eigen::Matrix<ScalarT,2,1> &eigenvalues,
+                                                 Eigen::Matrix<ScalarT,2,2> &eigenvectors)
+        {
+            const ScalarT half_trace = (ScalarT)0.5*(mat(0,0) + mat(1,1));
+            const ScalarT half_diff = (ScalarT)0.5*(mat(0,0) - mat(1,1));
+            const ScalarT radius = std::sqrt(half_diff*half_diff + mat(1,0)*mat(1,0));
+            eigenvalues[0] = half_trace - radius;
+            eigenvalues[1] = half_trace + radius;
+
+            // Null vector of mat - eigenvalues[0]*I: the larger of its two (orthogonal) rows, rotated by 90 degrees
+            const ScalarT d0 = half_diff + radius, d1 = radius - half_diff;
+            if (d0 >= d1) {
+                eigenvectors.col(0) << -mat(1,0), d0;
+            } else {
+                eigenvectors.col(0) << d1, -mat(1,0);
+            }
+            const ScalarT norm = eigenvectors.col(0).norm();
+            if (norm > (ScalarT)0.0) {
+                eigenvectors.col(0) /= norm;
+            } else {
+                eigenvectors.col(0) << (ScalarT)1.0, (ScalarT)0.0;
+            }
+            eigenvectors.col(1) << -eigenvectors(1,0), eigenvectors(0,0);
+
+            return eigenvalues.allFinite() && eigenvectors.allFinite();
+        }
+
+        // Closed-form eigen-decomposition of a symmetric 3x3 matrix. The eigenvalues of the scaled and shifted
+        // matrix are the trigonometric roots of its characteristic cubic; of these, only the one furthest from
+        // the other two is accurate in the presence of (nearly) repeated eigenvalues. Its eigenvector is computed
+        // as a null vector, and the remaining two eigenpairs from the 2x2 restriction of the matrix to the
+        // orthogonal complement, which is well conditioned. If SmallestOnly and the smallest eigenvalue is the
+        // separated one, only the first eigenvector is set. Returns false on non-finite results.
+        template <bool SmallestOnly, typename ScalarT>
+        bool computeSymmetricEigenDecomposition3(const Eigen::Matrix<ScalarT,3,3> &mat,
+                                                 Eigen::Matrix<ScalarT,3,1> &eigenvalues,
+                                                 Eigen::Matrix<ScalarT,3,3> &eigenvectors)
+        {
+            const ScalarT scale = mat.cwiseAbs().maxCoeff();
+            if (scale == (ScalarT)0.0) {
+                eigenvalues.setZero();
+                eigenvectors.setIdentity();
+                return true;
+            }
+
+            Eigen::Matrix<ScalarT,3,3> a = mat/scale;
+            const ScalarT shift = a.trace()/(ScalarT)3.0;
+            a.diagonal().array() -= shift;
+            const ScalarT off_diag = a(1,0)*a(1,0) + a(2,0)*a(2,0) + a(2,1)*a(2,1);
+            const ScalarT p = std::sqrt((a.diagonal().squaredNorm() + (ScalarT)2.0*off_diag)/(ScalarT)6.0);
+            if (p == (ScalarT)0.0) {
+                eigenvalues.setConstant(scale*shift);
+                eigenvectors.setIdentity();
+                return true;
+            }
+
+            // Roots 2*p*cos(phi + 2*k*pi/3)
+            const ScalarT half_det = (a(0,0)*(a(1,1)*a(2,2) - a(2,1)*a(2,1)) -
+                                      a(1,0)*(a(1,0)*a(2,2) - a(2,1)*a(2,0)) +
+                                      a(2,0)*(a(1,0)*a(2,1) - a(1,1)*a(2,0)))/((ScalarT)2.0*p*p*p);
+            const ScalarT phi = std::acos(std::min(std::max(half_det, (ScalarT)(-1.0)), (ScalarT)1.0))/(ScalarT)3.0;
+            const ScalarT cos_phi = std::cos(phi), sin_phi = std::sin(phi);
+            const ScalarT largest = (ScalarT)2.0*p*cos_phi;
+            const ScalarT smallest = -p*(cos_phi + (ScalarT)1.7320508075688772935*sin_phi);
+            const ScalarT middle = -largest - smallest;
+
+            // Separated eigenpair
+            const size_t first = (middle - smallest >= largest - middle) ? 0 : 2;
+            Eigen::Matrix<ScalarT,3,3> a_shifted(a);
+            a_shifted.diagonal().array() -= (first == 0) ? smallest : largest;
+            Eigen::Matrix<ScalarT,3,1> v_first;
+            // Only fails for non-finite input, as the eigenvalue is simple
+            if (!symmetricNullVector3(a_shifted, v_first)) return false;
+            eigenvectors.col(first) = v_first;
+            eigenvalues[first] = v_first.dot(a*v_first);
+
+            if (!SmallestOnly || first != 0) {
+                // Remaining eigenpairs, in the basis (u,w) of the orthogonal complement of v_first
+                Eigen::Matrix<ScalarT,3,2> basis;
+                basis.col(0) = anyOrthogonalUnitVector(v_first);
+                basis.col(1) = v_first.cross(basis.col(0));
+                const Eigen::Matrix<ScalarT,3,2> a_basis = a*basis;
+                Eigen::Matrix<ScalarT,2,2> restricted;
+                restricted(0,0) = basis.col(0).dot(a_basis.col(0));
+                restricted(1,1) = basis.col(1).dot(a_basis.col(1));
+                restricted(1,0) = restricted(0,1) = basis.col(1).dot(a_basis.col(0));
+                Eigen::Matrix<ScalarT,2,1> restricted_eigenvalues;
+                Eigen::Matrix<ScalarT,2,2> restricted_eigenvectors;
+                computeSymmetricEigenDecomposition2(restricted, restricted_eigenvalues, restricted_eigenvectors);
+
+                const size_t offset = (first == 0) ? 1 : 0;
+                eigenvalues.template segment<2>(offset) = restricted_eigenvalues;
+                eigenvectors.template middleCols<2>(offset).noalias() = basis*restricted_eigenvectors;
+                // Right-handed basis
+                if (!SmallestOnly) eigenvectors.col(1) = eigenvectors.col(2).cross(eigenvectors.col(0));
+            } else {
+                eigenvalues[1] = middle;
+                eigenvalues[2] = largest;
+            }
+
+            eigenvalues = scale*(eigenvalues.array() + shift);
+            return eigenvalues.allFinite() && eigenvectors.col(0).allFinite();
+        }
+    }
+
+    // Eigen-decomposition of a symmetric matrix (e.g. a covariance), with eigenvalues in increasing order and
+    // the corresponding eigenvectors as columns. 2x2 and 3x3 matrices are decomposed in closed form, with
+    // Eigen's iterative solver as a fallback if that fails numerically; other sizes use the iterative solver.
+    template <typename ScalarT, ptrdiff_t EigenDim>
+    inline typename std::enable_if<EigenDim == 3,void>::type computeSymmetricEigenDecomposition(const Eigen::Matrix<ScalarT,EigenDim,EigenDim> &mat,
+                                                                                                Vector<ScalarT,EigenDim> &eigenvalues,
+                                                                                                Eigen::Matrix<ScalarT,EigenDim,EigenDim> &eigenvectors)
+    {
+        if (!internal::computeSymmetricEigenDecomposition3<false>(mat, eigenvalues, eigenvectors)) {
+            Eigen::SelfAdjointEigenSolver<Eigen::Matrix<ScalarT,EigenDim,EigenDim>> eig(mat);
+            eigenvalues = eig.eigenvalues();
+            eigenvectors = eig.eigenvectors();
+        }
+    }
+
+    template <typename ScalarT, ptrdiff_t EigenDim>
+    inline typename std::enable_if<EigenDim == 2,void>::type computeSymmetricEigenDecomposition(const Eigen::Matrix<ScalarT,EigenDim,EigenDim> &mat,
+                                                                                                Vector<ScalarT,EigenDim> &eigenvalues,
+                                                                                                Eigen::Matrix<ScalarT,EigenDim,EigenDim> &eigenvectors)
+    {
+        if (!internal::computeSymmetricEigenDecomposition2(mat, eigenvalues, eigenvectors)) {
+            Eigen::SelfAdjointEigenSolver<Eigen::Matrix<ScalarT,EigenDim,EigenDim>> eig(mat);
+            eigenvalues = eig.eigenvalues();
+            eigenvectors = eig.eigenvectors();
+        }
+    }
+
+    template <typename ScalarT, ptrdiff_t EigenDim>
+    inline typename std::enable_if<EigenDim != 2 && EigenDim != 3,void>::type computeSymmetricEigenDecomposition(const Eigen::Matrix<ScalarT,EigenDim,EigenDim> &mat,
+                                                                                                                 Vector<ScalarT,EigenDim> &eigenvalues,
+                                                                                                                 Eigen::Matrix<ScalarT,EigenDim,EigenDim> &eigenvectors)
+    {
+        Eigen::SelfAdjointEigenSolver<Eigen::Matrix<ScalarT,EigenDim,EigenDim>> eig(mat);
+        eigenvalues = eig.eigenvalues();
+        eigenvectors = eig.eigenvectors();
+    }
+
+    // Smallest eigenvalue of a symmetric matrix and its eigenvector (for a covariance, the normal of the
+    // best fitting hyperplane); cheaper than the full decomposition in the 3x3 case
+    template <typename ScalarT, ptrdiff_t EigenDim>
+    inline typename std::enable_if<EigenDim == 3,void>::type computeSymmetricSmallestEigenPair(const Eigen::Matrix<ScalarT,EigenDim,EigenDim> &mat,
+                                                                                               ScalarT &eigenvalue,
+                                                                                               Eigen::Ref<Vector<ScalarT,EigenDim>> eigenvector)
+    {
+        Vector<ScalarT,EigenDim> eigenvalues;
+        Eigen::Matrix<ScalarT,EigenDim,EigenDim> eigenvectors;
+        if (!internal::computeSymmetricEigenDecomposition3<true>(mat, eigenvalues, eigenvectors)) {
+            Eigen::SelfAdjointEigenSolver<Eigen::Matrix<ScalarT,EigenDim,EigenDim>> eig(mat);
+            eigenvalues = eig.eigenvalues();
+            eigenvectors = eig.eigenvectors();
+        }
+        eigenvalue = eigenvalues[0];
+        eigenvector = eigenvectors.col(0);
+    }
+
+    template <typename ScalarT, ptrdiff_t EigenDim>
+    inline typename std::enable_if<EigenDim != 3,void>::type computeSymmetricSmallestEigenPair(const Eigen::Matrix<ScalarT,EigenDim,EigenDim> &mat,
+                                                                                               ScalarT &eigenvalue,
+                                                                                               Eigen::Ref<Vector<ScalarT,EigenDim>> eigenvector)
+    {
+        Vector<ScalarT,EigenDim> eigenvalues;
+        Eigen::Matrix<ScalarT,EigenDim,EigenDim> eigenvectors;
+        computeSymmetricEigenDecomposition<ScalarT,EigenDim>(mat, eigenvalues, eigenvectors);
+        eigenvalue = eigenvalues[0];
+        eigenvector = eigenvectors.col(0);
+    }
+}
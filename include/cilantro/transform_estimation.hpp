@@ -4,6 +4,7 @@
 #include <cilantro/correspondence.hpp>
 #include <cilantro/common_pair_evaluators.hpp>
 #include <cilantro/omp_reductions.hpp>
+#include <cilantro/normal_equation_accumulator.hpp>
 
 namespace cilantro {
     // Rigid, point-to-point, general dimension, closed form, SVD
@@ -130,8 +131,7 @@ namespace cilantro {
             return false;
         }
 
-        Eigen::Matrix<ScalarT,3,3> AtA;
-        Eigen::Matrix<ScalarT,3,1> Atb;
+        internal::SymmetricNormalEquationAccumulator<3,double> normal_eq;
 
         Eigen::Matrix<ScalarT,2,2> rot_mat_iter;
         Eigen::Matrix<ScalarT,3,1> d_theta;
@@ -139,14 +139,12 @@ namespace cilantro {
         size_t iter = 0;
         while (iter < max_iter) {
             // Compute differential
-            AtA.setZero();
-            Atb.setZero();
+            normal_eq.setZero();
 
-#pragma omp parallel reduction (internal::MatrixReductions<ScalarT,3,3>::operator+: AtA) reduction (internal::MatrixReductions<ScalarT,3,1>::operator+: Atb)
+#pragma omp parallel reduction (internal::SymmetricNormalEquationReductions<3,double>::operator+: normal_eq)
             {
                 if (has_point_to_point_terms) {
-                    Eigen::Matrix<ScalarT,3,2,Eigen::RowMajor> eq_vecs;
-                    eq_vecs.template block<2,2>(1, 0).setIdentity();
+                    ScalarT eq_vec[3];
 
 #pragma omp for nowait
                     for (size_t i = 0; i < point_to_point_correspondences.size(); i++) {
@@ -155,19 +153,20 @@ namespace cilantro {
                         const ScalarT weight = point_to_point_weight*point_corr_evaluator(corr.indexInFirst, corr.indexInSecond, corr.value);
                         Vector<ScalarT,2> s = tform*src_p.col(corr.indexInSecond);
 
-                        eq_vecs(0,0) = -s[1];
-                        eq_vecs(0,1) = s[0];
+                        eq_vec[0] = -s[1];
+                        eq_vec[1] = (ScalarT)1.0;
+                        eq_vec[2] = (ScalarT)0.0;
+                        normal_eq.addEquation(eq_vec, d[0] - s[0], weight);
 
-                        Eigen::Matrix<ScalarT,3,3> AtA_priv((weight*eq_vecs)*eq_vecs.transpose());
-                        Eigen::Matrix<ScalarT,3,1> Atb_priv(eq_vecs*(weight*(d - s)));
-
-                        AtA += AtA_priv;
-                        Atb += Atb_priv;
+                        eq_vec[0] = s[0];
+                        eq_vec[1] = (ScalarT)0.0;
+                        eq_vec[2] = (ScalarT)1.0;
+                        normal_eq.addEquation(eq_vec, d[1] - s[1], weight);
                     }
                 }
 
                 if (has_point_to_plane_terms) {
-                    Eigen::Matrix<ScalarT,3,1> eq_vec;
+                    ScalarT eq_vec[3];
 
 #pragma omp for nowait
                     for (size_t i = 0; i < point_to_plane_correspondences.size(); i++) {
@@ -177,20 +176,15 @@ namespace cilantro {
                         const ScalarT weight = point_to_plane_weight*plane_corr_evaluator(corr.indexInFirst, corr.indexInSecond, corr.value);
                         Vector<ScalarT,2> s = tform*src_p.col(corr.indexInSecond);
 
-                        eq_vec(0) = s[0]*n[1] - s[1]*n[0];
-                        eq_vec(1) = n[0];
-                        eq_vec(2) = n[1];
-
-                        Eigen::Matrix<ScalarT,3,3> AtA_priv((weight*eq_vec)*eq_vec.transpose());
-                        Eigen::Matrix<ScalarT,3,1> Atb_priv((weight*(n.dot(d - s)))*eq_vec);
-
-                        AtA += AtA_priv;
-                        Atb += Atb_priv;
+                        eq_vec[0] = s[0]*n[1] - s[1]*n[0];
+                        eq_vec[1] = n[0];
+                        eq_vec[2] = n[1];
+                        normal_eq.addEquation(eq_vec, n.dot(d - s), weight);
                     }
                 }
             }
 
-            d_theta.noalias() = AtA.ldlt().solve(Atb);
+            normal_eq.solve(d_theta);
 
             // Update estimate
             rot_mat_iter.noalias() = Eigen::Rotation2D<ScalarT>(d_theta[0]).toRotationMatrix();
@@ -237,8 +231,7 @@ namespace cilantro {
             return false;
         }
 
-        Eigen::Matrix<ScalarT,6,6> AtA;
-        Eigen::Matrix<ScalarT,6,1> Atb;
+        internal::SymmetricNormalEquationAccumulator<6,double> normal_eq;
 
         Eigen::Matrix<ScalarT,3,3> rot_mat_iter;
         Eigen::Matrix<ScalarT,6,1> d_theta;
@@ -246,14 +239,12 @@ namespace cilantro {
         size_t iter = 0;
         while (iter < max_iter) {
             // Compute differential
-            AtA.setZero();
-            Atb.setZero();
+            normal_eq.setZero();
 
-#pragma omp parallel reduction (internal::MatrixReductions<ScalarT,6,6>::operator+: AtA) reduction (internal::MatrixReductions<ScalarT,6,1>::operator+: Atb)
+#pragma omp parallel reduction (internal::SymmetricNormalEquationReductions<6,double>::operator+: normal_eq)
             {
                 if (has_point_to_point_terms) {
-                    Eigen::Matrix<ScalarT,6,3,Eigen::RowMajor> eq_vecs;
-                    eq_vecs.template block<3,3>(3, 0).setIdentity();
+                    ScalarT eq_vec[6];
 
 #pragma omp for nowait
                     for (size_t i = 0; i < point_to_point_correspondences.size(); i++) {
@@ -262,28 +253,33 @@ namespace cilantro {
                         const ScalarT weight = point_to_point_weight*point_corr_evaluator(corr.indexInFirst, corr.indexInSecond, corr.value);
                         Vector<ScalarT,3> s = tform*src_p.col(corr.indexInSecond);
 
-                        eq_vecs(0,0) = (ScalarT)0.0;
-                        eq_vecs(0,1) = -s[2];
-                        eq_vecs(0,2) = s[1];
-
-                        eq_vecs(1,0) = s[2];
-                        eq_vecs(1,1) = (ScalarT)0.0;
-                        eq_vecs(1,2) = -s[0];
-
-                        eq_vecs(2,0) = -s[1];
-                        eq_vecs(2,1) = s[0];
-                        eq_vecs(2,2) = (ScalarT)0.0;
-
-                        Eigen::Matrix<ScalarT,6,6> AtA_priv((weight*eq_vecs)*eq_vecs.transpose());
-                        Eigen::Matrix<ScalarT,6,1> Atb_priv(eq_vecs*(weight*(d - s)));
-
-                        AtA += AtA_priv;
-                        Atb += Atb_priv;
+                        // One equation per residual coordinate (rows of the skew-symmetric Jacobian)
+                        eq_vec[0] = (ScalarT)0.0;
+                        eq_vec[1] = s[2];
+                        eq_vec[2] = -s[1];
+                        eq_vec[3] = (ScalarT)1.0;
+                        eq_vec[4] = (ScalarT)0.0;
+                        eq_vec[5] = (ScalarT)0.0;
+                        normal_eq.addEquation(eq_vec, d[0] - s[0], weight);
+
+                        eq_vec[0] = -s[2];
+                        eq_vec[1] = (ScalarT)0.0;
+                        eq_vec[2] = s[0];
+                        eq_vec[3] = (ScalarT)0.0;
+                        eq_vec[4] = (ScalarT)1.0;
+                        normal_eq.addEquation(eq_vec, d[1] - s[1], weight);
+
+                        eq_vec[0] = s[1];
+                        eq_vec[1] = -s[0];
+                        eq_vec[2] = (ScalarT)0.0;
+                        eq_vec[4] = (ScalarT)0.0;
+                        eq_vec[5] = (ScalarT)1.0;
+                        normal_eq.addEquation(eq_vec, d[2] - s[2], weight);
                     }
                 }
 
                 if (has_point_to_plane_terms) {
-                    Eigen::Matrix<ScalarT,6,1> eq_vec;
+                    ScalarT eq_vec[6];
 
 #pragma omp for nowait
                     for (size_t i = 0; i < point_to_plane_correspondences.size(); i++) {
@@ -293,23 +289,18 @@ namespace cilantro {
                         const ScalarT weight = point_to_plane_weight*plane_corr_evaluator(corr.indexInFirst, corr.indexInSecond, corr.value);
                         Vector<ScalarT,3> s = tform*src_p.col(corr.indexInSecond);
 
-                        eq_vec(0) = (n[2]*s[1] - n[1]*s[2]);
-                        eq_vec(1) = (n[0]*s[2] - n[2]*s[0]);
-                        eq_vec(2) = (n[1]*s[0] - n[0]*s[1]);
-                        eq_vec(3) = n[0];
-                        eq_vec(4) = n[1];
-                        eq_vec(5) = n[2];
-
-                        Eigen::Matrix<ScalarT,6,6> AtA_priv((weight*eq_vec)*eq_vec.transpose());
-                        Eigen::Matrix<ScalarT,6,1> Atb_priv((weight*(n.dot(d - s)))*eq_vec);
-
-                        AtA += AtA_priv;
-                        Atb += Atb_priv;
+                        eq_vec[0] = (n[2]*s[1] - n[1]*s[2]);
+                        eq_vec[1] = (n[0]*s[2] - n[2]*s[0]);
+                        eq_vec[2] = (n[1]*s[0] - n[0]*s[1]);
+                        eq_vec[3] = n[0];
+                        eq_vec[4] = n[1];
+                        eq_vec[5] = n[2];
+                        normal_eq.addEquation(eq_vec, n.dot(d - s), weight);
                     }
                 }
             }
 
-            d_theta.noalias() = AtA.ldlt().solve(Atb);
+            normal_eq.solve(d_theta);
 
             // Update estimate
             rot_mat_iter.noalias() = (Eigen::AngleAxis<ScalarT>(d_theta[2], Eigen::Matrix<ScalarT,3,1>::UnitZ()) *
@@ -5,8 +5,19 @@
 #include <cilantro/nearest_neighbors.hpp>
 #include <cilantro/correspondence.hpp>
 #include <cilantro/common_pair_evaluators.hpp>
+#include <cilantro/block_amd_ordering.hpp>
+#include <cilantro/block_diagonal_preconditioner.hpp>
+#include <cilantro/multilevel_preconditioner.hpp>
+#include <cilantro/sparse_normal_equation_operator.hpp>
+#include <cilantro/sparse_normal_equation_product.hpp>
 
 namespace cilantro {
+    // Preconditioner of the conjugate gradient solver used in the Gauss-Newton steps of warp field estimation;
+    // BLOCK_JACOBI inverts the per-node (6x6 for rigid 3D, 12x12 for affine 3D) diagonal blocks; MULTILEVEL
+    // runs a V-cycle over a node hierarchy (see WarpFieldLinearSolver::setProlongationOperators) and reduces
+    // to BLOCK_JACOBI if no hierarchy is given (always the case for dense warp fields, whose ICP rejects it)
+    enum struct ConjugateGradientPreconditioner {DIAGONAL, BLOCK_JACOBI, MULTILEVEL};
+
     namespace internal {
         template <typename ScalarT>
         inline ScalarT sqrtHuberLoss(ScalarT x, ScalarT delta = (ScalarT)1.0) {
@@ -90,8 +101,360 @@ namespace cilantro {
             d_rot_coeffs_dc(1,2) = (ScalarT)0.0;
             d_rot_coeffs_dc(2,2) = (ScalarT)0.0;
         }
+
+        // The Jacobian structure (inner indices) only depends on correspondences and neighborhoods; it is written
+        // once per estimation call, after which Gauss-Newton iterations only refill the values.
+        // local_indices[e] lists the unknowns (relative to a node's first unknown) that equation e of a
+        // correspondence depends on, per node.
+
+        // All local unknowns, for each of num_equations equations
+        inline std::vector<std::vector<size_t>> getNodeBlockLocalIndices(size_t block_size, size_t num_equations) {
+            std::vector<size_t> block(block_size);
+            for (size_t k = 0; k < block_size; k++) block[k] = k;
+            return std::vector<std::vector<size_t>>(num_equations, block);
+        }
+
+        // Dense warp fields: each correspondence involves its source point's node only
+        template <typename CorrScalarT, typename StorageIndexT>
+        void setDataTermJacobianStructure(const CorrespondenceSet<CorrScalarT> &correspondences,
+                                          size_t block_size,
+                                          const std::vector<std::vector<size_t>> &local_indices,
+                                          const StorageIndexT * outer_ptr,
+                                          StorageIndexT * inner_ind)
+        {
+            const size_t num_eq = local_indices.size();
+#pragma omp parallel for
+            for (size_t i = 0; i < correspondences.size(); i++) {
+                const size_t offset = block_size*correspondences[i].indexInSecond;
+                for (size_t e = 0; e < num_eq; e++) {
+                    StorageIndexT * eq_inner_ind = inner_ind + outer_ptr[num_eq*i + e];
+                    for (size_t l = 0; l < local_indices[e].size(); l++) {
+                        eq_inner_ind[l] = offset + local_indices[e][l];
+                    }
+                }
+            }
+        }
+
+        // Sparse warp fields: each correspondence involves the (sorted) control nodes of its source point
+        template <typename CorrScalarT, typename NeighborScalarT, typename StorageIndexT>
+        void setDataTermJacobianStructure(const CorrespondenceSet<CorrScalarT> &correspondences,
+                                          const std::vector<NeighborSet<NeighborScalarT>> &src_to_ctrl_neighborhoods,
+                                          size_t block_size,
+                                          const std::vector<std::vector<size_t>> &local_indices,
+                                          const StorageIndexT * outer_ptr,
+                                          StorageIndexT * inner_ind)
+        {
+            const size_t num_eq = local_indices.size();
+#pragma omp parallel for
+            for (size_t i = 0; i < correspondences.size(); i++) {
+                const auto& ctrl_neighbors = src_to_ctrl_neighborhoods[correspondences[i].indexInSecond];
+                for (size_t e = 0; e < num_eq; e++) {
+                    StorageIndexT * eq_inner_ind = inner_ind + outer_ptr[num_eq*i + e];
+                    for (size_t j = 0; j < ctrl_neighbors.size(); j++) {
+                        const size_t offset = block_size*ctrl_neighbors[j].index;
+                        for (size_t l = 0; l < local_indices[e].size(); l++) {
+                            *(eq_inner_ind++) = offset + local_indices[e][l];
+                        }
+                    }
+                }
+            }
+        }
+
+        // Each regularization arc contributes block_size equations, coupling the same unknown of its two nodes
+        template <typename NeighborScalarT, typename StorageIndexT>
+        void setRegularizationJacobianStructure(const std::vector<NeighborSet<NeighborScalarT>> &regularization_neighborhoods,
+                                                const std::vector<size_t> &reg_eq_ind,
+                                                size_t block_size,
+                                                StorageIndexT * inner_ind)
+        {
+#pragma omp parallel for
+            for (size_t i = 0; i < regularization_neighborhoods.size(); i++) {
+                const auto& neighbors = regularization_neighborhoods[i];
+                StorageIndexT * arc_inner_ind = inner_ind + 2*reg_eq_ind[i];
+                for (size_t j = 1; j < neighbors.size(); j++) {
+                    size_t s_offset = block_size*neighbors[0].index;
+                    size_t n_offset = block_size*neighbors[j].index;
+                    if (n_offset < s_offset) std::swap(s_offset, n_offset);
+                    for (size_t eq = 0; eq < block_size; eq++) {
+                        *(arc_inner_ind++) = s_offset + eq;
+                        *(arc_inner_ind++) = n_offset + eq;
+                    }
+                }
+            }
+        }
     }
 
+    // Linear solver used in the Gauss-Newton steps of warp field estimation. SPARSE_LDLT factorizes the normal
+    // equations directly; its symbolic analysis is kept across solves as long as the sparsity pattern allows.
+    enum struct WarpFieldLinearSolverType {CONJUGATE_GRADIENT, SPARSE_LDLT};
+
+    // Solves the Gauss-Newton step At*At^T*delta = At*b; BlockSize is the number of unknowns per node.
+    // CG runs either on the assembled At*At^T or matrix-free (see SparseNormalEquationOperator); At*At^T is
+    // assembled in parallel, on a pattern kept for as long as the structure of At stays the same. The direct
+    // solver orders the unknowns by AMD on the node graph and analyzes a pattern that is the union of all
+    // patterns seen so far, so that new correspondences rarely trigger a new symbolic factorization.
+    // An instance may be kept alive across estimation calls (e.g. ICP iterations) to reuse that analysis.
+    // CG can optionally be warm-started from the previous step (scaled to minimize the quadratic model along
+    // it) and run to an adaptive Eisenstat-Walker tolerance, bounded below by the configured tolerance.
+    template <typename ScalarT, ptrdiff_t BlockSize>
+    class WarpFieldLinearSolver {
+    public:
+        // The remaining parameters (preconditioner, matrix-free products, CG settings) are set by name
+        explicit WarpFieldLinearSolver(WarpFieldLinearSolverType solver_type = WarpFieldLinearSolverType::CONJUGATE_GRADIENT)
+                : solver_type_(solver_type), preconditioner_(ConjugateGradientPreconditioner::DIAGONAL), matrix_free_(false),
+                  warm_start_(false), adaptive_tolerance_(false), cg_pattern_analyzed_(false),
+                  num_iterations_(0), num_symbolic_factorizations_(0),
+                  prev_gradient_norm_((ScalarT)0.0)
+        {
+            setMaxNumberOfIterations(1000).setConvergenceTolerance((ScalarT)1e-5);
+        }
+
+        inline WarpFieldLinearSolverType getSolverType() const { return solver_type_; }
+
+        inline WarpFieldLinearSolver& setSolverType(WarpFieldLinearSolverType solver_type) {
+            solver_type_ = solver_type;
+            cg_pattern_analyzed_ = false;
+            return *this;
+        }
+
+        inline ConjugateGradientPreconditioner getPreconditioner() const { return preconditioner_; }
+
+        inline WarpFieldLinearSolver& setPreconditioner(ConjugateGradientPreconditioner preconditioner) {
+            preconditioner_ = preconditioner;
+            cg_pattern_analyzed_ = false;
+            return *this;
+        }
+
+        inline bool getMatrixFree() const { return matrix_free_; }
+
+        // If set, CG runs on a matrix-free normal equations operator (lower memory, parallel products)
+        inline WarpFieldLinearSolver& setMatrixFree(bool matrix_free) {
+            matrix_free_ = matrix_free;
+            cg_pattern_analyzed_ = false;
+            return *this;
+        }
+
+        inline size_t getMaxNumberOfIterations() const { return max_iter_; }
+
+        // CG iteration cap per solve
+        WarpFieldLinearSolver& setMaxNumberOfIterations(size_t max_iter) {
+            max_iter_ = max_iter;
+            diagonal_solver_.setMaxIterations(max_iter);
+            block_jacobi_solver_.setMaxIterations(max_iter);
+            matrix_free_diagonal_solver_.setMaxIterations(max_iter);
+            matrix_free_block_jacobi_solver_.setMaxIterations(max_iter);
+            multilevel_solver_.setMaxIterations(max_iter);
+            matrix_free_multilevel_solver_.setMaxIterations(max_iter);
+            return *this;
+        }
+
+        inline ScalarT getConvergenceTolerance() const { return conv_tol_; }
+
+        // CG relative residual tolerance (set per solve, as it may be adaptive)
+        inline WarpFieldLinearSolver& setConvergenceTolerance(ScalarT conv_tol) {
+            conv_tol_ = conv_tol;
+            return *this;
+        }
+
+        inline const std::vector<Eigen::SparseMatrix<ScalarT>>& getProlongationOperators() const {
+            return multilevel_solver_.preconditioner().getProlongationOperators();
+        }
+
+        // Node hierarchy of the MULTILEVEL preconditioner: prolongations[l] maps level l+1 unknowns to level l
+        // unknowns, level 0 being the unknowns of the solved system (see SparseWarpFieldHierarchy)
+        inline WarpFieldLinearSolver& setProlongationOperators(const std::vector<Eigen::SparseMatrix<ScalarT>> &prolongations) {
+            multilevel_solver_.preconditioner().setProlongationOperators(prolongations);
+            matrix_free_multilevel_solver_.preconditioner().setProlongationOperators(prolongations);
+            return *this;
+        }
+
+        inline bool getWarmStart() const { return warm_start_; }
+
+        inline WarpFieldLinearSolver& setWarmStart(bool warm_start) {
+            warm_start_ = warm_start;
+            return *this;
+        }
+
+        inline bool getAdaptiveTolerance() const { return adaptive_tolerance_; }
+
+        inline WarpFieldLinearSolver& setAdaptiveTolerance(bool adaptive_tolerance) {
+            adaptive_tolerance_ = adaptive_tolerance;
+            return *this;
+        }
+
+        // Drops all cached symbolic information and warm start state (to be called when the problem structure changes)
+        WarpFieldLinearSolver& reset() {
+            cg_pattern_analyzed_ = false;
+            ldlt_pattern_.resize(0,0);
+            prev_delta_.resize(0);
+            prev_gradient_norm_ = (ScalarT)0.0;
+            return *this;
+        }
+
+        void solve(const Eigen::SparseMatrix<ScalarT> &At,
+                   const Eigen::Matrix<ScalarT,Eigen::Dynamic,1> &b,
+                   Eigen::Matrix<ScalarT,Eigen::Dynamic,1> &delta)
+        {
+            Atb_.noalias() = At*b;
+
+            if (solver_type_ == WarpFieldLinearSolverType::SPARSE_LDLT) {
+                const Eigen::SparseMatrix<ScalarT> &AtA = AtA_product_.compute(At);
+                // Fall back to CG if the factorization fails (e.g. unconstrained nodes)
+                if (!solve_direct_(AtA, delta)) solve_assembled_cg_(AtA, delta);
+            } else if (matrix_free_) {
+                AtA_op_.setJacobianTranspose(At);
+                switch (preconditioner_) {
+                    case ConjugateGradientPreconditioner::DIAGONAL:
+                        solve_cg_(matrix_free_diagonal_solver_, AtA_op_, delta);
+                        break;
+                    case ConjugateGradientPreconditioner::BLOCK_JACOBI:
+                        solve_cg_(matrix_free_block_jacobi_solver_, AtA_op_, delta);
+                        break;
+                    case ConjugateGradientPreconditioner::MULTILEVEL:
+                        solve_cg_(matrix_free_multilevel_solver_, AtA_op_, delta);
+                        break;
+                }
+            } else {
+                solve_assembled_cg_(AtA_product_.compute(At), delta);
+            }
+        }
+
+        // Total number of CG iterations over all solve() calls
+        inline size_t getNumberOfPerformedIterations() const { return num_iterations_; }
+
+        // Total number of symbolic analyses performed by the direct solver
+        inline size_t getNumberOfSymbolicFactorizations() const { return num_symbolic_factorizations_; }
+
+    private:
+        typedef typename Eigen::SparseMatrix<ScalarT>::StorageIndex StorageIndex;
+
+        WarpFieldLinearSolverType solver_type_;
+        ConjugateGradientPreconditioner preconditioner_;
+        bool matrix_free_;
+        size_t max_iter_;
+        ScalarT conv_tol_;
+        bool warm_start_;
+        bool adaptive_tolerance_;
+        // Whether the currently selected CG solver has analyzed the pattern (cleared when the selection changes)
+        bool cg_pattern_analyzed_;
+        size_t num_iterations_;
+        size_t num_symbolic_factorizations_;
+
+        // Warm start and forcing term state
+        Eigen::Matrix<ScalarT,Eigen::Dynamic,1> prev_delta_;
+        Eigen::Matrix<ScalarT,Eigen::Dynamic,1> AtA_prev_delta_;
+        ScalarT prev_gradient_norm_;
+
+        SparseNormalEquationProduct<ScalarT> AtA_product_;
+        SparseNormalEquationOperator<ScalarT> AtA_op_;
+        Eigen::Matrix<ScalarT,Eigen::Dynamic,1> Atb_;
+
+        Eigen::ConjugateGradient<Eigen::SparseMatrix<ScalarT>,Eigen::Lower|Eigen::Upper,Eigen::DiagonalPreconditioner<ScalarT>> diagonal_solver_;
+        Eigen::ConjugateGradient<Eigen::SparseMatrix<ScalarT>,Eigen::Lower|Eigen::Upper,BlockDiagonalPreconditioner<ScalarT,BlockSize>> block_jacobi_solver_;
+        Eigen::ConjugateGradient<SparseNormalEquationOperator<ScalarT>,Eigen::Lower|Eigen::Upper,BlockDiagonalPreconditioner<ScalarT,1>> matrix_free_diagonal_solver_;
+        Eigen::ConjugateGradient<SparseNormalEquationOperator<ScalarT>,Eigen::Lower|Eigen::Upper,BlockDiagonalPreconditioner<ScalarT,BlockSize>> matrix_free_block_jacobi_solver_;
+        Eigen::ConjugateGradient<Eigen::SparseMatrix<ScalarT>,Eigen::Lower|Eigen::Upper,MultilevelPreconditioner<ScalarT,BlockSize>> multilevel_solver_;
+        Eigen::ConjugateGradient<SparseNormalEquationOperator<ScalarT>,Eigen::Lower|Eigen::Upper,MultilevelPreconditioner<ScalarT,BlockSize>> matrix_free_multilevel_solver_;
+
+        // Zero-valued matrix holding the pattern the direct solver was analyzed for, and AtA padded to it
+        Eigen::SparseMatrix<ScalarT> ldlt_pattern_;
+        Eigen::SparseMatrix<ScalarT> AtA_;
+        Eigen::SimplicialLDLT<Eigen::SparseMatrix<ScalarT>,Eigen::Lower,BlockAMDOrdering<StorageIndex,BlockSize>> ldlt_solver_;
+
+        template <class SolverT, class MatrixT>
+        inline void solve_cg_(SolverT &solver, const MatrixT &AtA, Eigen::Matrix<ScalarT,Eigen::Dynamic,1> &delta) {
+            if (!cg_pattern_analyzed_) {
+                solver.analyzePattern(AtA);
+                cg_pattern_analyzed_ = true;
+            }
+            solver.factorize(AtA);
+            solver.setTolerance(adaptive_tolerance_ ? get_forcing_term_() : conv_tol_);
+
+            ScalarT scale = (ScalarT)0.0;
+            if (warm_start_ && prev_delta_.size() == Atb_.size()) {
+                // Minimizer of the quadratic model along the previous step
+                AtA_prev_delta_.noalias() = AtA*prev_delta_;
+                const ScalarT curvature = prev_delta_.dot(AtA_prev_delta_);
+                if (curvature > (ScalarT)0.0) scale = prev_delta_.dot(Atb_)/curvature;
+            }
+            if (scale > (ScalarT)0.0) {
+                delta = solver.solveWithGuess(Atb_, scale*prev_delta_);
+            } else {
+                delta = solver.solve(Atb_);
+            }
+            num_iterations_ += solver.iterations();
+
+            if (warm_start_) prev_delta_ = delta;
+        }
+
+        // Eisenstat-Walker (choice 2) relative tolerance, using the normal equations right hand side (the
+        // gradient) as the nonlinear residual. The cap is much tighter than the textbook 0.9: looser solves
+        // shrink the ICP steps enough to trigger premature convergence.
+        ScalarT get_forcing_term_() {
+            const ScalarT max_forcing_term = (ScalarT)0.01;
+            const ScalarT gamma = (ScalarT)0.9;
+            const ScalarT gradient_norm = Atb_.norm();
+
+            ScalarT forcing_term = max_forcing_term;
+            if (prev_gradient_norm_ > (ScalarT)0.0) {
+                const ScalarT ratio = gradient_norm/prev_gradient_norm_;
+                forcing_term = gamma*ratio*ratio;
+            }
+            forcing_term = std::max(conv_tol_, std::min(max_forcing_term, forcing_term));
+
+            prev_gradient_norm_ = gradient_norm;
+            return forcing_term;
+        }
+
+        inline void solve_assembled_cg_(const Eigen::SparseMatrix<ScalarT> &AtA, Eigen::Matrix<ScalarT,Eigen::Dynamic,1> &delta) {
+            switch (preconditioner_) {
+                case ConjugateGradientPreconditioner::DIAGONAL:
+                    solve_cg_(diagonal_solver_, AtA, delta);
+                    break;
+                case ConjugateGradientPreconditioner::BLOCK_JACOBI:
+                    solve_cg_(block_jacobi_solver_, AtA, delta);
+                    break;
+                case ConjugateGradientPreconditioner::MULTILEVEL:
+                    solve_cg_(multilevel_solver_, AtA, delta);
+                    break;
+            }
+        }
+
+        bool solve_direct_(const Eigen::SparseMatrix<ScalarT> &AtA, Eigen::Matrix<ScalarT,Eigen::Dynamic,1> &delta) {
+            bool analyze = false;
+            if (ldlt_pattern_.rows() != AtA.rows()) {
+                // Start from full diagonal node blocks, which data terms fill in as correspondences come and go
+                std::vector<Eigen::Triplet<ScalarT,StorageIndex>> block_entries;
+                block_entries.reserve(BlockSize*AtA.rows());
+                const StorageIndex num_blocks = (StorageIndex)(AtA.rows()/BlockSize);
+                for (StorageIndex k = 0; k < num_blocks; k++) {
+                    for (StorageIndex j = 0; j < BlockSize; j++) {
+                        for (StorageIndex i = 0; i < BlockSize; i++) {
+                            block_entries.emplace_back(BlockSize*k + i, BlockSize*k + j, (ScalarT)0.0);
+                        }
+                    }
+                }
+                ldlt_pattern_.resize(AtA.rows(), AtA.cols());
+                ldlt_pattern_.setFromTriplets(block_entries.begin(), block_entries.end());
+                analyze = true;
+            }
+
+            // Pad AtA with explicit zeros to the analyzed pattern; a larger union means AtA has new entries
+            AtA_ = AtA + ldlt_pattern_;
+            if (analyze || AtA_.nonZeros() != ldlt_pattern_.nonZeros()) {
+                ldlt_pattern_ = AtA_;
+                ldlt_pattern_.coeffs().setZero();
+                ldlt_solver_.analyzePattern(AtA_);
+                num_symbolic_factorizations_++;
+            }
+
+            ldlt_solver_.factorize(AtA_);
+            if (ldlt_solver_.info() != Eigen::Success) return false;
+            delta = ldlt_solver_.solve(Atb_);
+            return true;
+        }
+    };
+
     // Locally rigid dense warp field, 2D
     template <class TransformT, class PointCorrWeightEvaluatorT = UnityWeightEvaluator<typename TransformT::Scalar,typename TransformT::Scalar>, class PlaneCorrWeightEvaluatorT = UnityWeightEvaluator<typename TransformT::Scalar,typename TransformT::Scalar>, class RegWeightEvaluatorT = UnityWeightEvaluator<typename TransformT::Scalar,typename TransformT::Scalar>>
     typename std::enable_if<int(TransformT::Mode) == int(Eigen::Isometry) && TransformT::Dim == 2,bool>::type
@@ -112,7 +475,8 @@ namespace cilantro {
                                          typename TransformT::Scalar cg_conv_tol = (typename TransformT::Scalar)1e-5,
                                          const PointCorrWeightEvaluatorT &point_corr_evaluator = PointCorrWeightEvaluatorT(),
                                          const PlaneCorrWeightEvaluatorT &plane_corr_evaluator = PlaneCorrWeightEvaluatorT(),
-                                         const RegWeightEvaluatorT &reg_evaluator = RegWeightEvaluatorT())
+                                         const RegWeightEvaluatorT &reg_evaluator = RegWeightEvaluatorT(),
+                                         WarpFieldLinearSolver<typename TransformT::Scalar,3> * linear_solver = NULL)
     {
         typedef typename TransformT::Scalar ScalarT;
 
@@ -166,8 +530,15 @@ namespace cilantro {
                 outer_ptr[num_data_term_equations + i] = 3*num_data_term_equations + 2*i;
             }
         }
-        // Inner indices
+        // Inner indices (fixed for the given correspondences; Gauss-Newton iterations only refill values)
         typename Eigen::SparseMatrix<ScalarT>::StorageIndex * const inner_ind = At.innerIndexPtr();
+        if (has_point_to_point_terms) {
+            internal::setDataTermJacobianStructure(point_to_point_correspondences, 3, internal::getNodeBlockLocalIndices(3, 2), outer_ptr, inner_ind);
+        }
+        if (has_point_to_plane_terms) {
+            internal::setDataTermJacobianStructure(point_to_plane_correspondences, 3, internal::getNodeBlockLocalIndices(3, 1), outer_ptr + num_point_to_point_equations, inner_ind);
+        }
+        internal::setRegularizationJacobianStructure(regularization_neighborhoods, reg_eq_ind, 3, inner_ind + outer_ptr[num_data_term_equations]);
 
         // Vector of (negative) residuals
         Eigen::Matrix<ScalarT,Eigen::Dynamic,1> b(num_equations);
@@ -175,15 +546,11 @@ namespace cilantro {
         // Vector of unknowns (rotation angle and translation offsets per point)
         Eigen::Matrix<ScalarT,Eigen::Dynamic,1> tforms_vec(Eigen::Matrix<ScalarT,Eigen::Dynamic,1>::Zero(num_unknowns, 1));
 
-        // Conjugate Gradient solver
-//        Eigen::ConjugateGradient<Eigen::SparseMatrix<ScalarT>,Eigen::Lower|Eigen::Upper,Eigen::IncompleteCholesky<ScalarT,Eigen::Lower|Eigen::Upper>> solver;
-//        Eigen::ConjugateGradient<Eigen::SparseMatrix<ScalarT>,Eigen::Lower|Eigen::Upper,Eigen::IdentityPreconditioner> solver;
-        Eigen::ConjugateGradient<Eigen::SparseMatrix<ScalarT>,Eigen::Lower|Eigen::Upper,Eigen::DiagonalPreconditioner<ScalarT>> solver;
-        solver.setMaxIterations(max_cg_iter);
-        solver.setTolerance(cg_conv_tol);
-
-        Eigen::SparseMatrix<ScalarT> AtA;
-        Eigen::Matrix<ScalarT,Eigen::Dynamic,1> Atb;
+        // Gauss-Newton step solver; a caller-provided one brings its configuration (solver type, preconditioner,
+        // matrix-free products, warm start) and carries its symbolic analysis over from previous calls
+        WarpFieldLinearSolver<ScalarT,3> local_solver;
+        WarpFieldLinearSolver<ScalarT,3> &solver = (linear_solver != NULL) ? *linear_solver : local_solver;
+        solver.setMaxNumberOfIterations(max_cg_iter).setConvergenceTolerance(cg_conv_tol);
 
         // Parameters
         const ScalarT point_to_point_weight_sqrt = std::sqrt(point_to_point_weight);
@@ -219,20 +586,14 @@ namespace cilantro {
                         eq_ind = 2*i;
                         nz_ind = 6*i;
 
-                        values[nz_ind] = (-sina*s[0] - cosa*s[1])*weight;
-                        inner_ind[nz_ind++] = offset;
-                        values[nz_ind] = weight;
-                        inner_ind[nz_ind++] = offset + 1;
-                        values[nz_ind] = (ScalarT)0.0;
-                        inner_ind[nz_ind++] = offset + 2;
+                        values[nz_ind++] = (-sina*s[0] - cosa*s[1])*weight;
+                        values[nz_ind++] = weight;
+                        values[nz_ind++] = (ScalarT)0.0;
                         b[eq_ind++] = (d[0] - s_t[0])*weight;
 
-                        values[nz_ind] = (cosa*s[0] - sina*s[1])*weight;
-                        inner_ind[nz_ind++] = offset;
-                        values[nz_ind] = (ScalarT)0.0;
-                        inner_ind[nz_ind++] = offset + 1;
-                        values[nz_ind] = weight;
-                        inner_ind[nz_ind++] = offset + 2;
+                        values[nz_ind++] = (cosa*s[0] - sina*s[1])*weight;
+                        values[nz_ind++] = (ScalarT)0.0;
+                        values[nz_ind++] = weight;
                         b[eq_ind++] = (d[1] - s_t[1])*weight;
                     }
                 }
@@ -255,12 +616,9 @@ namespace cilantro {
                         eq_ind = num_point_to_point_equations + i;
                         nz_ind = 3*num_point_to_point_equations + 3*i;
 
-                        values[nz_ind] = (n[0]*(-sina*s[0] - cosa*s[1]) + n[1]*(cosa*s[0] - sina*s[1]))*weight;
-                        inner_ind[nz_ind++] = offset;
-                        values[nz_ind] = n[0]*weight;
-                        inner_ind[nz_ind++] = offset + 1;
-                        values[nz_ind] = n[1]*weight;
-                        inner_ind[nz_ind++] = offset + 2;
+                        values[nz_ind++] = (n[0]*(-sina*s[0] - cosa*s[1]) + n[1]*(cosa*s[0] - sina*s[1]))*weight;
+                        values[nz_ind++] = n[0]*weight;
+                        values[nz_ind++] = n[1]*weight;
 
                         b[eq_ind] = n.dot(d - s_t)*weight;
                     }
@@ -282,39 +640,27 @@ namespace cilantro {
 
                         diff = tforms_vec[s_offset + 0] - tforms_vec[n_offset + 0];
                         d_sqrt_huber_loss = weight*internal::sqrtHuberLossDerivative<ScalarT>(diff, huber_boundary);
-                        values[nz_ind] = d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = s_offset + 0;
-                        values[nz_ind] = -d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = n_offset + 0;
+                        values[nz_ind++] = d_sqrt_huber_loss;
+                        values[nz_ind++] = -d_sqrt_huber_loss;
                         b[eq_ind++] = -weight*internal::sqrtHuberLoss<ScalarT>(diff, huber_boundary);
 
                         diff = tforms_vec[s_offset + 1] - tforms_vec[n_offset + 1];
                         d_sqrt_huber_loss = weight*internal::sqrtHuberLossDerivative<ScalarT>(diff, huber_boundary);
-                        values[nz_ind] = d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = s_offset + 1;
-                        values[nz_ind] = -d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = n_offset + 1;
+                        values[nz_ind++] = d_sqrt_huber_loss;
+                        values[nz_ind++] = -d_sqrt_huber_loss;
                         b[eq_ind++] = -weight*internal::sqrtHuberLoss<ScalarT>(diff, huber_boundary);
 
                         diff = tforms_vec[s_offset + 2] - tforms_vec[n_offset + 2];
                         d_sqrt_huber_loss = weight*internal::sqrtHuberLossDerivative<ScalarT>(diff, huber_boundary);
-                        values[nz_ind] = d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = s_offset + 2;
-                        values[nz_ind] = -d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = n_offset + 2;
+                        values[nz_ind++] = d_sqrt_huber_loss;
+                        values[nz_ind++] = -d_sqrt_huber_loss;
                         b[eq_ind++] = -weight*internal::sqrtHuberLoss<ScalarT>(diff, huber_boundary);
                     }
                 }
             }
 
-            // Solve linear system using CG
-            AtA = At*At.transpose();
-            Atb.noalias() = At*b;
-
-//            solver.compute(AtA);
-            if (iter == 0) solver.analyzePattern(AtA);
-            solver.factorize(AtA);
-            delta = solver.solve(Atb);
+            // Solve linear system (CG or sparse LDLT, as configured)
+            solver.solve(At, b, delta);
             tforms_vec += delta;
 
             iter++;
@@ -366,7 +712,8 @@ namespace cilantro {
                                          typename TransformT::Scalar cg_conv_tol = (typename TransformT::Scalar)1e-5,
                                          const PointCorrWeightEvaluatorT &point_corr_evaluator = PointCorrWeightEvaluatorT(),
                                          const PlaneCorrWeightEvaluatorT &plane_corr_evaluator = PlaneCorrWeightEvaluatorT(),
-                                         const RegWeightEvaluatorT &reg_evaluator = RegWeightEvaluatorT())
+                                         const RegWeightEvaluatorT &reg_evaluator = RegWeightEvaluatorT(),
+                                         WarpFieldLinearSolver<typename TransformT::Scalar,6> * linear_solver = NULL)
     {
         typedef typename TransformT::Scalar ScalarT;
 
@@ -420,8 +767,15 @@ namespace cilantro {
                 outer_ptr[num_data_term_equations + i] = 6*num_data_term_equations + 2*i;
             }
         }
-        // Inner indices
+        // Inner indices (fixed for the given correspondences; Gauss-Newton iterations only refill values)
         typename Eigen::SparseMatrix<ScalarT>::StorageIndex * const inner_ind = At.innerIndexPtr();
+        if (has_point_to_point_terms) {
+            internal::setDataTermJacobianStructure(point_to_point_correspondences, 6, internal::getNodeBlockLocalIndices(6, 3), outer_ptr, inner_ind);
+        }
+        if (has_point_to_plane_terms) {
+            internal::setDataTermJacobianStructure(point_to_plane_correspondences, 6, internal::getNodeBlockLocalIndices(6, 1), outer_ptr + num_point_to_point_equations, inner_ind);
+        }
+        internal::setRegularizationJacobianStructure(regularization_neighborhoods, reg_eq_ind, 6, inner_ind + outer_ptr[num_data_term_equations]);
 
         // Vector of (negative) residuals
         Eigen::Matrix<ScalarT,Eigen::Dynamic,1> b(num_equations);
@@ -429,16 +783,11 @@ namespace cilantro {
         // Vector of unknowns (Euler angles and translation offsets per point)
         Eigen::Matrix<ScalarT,Eigen::Dynamic,1> tforms_vec(Eigen::Matrix<ScalarT,Eigen::Dynamic,1>::Zero(num_unknowns, 1));
 
-        // Conjugate Gradient solver
-//        Eigen::ConjugateGradient<Eigen::SparseMatrix<ScalarT>,Eigen::Lower|Eigen::Upper,Eigen::IncompleteCholesky<ScalarT,Eigen::Lower|Eigen::Upper>> solver;
-//        Eigen::ConjugateGradient<Eigen::SparseMatrix<ScalarT>,Eigen::Lower|Eigen::Upper,Eigen::IdentityPreconditioner> solver;
-        Eigen::ConjugateGradient<Eigen::SparseMatrix<ScalarT>,Eigen::Lower|Eigen::Upper,Eigen::DiagonalPreconditioner<ScalarT>> solver;
-//        Eigen::ConjugateGradient<Eigen::SparseMatrix<ScalarT>,Eigen::Lower|Eigen::Upper,BlockDiagonalPreconditioner<ScalarT,6>> solver;
-        solver.setMaxIterations(max_cg_iter);
-        solver.setTolerance(cg_conv_tol);
-
-        Eigen::SparseMatrix<ScalarT> AtA;
-        Eigen::Matrix<ScalarT,Eigen::Dynamic,1> Atb;
+        // Gauss-Newton step solver; a caller-provided one brings its configuration (solver type, preconditioner,
+        // matrix-free products, warm start) and carries its symbolic analysis over from previous calls
+        WarpFieldLinearSolver<ScalarT,6> local_solver;
+        WarpFieldLinearSolver<ScalarT,6> &solver = (linear_solver != NULL) ? *linear_solver : local_solver;
+        solver.setMaxNumberOfIterations(max_cg_iter).setConvergenceTolerance(cg_conv_tol);
 
         // Parameters
         const ScalarT point_to_point_weight_sqrt = std::sqrt(point_to_point_weight);
@@ -479,46 +828,28 @@ namespace cilantro {
                         eq_ind = 3*i;
                         nz_ind = 18*i;
 
-                        values[nz_ind] = d_rot_da_s[0]*weight;
-                        inner_ind[nz_ind++] = offset;
-                        values[nz_ind] = d_rot_db_s[0]*weight;
-                        inner_ind[nz_ind++] = offset + 1;
-                        values[nz_ind] = d_rot_dc_s[0]*weight;
-                        inner_ind[nz_ind++] = offset + 2;
-                        values[nz_ind] = weight;
-                        inner_ind[nz_ind++] = offset + 3;
-                        values[nz_ind] = (ScalarT)0.0;
-                        inner_ind[nz_ind++] = offset + 4;
-                        values[nz_ind] = (ScalarT)0.0;
-                        inner_ind[nz_ind++] = offset + 5;
+                        values[nz_ind++] = d_rot_da_s[0]*weight;
+                        values[nz_ind++] = d_rot_db_s[0]*weight;
+                        values[nz_ind++] = d_rot_dc_s[0]*weight;
+                        values[nz_ind++] = weight;
+                        values[nz_ind++] = (ScalarT)0.0;
+                        values[nz_ind++] = (ScalarT)0.0;
                         b[eq_ind++] = trans_s[0]*weight;
 
-                        values[nz_ind] = d_rot_da_s[1]*weight;
-                        inner_ind[nz_ind++] = offset;
-                        values[nz_ind] = d_rot_db_s[1]*weight;
-                        inner_ind[nz_ind++] = offset + 1;
-                        values[nz_ind] = d_rot_dc_s[1]*weight;
-                        inner_ind[nz_ind++] = offset + 2;
-                        values[nz_ind] = (ScalarT)0.0;
-                        inner_ind[nz_ind++] = offset + 3;
-                        values[nz_ind] = weight;
-                        inner_ind[nz_ind++] = offset + 4;
-                        values[nz_ind] = (ScalarT)0.0;
-                        inner_ind[nz_ind++] = offset + 5;
+                        values[nz_ind++] = d_rot_da_s[1]*weight;
+                        values[nz_ind++] = d_rot_db_s[1]*weight;
+                        values[nz_ind++] = d_rot_dc_s[1]*weight;
+                        values[nz_ind++] = (ScalarT)0.0;
+                        values[nz_ind++] = weight;
+                        values[nz_ind++] = (ScalarT)0.0;
                         b[eq_ind++] = trans_s[1]*weight;
 
-                        values[nz_ind] = d_rot_da_s[2]*weight;
-                        inner_ind[nz_ind++] = offset;
-                        values[nz_ind] = d_rot_db_s[2]*weight;
-                        inner_ind[nz_ind++] = offset + 1;
-                        values[nz_ind] = d_rot_dc_s[2]*weight;
-                        inner_ind[nz_ind++] = offset + 2;
-                        values[nz_ind] = (ScalarT)0.0;
-                        inner_ind[nz_ind++] = offset + 3;
-                        values[nz_ind] = (ScalarT)0.0;
-                        inner_ind[nz_ind++] = offset + 4;
-                        values[nz_ind] = weight;
-                        inner_ind[nz_ind++] = offset + 5;
+                        values[nz_ind++] = d_rot_da_s[2]*weight;
+                        values[nz_ind++] = d_rot_db_s[2]*weight;
+                        values[nz_ind++] = d_rot_dc_s[2]*weight;
+                        values[nz_ind++] = (ScalarT)0.0;
+                        values[nz_ind++] = (ScalarT)0.0;
+                        values[nz_ind++] = weight;
                         b[eq_ind++] = trans_s[2]*weight;
                     }
                 }
@@ -544,18 +875,12 @@ namespace cilantro {
                         eq_ind = num_point_to_point_equations + i;
                         nz_ind = 6*num_point_to_point_equations + 6*i;
 
-                        values[nz_ind] = (n.dot(d_rot_da_s))*weight;
-                        inner_ind[nz_ind++] = offset;
-                        values[nz_ind] = (n.dot(d_rot_db_s))*weight;
-                        inner_ind[nz_ind++] = offset + 1;
-                        values[nz_ind] = (n.dot(d_rot_dc_s))*weight;
-                        inner_ind[nz_ind++] = offset + 2;
-                        values[nz_ind] = n[0]*weight;
-                        inner_ind[nz_ind++] = offset + 3;
-                        values[nz_ind] = n[1]*weight;
-                        inner_ind[nz_ind++] = offset + 4;
-                        values[nz_ind] = n[2]*weight;
-                        inner_ind[nz_ind++] = offset + 5;
+                        values[nz_ind++] = (n.dot(d_rot_da_s))*weight;
+                        values[nz_ind++] = (n.dot(d_rot_db_s))*weight;
+                        values[nz_ind++] = (n.dot(d_rot_dc_s))*weight;
+                        values[nz_ind++] = n[0]*weight;
+                        values[nz_ind++] = n[1]*weight;
+                        values[nz_ind++] = n[2]*weight;
                         b[eq_ind] = n.dot(trans_s)*weight;
                     }
                 }
@@ -576,63 +901,45 @@ namespace cilantro {
 
                         diff = tforms_vec[s_offset + 0] - tforms_vec[n_offset + 0];
                         d_sqrt_huber_loss = weight*internal::sqrtHuberLossDerivative<ScalarT>(diff, huber_boundary);
-                        values[nz_ind] = d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = s_offset;
-                        values[nz_ind] = -d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = n_offset;
+                        values[nz_ind++] = d_sqrt_huber_loss;
+                        values[nz_ind++] = -d_sqrt_huber_loss;
                         b[eq_ind++] = -weight*internal::sqrtHuberLoss<ScalarT>(diff, huber_boundary);
 
                         diff = tforms_vec[s_offset + 1] - tforms_vec[n_offset + 1];
                         d_sqrt_huber_loss = weight*internal::sqrtHuberLossDerivative<ScalarT>(diff, huber_boundary);
-                        values[nz_ind] = d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = s_offset + 1;
-                        values[nz_ind] = -d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = n_offset + 1;
+                        values[nz_ind++] = d_sqrt_huber_loss;
+                        values[nz_ind++] = -d_sqrt_huber_loss;
                         b[eq_ind++] = -weight*internal::sqrtHuberLoss<ScalarT>(diff, huber_boundary);
 
                         diff = tforms_vec[s_offset + 2] - tforms_vec[n_offset + 2];
                         d_sqrt_huber_loss = weight*internal::sqrtHuberLossDerivative<ScalarT>(diff, huber_boundary);
-                        values[nz_ind] = d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = s_offset + 2;
-                        values[nz_ind] = -d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = n_offset + 2;
+                        values[nz_ind++] = d_sqrt_huber_loss;
+                        values[nz_ind++] = -d_sqrt_huber_loss;
                         b[eq_ind++] = -weight*internal::sqrtHuberLoss<ScalarT>(diff, huber_boundary);
 
                         diff = tforms_vec[s_offset + 3] - tforms_vec[n_offset + 3];
                         d_sqrt_huber_loss = weight*internal::sqrtHuberLossDerivative<ScalarT>(diff, huber_boundary);
-                        values[nz_ind] = d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = s_offset + 3;
-                        values[nz_ind] = -d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = n_offset + 3;
+                        values[nz_ind++] = d_sqrt_huber_loss;
+                        values[nz_ind++] = -d_sqrt_huber_loss;
                         b[eq_ind++] = -weight*internal::sqrtHuberLoss<ScalarT>(diff, huber_boundary);
 
                         diff = tforms_vec[s_offset + 4] - tforms_vec[n_offset + 4];
                         d_sqrt_huber_loss = weight*internal::sqrtHuberLossDerivative<ScalarT>(diff, huber_boundary);
-                        values[nz_ind] = d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = s_offset + 4;
-                        values[nz_ind] = -d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = n_offset + 4;
+                        values[nz_ind++] = d_sqrt_huber_loss;
+                        values[nz_ind++] = -d_sqrt_huber_loss;
                         b[eq_ind++] = -weight*internal::sqrtHuberLoss<ScalarT>(diff, huber_boundary);
 
                         diff = tforms_vec[s_offset + 5] - tforms_vec[n_offset + 5];
                         d_sqrt_huber_loss = weight*internal::sqrtHuberLossDerivative<ScalarT>(diff, huber_boundary);
-                        values[nz_ind] = d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = s_offset + 5;
-                        values[nz_ind] = -d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = n_offset + 5;
+                        values[nz_ind++] = d_sqrt_huber_loss;
+                        values[nz_ind++] = -d_sqrt_huber_loss;
                         b[eq_ind++] = -weight*internal::sqrtHuberLoss<ScalarT>(diff, huber_boundary);
                     }
                 }
             }
 
-            // Solve linear system using CG
-            AtA = At*At.transpose();
-            Atb.noalias() = At*b;
-
-//            solver.compute(AtA);
-            if (iter == 0) solver.analyzePattern(AtA);
-            solver.factorize(AtA);
-            delta = solver.solve(Atb);
+            // Solve linear system (CG or sparse LDLT, as configured)
+            solver.solve(At, b, delta);
             tforms_vec += delta;
 
             iter++;
@@ -687,7 +994,8 @@ namespace cilantro {
                                          typename TransformT::Scalar cg_conv_tol = (typename TransformT::Scalar)1e-5,
                                          const PointCorrWeightEvaluatorT &point_corr_evaluator = PointCorrWeightEvaluatorT(),
                                          const PlaneCorrWeightEvaluatorT &plane_corr_evaluator = PlaneCorrWeightEvaluatorT(),
-                                         const RegWeightEvaluatorT &reg_evaluator = RegWeightEvaluatorT())
+                                         const RegWeightEvaluatorT &reg_evaluator = RegWeightEvaluatorT(),
+                                         WarpFieldLinearSolver<typename TransformT::Scalar,TransformT::Dim*(TransformT::Dim + 1)> * linear_solver = NULL)
     {
         typedef typename TransformT::Scalar ScalarT;
         enum {
@@ -752,8 +1060,23 @@ namespace cilantro {
                 outer_ptr[num_data_term_equations + i] = num_non_zeros_data_term + 2*i;
             }
         }
-        // Inner indices
+        // Inner indices (fixed for the given correspondences; Gauss-Newton iterations only refill values)
         typename Eigen::SparseMatrix<ScalarT>::StorageIndex * const inner_ind = At.innerIndexPtr();
+        if (has_point_to_point_terms) {
+            // Equation eq of a point-to-point term depends on row eq of the linear part and on translation entry eq
+            std::vector<std::vector<size_t>> local_indices(Dim, std::vector<size_t>(NumNonZerosPointToPoint));
+            for (size_t eq = 0; eq < Dim; eq++) {
+                for (size_t nz = 0; nz < Dim; nz++) {
+                    local_indices[eq][nz] = Dim*eq + nz;
+                }
+                local_indices[eq][Dim] = Dim*Dim + eq;
+            }
+            internal::setDataTermJacobianStructure(point_to_point_correspondences, NumUnknownsLocal, local_indices, outer_ptr, inner_ind);
+        }
+        if (has_point_to_plane_terms) {
+            internal::setDataTermJacobianStructure(point_to_plane_correspondences, NumUnknownsLocal, internal::getNodeBlockLocalIndices(NumUnknownsLocal, 1), outer_ptr + num_point_to_point_equations, inner_ind);
+        }
+        internal::setRegularizationJacobianStructure(regularization_neighborhoods, reg_eq_ind, NumUnknownsLocal, inner_ind + outer_ptr[num_data_term_equations]);
 
         // Vector of (negative) residuals
         Eigen::Matrix<ScalarT,Eigen::Dynamic,1> b(num_equations);
@@ -766,15 +1089,11 @@ namespace cilantro {
             tforms_vec.template segment<Dim>(i*NumUnknownsLocal + Dim*Dim).setZero();
         }
 
-        // Conjugate Gradient solver
-//        Eigen::ConjugateGradient<Eigen::SparseMatrix<ScalarT>,Eigen::Lower|Eigen::Upper,Eigen::IncompleteCholesky<ScalarT,Eigen::Lower|Eigen::Upper>> solver;
-//        Eigen::ConjugateGradient<Eigen::SparseMatrix<ScalarT>,Eigen::Lower|Eigen::Upper,Eigen::IdentityPreconditioner> solver;
-        Eigen::ConjugateGradient<Eigen::SparseMatrix<ScalarT>,Eigen::Lower|Eigen::Upper,Eigen::DiagonalPreconditioner<ScalarT>> solver;
-        solver.setMaxIterations(max_cg_iter);
-        solver.setTolerance(cg_conv_tol);
-
-        Eigen::SparseMatrix<ScalarT> AtA;
-        Eigen::Matrix<ScalarT,Eigen::Dynamic,1> Atb;
+        // Gauss-Newton step solver; a caller-provided one brings its configuration (solver type, preconditioner,
+        // matrix-free products, warm start) and carries its symbolic analysis over from previous calls
+        WarpFieldLinearSolver<ScalarT,NumUnknownsLocal> local_solver;
+        WarpFieldLinearSolver<ScalarT,NumUnknownsLocal> &solver = (linear_solver != NULL) ? *linear_solver : local_solver;
+        solver.setMaxNumberOfIterations(max_cg_iter).setConvergenceTolerance(cg_conv_tol);
 
         // Parameters
         const ScalarT point_to_point_weight_sqrt = std::sqrt(point_to_point_weight);
@@ -811,11 +1130,9 @@ namespace cilantro {
 
                         for (size_t eq = 0; eq < Dim; eq++) {
                             for (size_t nz = 0; nz < Dim; nz++) {
-                                values[nz_ind] = weight*s_t[nz];
-                                inner_ind[nz_ind++] = offset + Dim*eq + nz;
+                                values[nz_ind++] = weight*s_t[nz];
                             }
-                            values[nz_ind] = weight;
-                            inner_ind[nz_ind++] = offset + Dim*Dim + eq;
+                            values[nz_ind++] = weight;
                         }
                         b.template segment<Dim>(eq_ind) = weight*(d - s_t);
                     }
@@ -840,13 +1157,11 @@ namespace cilantro {
 
                         for (size_t block = 0; block < Dim; block++) {
                             for (size_t curr = 0; curr < Dim; curr++) {
-                                values[nz_ind] = weight*n[block]*s_t[curr];
-                                inner_ind[nz_ind++] = offset + Dim*block + curr;
+                                values[nz_ind++] = weight*n[block]*s_t[curr];
                             }
                         }
                         for (size_t curr = 0; curr < Dim; curr++) {
-                            values[nz_ind] = weight*n[curr];
-                            inner_ind[nz_ind++] = offset + Dim*Dim + curr;
+                            values[nz_ind++] = weight*n[curr];
                         }
 
                         b[eq_ind] = (n.dot(d - s_t))*weight;
@@ -870,24 +1185,16 @@ namespace cilantro {
                         for (size_t eq = 0; eq < NumUnknownsLocal; eq++) {
                             diff = tforms_vec[s_offset + eq] - tforms_vec[n_offset + eq];
                             d_sqrt_huber_loss = weight*internal::sqrtHuberLossDerivative<ScalarT>(diff, huber_boundary);
-                            values[nz_ind] = d_sqrt_huber_loss;
-                            inner_ind[nz_ind++] = s_offset + eq;
-                            values[nz_ind] = -d_sqrt_huber_loss;
-                            inner_ind[nz_ind++] = n_offset + eq;
+                            values[nz_ind++] = d_sqrt_huber_loss;
+                            values[nz_ind++] = -d_sqrt_huber_loss;
                             b[eq_ind++] = -weight*internal::sqrtHuberLoss<ScalarT>(diff, huber_boundary);
                         }
                     }
                 }
             }
 
-            // Solve linear system using CG
-            AtA = At*At.transpose();
-            Atb.noalias() = At*b;
-
-//            solver.compute(AtA);
-            if (iter == 0) solver.analyzePattern(AtA);
-            solver.factorize(AtA);
-            delta = solver.solve(Atb);
+            // Solve linear system (CG or sparse LDLT, as configured)
+            solver.solve(At, b, delta);
             tforms_vec += delta;
 
             iter++;
@@ -942,7 +1249,8 @@ namespace cilantro {
                                           const PointCorrWeightEvaluatorT &point_corr_evaluator = PointCorrWeightEvaluatorT(),
                                           const PlaneCorrWeightEvaluatorT &plane_corr_evaluator = PlaneCorrWeightEvaluatorT(),
                                           const ControlWeightEvaluatorT &control_evaluator = ControlWeightEvaluatorT(),
-                                          const RegWeightEvaluatorT &reg_evaluator = RegWeightEvaluatorT())
+                                          const RegWeightEvaluatorT &reg_evaluator = RegWeightEvaluatorT(),
+                                          WarpFieldLinearSolver<typename TransformT::Scalar,3> * linear_solver = NULL)
     {
         typedef typename TransformT::Scalar ScalarT;
 
@@ -1037,8 +1345,15 @@ namespace cilantro {
         At.reserve(outer_ptr[num_equations]);
         // Values
         ScalarT * const values = At.valuePtr();
-        // Inner indices
+        // Inner indices (fixed for the given correspondences; Gauss-Newton iterations only refill values)
         typename Eigen::SparseMatrix<ScalarT>::StorageIndex * const inner_ind = At.innerIndexPtr();
+        if (has_point_to_point_terms) {
+            internal::setDataTermJacobianStructure(point_to_point_correspondences, src_to_ctrl_sorted, 3, internal::getNodeBlockLocalIndices(3, 2), outer_ptr, inner_ind);
+        }
+        if (has_point_to_plane_terms) {
+            internal::setDataTermJacobianStructure(point_to_plane_correspondences, src_to_ctrl_sorted, 3, internal::getNodeBlockLocalIndices(3, 1), outer_ptr + num_point_to_point_equations, inner_ind);
+        }
+        internal::setRegularizationJacobianStructure(regularization_neighborhoods, reg_eq_ind, 3, inner_ind + outer_ptr[num_data_term_equations]);
 
         // Vector of (negative) residuals
         Eigen::Matrix<ScalarT,Eigen::Dynamic,1> b(num_equations);
@@ -1046,15 +1361,11 @@ namespace cilantro {
         // Vector of unknowns (rotation angle and translation offsets per control node)
         Eigen::Matrix<ScalarT,Eigen::Dynamic,1> tforms_vec(Eigen::Matrix<ScalarT,Eigen::Dynamic,1>::Zero(num_unknowns, 1));
 
-        // Conjugate Gradient solver
-//        Eigen::ConjugateGradient<Eigen::SparseMatrix<ScalarT>,Eigen::Lower|Eigen::Upper,Eigen::IncompleteCholesky<ScalarT,Eigen::Lower|Eigen::Upper>> solver;
-//        Eigen::ConjugateGradient<Eigen::SparseMatrix<ScalarT>,Eigen::Lower|Eigen::Upper,Eigen::IdentityPreconditioner> solver;
-        Eigen::ConjugateGradient<Eigen::SparseMatrix<ScalarT>,Eigen::Lower|Eigen::Upper,Eigen::DiagonalPreconditioner<ScalarT>> solver;
-        solver.setMaxIterations(max_cg_iter);
-        solver.setTolerance(cg_conv_tol);
-
-        Eigen::SparseMatrix<ScalarT> AtA;
-        Eigen::Matrix<ScalarT,Eigen::Dynamic,1> Atb;
+        // Gauss-Newton step solver; a caller-provided one brings its configuration (solver type, preconditioner,
+        // matrix-free products, warm start) and carries its symbolic analysis over from previous calls
+        WarpFieldLinearSolver<ScalarT,3> local_solver;
+        WarpFieldLinearSolver<ScalarT,3> &solver = (linear_solver != NULL) ? *linear_solver : local_solver;
+        solver.setMaxNumberOfIterations(max_cg_iter).setConvergenceTolerance(cg_conv_tol);
 
         // Parameters
         const ScalarT point_to_point_weight_sqrt = std::sqrt(point_to_point_weight);
@@ -1115,24 +1426,17 @@ namespace cilantro {
                         const ScalarT coeff2 = cosa*s[0] - sina*s[1];
 
                         for (size_t j = 0; j < ctrl_neighbors.size(); j++) {
-                            const size_t offset = 3*ctrl_neighbors[j].index;
                             weight = corr_weight_nrm*ctrl_neighbors[j].value;
 
                             nz_ind = outer_ptr[eq_ind] + 3*j;
-                            values[nz_ind] = coeff1*weight;
-                            inner_ind[nz_ind++] = offset;
-                            values[nz_ind] = weight;
-                            inner_ind[nz_ind++] = offset + 1;
-                            values[nz_ind] = (ScalarT)0.0;
-                            inner_ind[nz_ind++] = offset + 2;
+                            values[nz_ind++] = coeff1*weight;
+                            values[nz_ind++] = weight;
+                            values[nz_ind++] = (ScalarT)0.0;
 
                             nz_ind = outer_ptr[eq_ind + 1] + 3*j;
-                            values[nz_ind] = coeff2*weight;
-                            inner_ind[nz_ind++] = offset;
-                            values[nz_ind] = (ScalarT)0.0;
-                            inner_ind[nz_ind++] = offset + 1;
-                            values[nz_ind] = weight;
-                            inner_ind[nz_ind++] = offset + 2;
+                            values[nz_ind++] = coeff2*weight;
+                            values[nz_ind++] = (ScalarT)0.0;
+                            values[nz_ind++] = weight;
                         }
 
                         b.template segment<2>(eq_ind) = (d - s_t)*corr_weight_sqrt;
@@ -1179,17 +1483,13 @@ namespace cilantro {
                         const ScalarT dot_val = (n[0]*(-sina*s[0] - cosa*s[1]) + n[1]*(cosa*s[0] - sina*s[1]));
 
                         for (size_t j = 0; j < ctrl_neighbors.size(); j++) {
-                            const size_t offset = 3*ctrl_neighbors[j].index;
                             weight = corr_weight_nrm*ctrl_neighbors[j].value;
 
                             // Point to plane
                             nz_ind = outer_ptr[eq_ind] + 3*j;
-                            values[nz_ind] = dot_val*weight;
-                            inner_ind[nz_ind++] = offset;
-                            values[nz_ind] = n[0]*weight;
-                            inner_ind[nz_ind++] = offset + 1;
-                            values[nz_ind] = n[1]*weight;
-                            inner_ind[nz_ind++] = offset + 2;
+                            values[nz_ind++] = dot_val*weight;
+                            values[nz_ind++] = n[0]*weight;
+                            values[nz_ind++] = n[1]*weight;
                         }
 
                         b[eq_ind] = n.dot(d - s_t)*corr_weight_sqrt;
@@ -1212,39 +1512,27 @@ namespace cilantro {
 
                         diff = tforms_vec[s_offset + 0] - tforms_vec[n_offset + 0];
                         d_sqrt_huber_loss = weight*internal::sqrtHuberLossDerivative<ScalarT>(diff, huber_boundary);
-                        values[nz_ind] = d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = s_offset;
-                        values[nz_ind] = -d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = n_offset;
+                        values[nz_ind++] = d_sqrt_huber_loss;
+                        values[nz_ind++] = -d_sqrt_huber_loss;
                         b[eq_ind++] = -weight*internal::sqrtHuberLoss<ScalarT>(diff, huber_boundary);
 
                         diff = tforms_vec[s_offset + 1] - tforms_vec[n_offset + 1];
                         d_sqrt_huber_loss = weight*internal::sqrtHuberLossDerivative<ScalarT>(diff, huber_boundary);
-                        values[nz_ind] = d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = s_offset + 1;
-                        values[nz_ind] = -d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = n_offset + 1;
+                        values[nz_ind++] = d_sqrt_huber_loss;
+                        values[nz_ind++] = -d_sqrt_huber_loss;
                         b[eq_ind++] = -weight*internal::sqrtHuberLoss<ScalarT>(diff, huber_boundary);
 
                         diff = tforms_vec[s_offset + 2] - tforms_vec[n_offset + 2];
                         d_sqrt_huber_loss = weight*internal::sqrtHuberLossDerivative<ScalarT>(diff, huber_boundary);
-                        values[nz_ind] = d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = s_offset + 2;
-                        values[nz_ind] = -d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = n_offset + 2;
+                        values[nz_ind++] = d_sqrt_huber_loss;
+                        values[nz_ind++] = -d_sqrt_huber_loss;
                         b[eq_ind++] = -weight*internal::sqrtHuberLoss<ScalarT>(diff, huber_boundary);
                     }
                 }
             }
 
-            // Solve linear system using CG
-            AtA = At*At.transpose();
-            Atb.noalias() = At*b;
-
-//            solver.compute(AtA);
-            if (iter == 0) solver.analyzePattern(AtA);
-            solver.factorize(AtA);
-            delta = solver.solve(Atb);
+            // Solve linear system (CG or sparse LDLT, as configured)
+            solver.solve(At, b, delta);
             tforms_vec += delta;
 
             iter++;
@@ -1299,7 +1587,8 @@ namespace cilantro {
                                           const PointCorrWeightEvaluatorT &point_corr_evaluator = PointCorrWeightEvaluatorT(),
                                           const PlaneCorrWeightEvaluatorT &plane_corr_evaluator = PlaneCorrWeightEvaluatorT(),
                                           const ControlWeightEvaluatorT &control_evaluator = ControlWeightEvaluatorT(),
-                                          const RegWeightEvaluatorT &reg_evaluator = RegWeightEvaluatorT())
+                                          const RegWeightEvaluatorT &reg_evaluator = RegWeightEvaluatorT(),
+                                          WarpFieldLinearSolver<typename TransformT::Scalar,6> * linear_solver = NULL)
     {
         typedef typename TransformT::Scalar ScalarT;
 
@@ -1395,8 +1684,15 @@ namespace cilantro {
         At.reserve(outer_ptr[num_equations]);
         // Values
         ScalarT * const values = At.valuePtr();
-        // Inner indices
+        // Inner indices (fixed for the given correspondences; Gauss-Newton iterations only refill values)
         typename Eigen::SparseMatrix<ScalarT>::StorageIndex * const inner_ind = At.innerIndexPtr();
+        if (has_point_to_point_terms) {
+            internal::setDataTermJacobianStructure(point_to_point_correspondences, src_to_ctrl_sorted, 6, internal::getNodeBlockLocalIndices(6, 3), outer_ptr, inner_ind);
+        }
+        if (has_point_to_plane_terms) {
+            internal::setDataTermJacobianStructure(point_to_plane_correspondences, src_to_ctrl_sorted, 6, internal::getNodeBlockLocalIndices(6, 1), outer_ptr + num_point_to_point_equations, inner_ind);
+        }
+        internal::setRegularizationJacobianStructure(regularization_neighborhoods, reg_eq_ind, 6, inner_ind + outer_ptr[num_data_term_equations]);
 
         // Vector of (negative) residuals
         Eigen::Matrix<ScalarT,Eigen::Dynamic,1> b(num_equations);
@@ -1404,16 +1700,11 @@ namespace cilantro {
         // Vector of unknowns (Euler angles and translation offsets per control node)
         Eigen::Matrix<ScalarT,Eigen::Dynamic,1> tforms_vec(Eigen::Matrix<ScalarT,Eigen::Dynamic,1>::Zero(num_unknowns, 1));
 
-        // Conjugate Gradient solver
-//        Eigen::ConjugateGradient<Eigen::SparseMatrix<ScalarT>,Eigen::Lower|Eigen::Upper,Eigen::IncompleteCholesky<ScalarT,Eigen::Lower|Eigen::Upper>> solver;
-//        Eigen::ConjugateGradient<Eigen::SparseMatrix<ScalarT>,Eigen::Lower|Eigen::Upper,Eigen::IdentityPreconditioner> solver;
-        Eigen::ConjugateGradient<Eigen::SparseMatrix<ScalarT>,Eigen::Lower|Eigen::Upper,Eigen::DiagonalPreconditioner<ScalarT>> solver;
-//        Eigen::ConjugateGradient<Eigen::SparseMatrix<ScalarT>,Eigen::Lower|Eigen::Upper,BlockDiagonalPreconditioner<ScalarT,6>> solver;
-        solver.setMaxIterations(max_cg_iter);
-        solver.setTolerance(cg_conv_tol);
-
-        Eigen::SparseMatrix<ScalarT> AtA;
-        Eigen::Matrix<ScalarT,Eigen::Dynamic,1> Atb;
+        // Gauss-Newton step solver; a caller-provided one brings its configuration (solver type, preconditioner,
+        // matrix-free products, warm start) and carries its symbolic analysis over from previous calls
+        WarpFieldLinearSolver<ScalarT,6> local_solver;
+        WarpFieldLinearSolver<ScalarT,6> &solver = (linear_solver != NULL) ? *linear_solver : local_solver;
+        solver.setMaxNumberOfIterations(max_cg_iter).setConvergenceTolerance(cg_conv_tol);
 
         // Parameters
         const ScalarT point_to_point_weight_sqrt = std::sqrt(point_to_point_weight);
@@ -1474,50 +1765,31 @@ namespace cilantro {
                         eq_ind = 3*i;
 
                         for (size_t j = 0; j < ctrl_neighbors.size(); j++) {
-                            const size_t offset = 6*ctrl_neighbors[j].index;
                             weight = corr_weight_nrm*ctrl_neighbors[j].value;
 
                             nz_ind = outer_ptr[eq_ind] + 6*j;
-                            values[nz_ind] = d_rot_da_s[0]*weight;
-                            inner_ind[nz_ind++] = offset;
-                            values[nz_ind] = d_rot_db_s[0]*weight;
-                            inner_ind[nz_ind++] = offset + 1;
-                            values[nz_ind] = d_rot_dc_s[0]*weight;
-                            inner_ind[nz_ind++] = offset + 2;
-                            values[nz_ind] = weight;
-                            inner_ind[nz_ind++] = offset + 3;
-                            values[nz_ind] = (ScalarT)0.0;
-                            inner_ind[nz_ind++] = offset + 4;
-                            values[nz_ind] = (ScalarT)0.0;
-                            inner_ind[nz_ind++] = offset + 5;
+                            values[nz_ind++] = d_rot_da_s[0]*weight;
+                            values[nz_ind++] = d_rot_db_s[0]*weight;
+                            values[nz_ind++] = d_rot_dc_s[0]*weight;
+                            values[nz_ind++] = weight;
+                            values[nz_ind++] = (ScalarT)0.0;
+                            values[nz_ind++] = (ScalarT)0.0;
 
                             nz_ind = outer_ptr[eq_ind + 1] + 6*j;
-                            values[nz_ind] = d_rot_da_s[1]*weight;
-                            inner_ind[nz_ind++] = offset;
-                            values[nz_ind] = d_rot_db_s[1]*weight;
-                            inner_ind[nz_ind++] = offset + 1;
-                            values[nz_ind] = d_rot_dc_s[1]*weight;
-                            inner_ind[nz_ind++] = offset + 2;
-                            values[nz_ind] = (ScalarT)0.0;
-                            inner_ind[nz_ind++] = offset + 3;
-                            values[nz_ind] = weight;
-                            inner_ind[nz_ind++] = offset + 4;
-                            values[nz_ind] = (ScalarT)0.0;
-                            inner_ind[nz_ind++] = offset + 5;
+                            values[nz_ind++] = d_rot_da_s[1]*weight;
+                            values[nz_ind++] = d_rot_db_s[1]*weight;
+                            values[nz_ind++] = d_rot_dc_s[1]*weight;
+                            values[nz_ind++] = (ScalarT)0.0;
+                            values[nz_ind++] = weight;
+                            values[nz_ind++] = (ScalarT)0.0;
 
                             nz_ind = outer_ptr[eq_ind + 2] + 6*j;
-                            values[nz_ind] = d_rot_da_s[2]*weight;
-                            inner_ind[nz_ind++] = offset;
-                            values[nz_ind] = d_rot_db_s[2]*weight;
-                            inner_ind[nz_ind++] = offset + 1;
-                            values[nz_ind] = d_rot_dc_s[2]*weight;
-                            inner_ind[nz_ind++] = offset + 2;
-                            values[nz_ind] = (ScalarT)0.0;
-                            inner_ind[nz_ind++] = offset + 3;
-                            values[nz_ind] = (ScalarT)0.0;
-                            inner_ind[nz_ind++] = offset + 4;
-                            values[nz_ind] = weight;
-                            inner_ind[nz_ind++] = offset + 5;
+                            values[nz_ind++] = d_rot_da_s[2]*weight;
+                            values[nz_ind++] = d_rot_db_s[2]*weight;
+                            values[nz_ind++] = d_rot_dc_s[2]*weight;
+                            values[nz_ind++] = (ScalarT)0.0;
+                            values[nz_ind++] = (ScalarT)0.0;
+                            values[nz_ind++] = weight;
                         }
 
                         b.template segment<3>(eq_ind) = trans_s*corr_weight_sqrt;
@@ -1568,23 +1840,16 @@ namespace cilantro {
                         const ScalarT dot3 = n.dot(d_rot_dc_s);
 
                         for (size_t j = 0; j < ctrl_neighbors.size(); j++) {
-                            const size_t offset = 6*ctrl_neighbors[j].index;
                             weight = corr_weight_nrm*ctrl_neighbors[j].value;
 
                             // Point to plane
                             nz_ind = outer_ptr[eq_ind] + 6*j;
-                            values[nz_ind] = dot1*weight;
-                            inner_ind[nz_ind++] = offset;
-                            values[nz_ind] = dot2*weight;
-                            inner_ind[nz_ind++] = offset + 1;
-                            values[nz_ind] = dot3*weight;
-                            inner_ind[nz_ind++] = offset + 2;
-                            values[nz_ind] = n[0]*weight;
-                            inner_ind[nz_ind++] = offset + 3;
-                            values[nz_ind] = n[1]*weight;
-                            inner_ind[nz_ind++] = offset + 4;
-                            values[nz_ind] = n[2]*weight;
-                            inner_ind[nz_ind++] = offset + 5;
+                            values[nz_ind++] = dot1*weight;
+                            values[nz_ind++] = dot2*weight;
+                            values[nz_ind++] = dot3*weight;
+                            values[nz_ind++] = n[0]*weight;
+                            values[nz_ind++] = n[1]*weight;
+                            values[nz_ind++] = n[2]*weight;
                         }
 
                         b[eq_ind] = n.dot(trans_s)*corr_weight_sqrt;
@@ -1607,63 +1872,45 @@ namespace cilantro {
 
                         diff = tforms_vec[s_offset + 0] - tforms_vec[n_offset + 0];
                         d_sqrt_huber_loss = weight*internal::sqrtHuberLossDerivative<ScalarT>(diff, huber_boundary);
-                        values[nz_ind] = d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = s_offset;
-                        values[nz_ind] = -d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = n_offset;
+                        values[nz_ind++] = d_sqrt_huber_loss;
+                        values[nz_ind++] = -d_sqrt_huber_loss;
                         b[eq_ind++] = -weight*internal::sqrtHuberLoss<ScalarT>(diff, huber_boundary);
 
                         diff = tforms_vec[s_offset + 1] - tforms_vec[n_offset + 1];
                         d_sqrt_huber_loss = weight*internal::sqrtHuberLossDerivative<ScalarT>(diff, huber_boundary);
-                        values[nz_ind] = d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = s_offset + 1;
-                        values[nz_ind] = -d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = n_offset + 1;
+                        values[nz_ind++] = d_sqrt_huber_loss;
+                        values[nz_ind++] = -d_sqrt_huber_loss;
                         b[eq_ind++] = -weight*internal::sqrtHuberLoss<ScalarT>(diff, huber_boundary);
 
                         diff = tforms_vec[s_offset + 2] - tforms_vec[n_offset + 2];
                         d_sqrt_huber_loss = weight*internal::sqrtHuberLossDerivative<ScalarT>(diff, huber_boundary);
-                        values[nz_ind] = d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = s_offset + 2;
-                        values[nz_ind] = -d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = n_offset + 2;
+                        values[nz_ind++] = d_sqrt_huber_loss;
+                        values[nz_ind++] = -d_sqrt_huber_loss;
                         b[eq_ind++] = -weight*internal::sqrtHuberLoss<ScalarT>(diff, huber_boundary);
 
                         diff = tforms_vec[s_offset + 3] - tforms_vec[n_offset + 3];
                         d_sqrt_huber_loss = weight*internal::sqrtHuberLossDerivative<ScalarT>(diff, huber_boundary);
-                        values[nz_ind] = d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = s_offset + 3;
-                        values[nz_ind] = -d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = n_offset + 3;
+                        values[nz_ind++] = d_sqrt_huber_loss;
+                        values[nz_ind++] = -d_sqrt_huber_loss;
                         b[eq_ind++] = -weight*internal::sqrtHuberLoss<ScalarT>(diff, huber_boundary);
 
                         diff = tforms_vec[s_offset + 4] - tforms_vec[n_offset + 4];
                         d_sqrt_huber_loss = weight*internal::sqrtHuberLossDerivative<ScalarT>(diff, huber_boundary);
-                        values[nz_ind] = d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = s_offset + 4;
-                        values[nz_ind] = -d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = n_offset + 4;
+                        values[nz_ind++] = d_sqrt_huber_loss;
+                        values[nz_ind++] = -d_sqrt_huber_loss;
                         b[eq_ind++] = -weight*internal::sqrtHuberLoss<ScalarT>(diff, huber_boundary);
 
                         diff = tforms_vec[s_offset + 5] - tforms_vec[n_offset + 5];
                         d_sqrt_huber_loss = weight*internal::sqrtHuberLossDerivative<ScalarT>(diff, huber_boundary);
-                        values[nz_ind] = d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = s_offset + 5;
-                        values[nz_ind] = -d_sqrt_huber_loss;
-                        inner_ind[nz_ind++] = n_offset + 5;
+                        values[nz_ind++] = d_sqrt_huber_loss;
+                        values[nz_ind++] = -d_sqrt_huber_loss;
                         b[eq_ind++] = -weight*internal::sqrtHuberLoss<ScalarT>(diff, huber_boundary);
                     }
                 }
             }
 
-            // Solve linear system using CG
-            AtA = At*At.transpose();
-            Atb.noalias() = At*b;
-
-//            solver.compute(AtA);
-            if (iter == 0) solver.analyzePattern(AtA);
-            solver.factorize(AtA);
-            delta = solver.solve(Atb);
+            // Solve linear system (CG or sparse LDLT, as configured)
+            solver.solve(At, b, delta);
             tforms_vec += delta;
 
             iter++;
@@ -1721,7 +1968,8 @@ namespace cilantro {
                                           const PointCorrWeightEvaluatorT &point_corr_evaluator = PointCorrWeightEvaluatorT(),
                                           const PlaneCorrWeightEvaluatorT &plane_corr_evaluator = PlaneCorrWeightEvaluatorT(),
                                           const ControlWeightEvaluatorT &control_evaluator = ControlWeightEvaluatorT(),
-                                          const RegWeightEvaluatorT &reg_evaluator = RegWeightEvaluatorT())
+                                          const RegWeightEvaluatorT &reg_evaluator = RegWeightEvaluatorT(),
+                                          WarpFieldLinearSolver<typename TransformT::Scalar,TransformT::Dim*(TransformT::Dim + 1)> * linear_solver = NULL)
     {
         typedef typename TransformT::Scalar ScalarT;
         enum {
@@ -1823,8 +2071,23 @@ namespace cilantro {
         At.reserve(outer_ptr[num_equations]);
         // Values
         ScalarT * const values = At.valuePtr();
-        // Inner indices
+        // Inner indices (fixed for the given correspondences; Gauss-Newton iterations only refill values)
         typename Eigen::SparseMatrix<ScalarT>::StorageIndex * const inner_ind = At.innerIndexPtr();
+        if (has_point_to_point_terms) {
+            // Equation eq of a point-to-point term depends on row eq of the linear part and on translation entry eq
+            std::vector<std::vector<size_t>> local_indices(Dim, std::vector<size_t>(NumNonZerosPointToPoint));
+            for (size_t eq = 0; eq < Dim; eq++) {
+                for (size_t nz = 0; nz < Dim; nz++) {
+                    local_indices[eq][nz] = Dim*eq + nz;
+                }
+                local_indices[eq][Dim] = Dim*Dim + eq;
+            }
+            internal::setDataTermJacobianStructure(point_to_point_correspondences, src_to_ctrl_sorted, NumUnknownsLocal, local_indices, outer_ptr, inner_ind);
+        }
+        if (has_point_to_plane_terms) {
+            internal::setDataTermJacobianStructure(point_to_plane_correspondences, src_to_ctrl_sorted, NumUnknownsLocal, internal::getNodeBlockLocalIndices(NumUnknownsLocal, 1), outer_ptr + num_point_to_point_equations, inner_ind);
+        }
+        internal::setRegularizationJacobianStructure(regularization_neighborhoods, reg_eq_ind, NumUnknownsLocal, inner_ind + outer_ptr[num_data_term_equations]);
 
         // Vector of (negative) residuals
         Eigen::Matrix<ScalarT,Eigen::Dynamic,1> b(num_equations);
@@ -1837,15 +2100,11 @@ namespace cilantro {
             tforms_vec.template segment<Dim>(i*NumUnknownsLocal + Dim*Dim).setZero();
         }
 
-        // Conjugate Gradient solver
-//        Eigen::ConjugateGradient<Eigen::SparseMatrix<ScalarT>,Eigen::Lower|Eigen::Upper,Eigen::IncompleteCholesky<ScalarT,Eigen::Lower|Eigen::Upper>> solver;
-//        Eigen::ConjugateGradient<Eigen::SparseMatrix<ScalarT>,Eigen::Lower|Eigen::Upper,Eigen::IdentityPreconditioner> solver;
-        Eigen::ConjugateGradient<Eigen::SparseMatrix<ScalarT>,Eigen::Lower|Eigen::Upper,Eigen::DiagonalPreconditioner<ScalarT>> solver;
-        solver.setMaxIterations(max_cg_iter);
-        solver.setTolerance(cg_conv_tol);
-
-        Eigen::SparseMatrix<ScalarT> AtA;
-        Eigen::Matrix<ScalarT,Eigen::Dynamic,1> Atb;
+        // Gauss-Newton step solver; a caller-provided one brings its configuration (solver type, preconditioner,
+        // matrix-free products, warm start) and carries its symbolic analysis over from previous calls
+        WarpFieldLinearSolver<ScalarT,NumUnknownsLocal> local_solver;
+        WarpFieldLinearSolver<ScalarT,NumUnknownsLocal> &solver = (linear_solver != NULL) ? *linear_solver : local_solver;
+        solver.setMaxNumberOfIterations(max_cg_iter).setConvergenceTolerance(cg_conv_tol);
 
         // Parameters
         const ScalarT point_to_point_weight_sqrt = std::sqrt(point_to_point_weight);
@@ -1900,17 +2159,14 @@ namespace cilantro {
                         eq_ind = Dim*i;
 
                         for (size_t j = 0; j < ctrl_neighbors.size(); j++) {
-                            const size_t offset = NumUnknownsLocal*ctrl_neighbors[j].index;
                             weight = corr_weight_nrm*ctrl_neighbors[j].value;
 
                             for (size_t eq = 0; eq < Dim; eq++) {
                                 nz_ind = outer_ptr[eq_ind + eq] + NumNonZerosPointToPoint*j;
                                 for (size_t nz = 0; nz < Dim; nz++) {
-                                    values[nz_ind] = weight*s_t[nz];
-                                    inner_ind[nz_ind++] = offset + Dim*eq + nz;
+                                    values[nz_ind++] = weight*s_t[nz];
                                 }
-                                values[nz_ind] = weight;
-                                inner_ind[nz_ind++] = offset + Dim*Dim + eq;
+                                values[nz_ind++] = weight;
                             }
                         }
 
@@ -1953,20 +2209,17 @@ namespace cilantro {
                         eq_ind = num_point_to_point_equations + i;
 
                         for (size_t j = 0; j < ctrl_neighbors.size(); j++) {
-                            const size_t offset = NumUnknownsLocal*ctrl_neighbors[j].index;
                             weight = corr_weight_nrm*ctrl_neighbors[j].value;
 
                             nz_ind = outer_ptr[eq_ind] + NumUnknownsLocal*j;
 
                             for (size_t block = 0; block < Dim; block++) {
                                 for (size_t curr = 0; curr < Dim; curr++) {
-                                    values[nz_ind] = weight*n[block]*s_t[curr];
-                                    inner_ind[nz_ind++] = offset + Dim*block + curr;
+                                    values[nz_ind++] = weight*n[block]*s_t[curr];
                                 }
                             }
                             for (size_t curr = 0; curr < Dim; curr++) {
-                                values[nz_ind] = weight*n[curr];
-                                inner_ind[nz_ind++] = offset + Dim*Dim + curr;
+                                values[nz_ind++] = weight*n[curr];
                             }
                         }
 
@@ -1991,24 +2244,16 @@ namespace cilantro {
                         for (size_t eq = 0; eq < NumUnknownsLocal; eq++) {
                             diff = tforms_vec[s_offset + eq] - tforms_vec[n_offset + eq];
                             d_sqrt_huber_loss = weight*internal::sqrtHuberLossDerivative<ScalarT>(diff, huber_boundary);
-                            values[nz_ind] = d_sqrt_huber_loss;
-                            inner_ind[nz_ind++] = s_offset + eq;
-                            values[nz_ind] = -d_sqrt_huber_loss;
-                            inner_ind[nz_ind++] = n_offset + eq;
+                            values[nz_ind++] = d_sqrt_huber_loss;
+                            values[nz_ind++] = -d_sqrt_huber_loss;
                             b[eq_ind++] = -weight*internal::sqrtHuberLoss<ScalarT>(diff, huber_boundary);
                         }
                     }
                 }
             }
 
-            // Solve linear system using CG
-            AtA = At*At.transpose();
-            Atb.noalias() = At*b;
-
-//            solver.compute(AtA);
-            if (iter == 0) solver.analyzePattern(AtA);
-            solver.factorize(AtA);
-            delta = solver.solve(Atb);
+            // Solve linear system (CG or sparse LDLT, as configured)
+            solver.solve(At, b, delta);
             tforms_vec += delta;
 
             iter++;
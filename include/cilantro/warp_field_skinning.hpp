@@ -0,0 +1,310 @@
+#pragma once
+
+#include <cilantro/space_transformations.hpp>
+#include <cilantro/nearest_neighbors.hpp>
+#include <cilantro/common_pair_evaluators.hpp>
+
+namespace cilantro {
+    // Applies a sparsely supported warp field (node transforms blended over fixed point-to-node neighborhoods,
+    // e.g. the src_to_ctrl_neighborhoods of CombinedMetricSparseWarpFieldICP) to dense points and normals,
+    // without materializing a dense TransformSet. Neighborhoods are padded to a common size and stored with
+    // their normalized weights in flat neighbor-major arrays; node transforms are packed as contiguous
+    // parameter vectors (one vector load per neighbor), and each block of points gets its blended parameters
+    // in structure-of-arrays form, so that transforming points and normals runs in vectorizable loops.
+    // 3D rigid transforms are blended as dual quaternions; all other motion models are blended linearly
+    // (affine 3x4), 2D rotations being renormalized. Points without neighbors are left unchanged.
+    template <class TransformT>
+    class WarpFieldSkinning {
+    public:
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+        typedef typename TransformT::Scalar Scalar;
+
+        enum {
+            Dimension = TransformT::Dim,
+            IsDualQuaternion = int(TransformT::Mode) == int(Eigen::Isometry) && TransformT::Dim == 3,
+            NumberOfParameters = IsDualQuaternion ? 8 : TransformT::Dim*(TransformT::Dim + 1)
+        };
+
+        template <class WeightEvaluatorT = UnityWeightEvaluator<Scalar,Scalar>>
+        WarpFieldSkinning(const std::vector<NeighborSet<typename WeightEvaluatorT::InputScalar>> &point_to_node_neighborhoods,
+                          const WeightEvaluatorT &weight_evaluator = WeightEvaluatorT())
+                : num_points_(point_to_node_neighborhoods.size()), num_neighbors_(1), num_nodes_(0)
+        {
+            for (size_t i = 0; i < num_points_; i++) {
+                num_neighbors_ = std::max(num_neighbors_, point_to_node_neighborhoods[i].size());
+            }
+            neighbor_indices_.resize(num_neighbors_*num_points_);
+            neighbor_weights_.resize(num_neighbors_*num_points_);
+
+#pragma omp parallel for
+            for (size_t i = 0; i < num_points_; i++) {
+                const NeighborSet<typename WeightEvaluatorT::InputScalar> &nn = point_to_node_neighborhoods[i];
+                Scalar total_weight = (Scalar)0.0;
+                for (size_t j = 0; j < nn.size(); j++) {
+                    neighbor_weights_[j*num_points_ + i] = weight_evaluator(i, nn[j].index, nn[j].value);
+                    total_weight += neighbor_weights_[j*num_points_ + i];
+                }
+                // Node parameter column 0 holds the identity, for points without (weighted) neighbors
+                if (total_weight == (Scalar)0.0) {
+                    for (size_t j = 0; j < num_neighbors_; j++) {
+                        neighbor_indices_[j*num_points_ + i] = 0;
+                        neighbor_weights_[j*num_points_ + i] = (j == 0) ? (Scalar)1.0 : (Scalar)0.0;
+                    }
+                    continue;
+                }
+                for (size_t j = 0; j < nn.size(); j++) {
+                    neighbor_indices_[j*num_points_ + i] = (int)nn[j].index + 1;
+                    neighbor_weights_[j*num_points_ + i] /= total_weight;
+                }
+                for (size_t j = nn.size(); j < num_neighbors_; j++) {
+                    neighbor_indices_[j*num_points_ + i] = (int)nn[0].index + 1;
+                    neighbor_weights_[j*num_points_ + i] = (Scalar)0.0;
+                }
+            }
+        }
+
+        inline size_t getNumberOfPoints() const { return num_points_; }
+
+        inline size_t getNumberOfNeighbors() const { return num_neighbors_; }
+
+        inline size_t getNumberOfNodes() const { return num_nodes_; }
+
+        WarpFieldSkinning& setNodeTransforms(const TransformSet<TransformT> &transforms) {
+            num_nodes_ = transforms.size();
+            node_parameters_.resize(NumberOfParameters, num_nodes_ + 1);
+            set_node_parameters_(0, TransformT::Identity());
+#pragma omp parallel for
+            for (size_t i = 0; i < num_nodes_; i++) {
+                set_node_parameters_(i + 1, transforms[i]);
+            }
+            return *this;
+        }
+
+        // One column per node, column 0 being the identity and column i + 1 node i
+        inline const Eigen::Matrix<Scalar,NumberOfParameters,Eigen::Dynamic>& getNodeParameters() const { return node_parameters_; }
+
+        void warpPoints(const ConstVectorSetMatrixMap<Scalar,TransformT::Dim> &points,
+                        VectorSet<Scalar,TransformT::Dim> &result) const
+        {
+            eigen_assert((size_t)points.cols() == num_points_ && "WarpFieldSkinning::warpPoints(): number of points does not match the neighborhoods");
+            result.resize(Dimension, num_points_);
+            apply_(points.data(), NULL, result.data(), NULL);
+        }
+
+        inline VectorSet<Scalar,TransformT::Dim> warpPoints(const ConstVectorSetMatrixMap<Scalar,TransformT::Dim> &points) const {
+            VectorSet<Scalar,TransformT::Dim> result;
+            warpPoints(points, result);
+            return result;
+        }
+
+        void warpPointsNormals(const ConstVectorSetMatrixMap<Scalar,TransformT::Dim> &points,
+                               const ConstVectorSetMatrixMap<Scalar,TransformT::Dim> &normals,
+                               VectorSet<Scalar,TransformT::Dim> &result_points,
+                               VectorSet<Scalar,TransformT::Dim> &result_normals) const
+        {
+            eigen_assert((size_t)points.cols() == num_points_ && "WarpFieldSkinning::warpPointsNormals(): number of points does not match the neighborhoods");
+            eigen_assert(normals.cols() == points.cols() && "WarpFieldSkinning::warpPointsNormals(): number of normals does not match the number of points");
+            result_points.resize(Dimension, num_points_);
+            result_normals.resize(Dimension, num_points_);
+            apply_(points.data(), normals.data(), result_points.data(), result_normals.data());
+        }
+
+    private:
+        enum { BlockSize = 16 };
+
+        size_t num_points_;
+        size_t num_neighbors_;
+        size_t num_nodes_;
+        // Neighbor j of point i is at j*num_points_ + i
+        std::vector<int> neighbor_indices_;
+        std::vector<Scalar> neighbor_weights_;
+        // Identity, followed by the node transforms
+        Eigen::Matrix<Scalar,NumberOfParameters,Eigen::Dynamic> node_parameters_;
+
+        void apply_(const Scalar * points, const Scalar * normals, Scalar * result_points, Scalar * result_normals) const {
+            const size_t num_blocks = (num_points_ + BlockSize - 1)/BlockSize;
+
+#pragma omp parallel for
+            for (size_t b = 0; b < num_blocks; b++) {
+                const size_t start = BlockSize*b;
+                const size_t size = std::min((size_t)BlockSize, num_points_ - start);
+
+                Scalar blended[NumberOfParameters][BlockSize];
+                blend_block_(start, size, blended);
+                apply_block_(start, size, blended, points, normals, result_points, result_normals);
+            }
+        }
+
+        // Blended parameters are written transposed (one row per parameter, one lane per point)
+        inline void blend_block_(size_t start, size_t size, Scalar (&blended)[NumberOfParameters][BlockSize]) const {
+            eigen_assert(node_parameters_.cols() > 0 && "WarpFieldSkinning: setNodeTransforms() must be called before warping");
+            Vector<Scalar,NumberOfParameters> sum;
+            for (size_t l = 0; l < size; l++) {
+                const int * const ind = neighbor_indices_.data() + start + l;
+                const Scalar * const w = neighbor_weights_.data() + start + l;
+                // Stored indices are shifted by one (column 0 is the identity)
+                for (size_t j = 0; j < num_neighbors_; j++) {
+                    eigen_assert((size_t)ind[j*num_points_] <= num_nodes_ && "WarpFieldSkinning: neighbor index out of range of the node transforms");
+                }
+                const auto first = node_parameters_.col(ind[0]);
+                sum.noalias() = w[0]*first;
+                for (size_t j = 1; j < num_neighbors_; j++) {
+                    const auto params = node_parameters_.col(ind[j*num_points_]);
+                    // Dual quaternions are blended on the hemisphere of the first neighbor's rotation
+                    if (IsDualQuaternion && first.template head<4>().dot(params.template head<4>()) < (Scalar)0.0) {
+                        sum.noalias() -= w[j*num_points_]*params;
+                    } else {
+                        sum.noalias() += w[j*num_points_]*params;
+                    }
+                }
+                for (size_t p = 0; p < NumberOfParameters; p++) {
+                    blended[p][l] = sum[p];
+                }
+            }
+        }
+
+        template <bool DQ = IsDualQuaternion>
+        inline typename std::enable_if<DQ,void>::type set_node_parameters_(size_t node, const TransformT &tform) {
+            const Eigen::Quaternion<Scalar> q(tform.linear());
+            const Vector<Scalar,3> t(tform.translation());
+            node_parameters_(0,node) = q.w();
+            node_parameters_(1,node) = q.x();
+            node_parameters_(2,node) = q.y();
+            node_parameters_(3,node) = q.z();
+            // Dual part: 0.5*(0,t)*q
+            node_parameters_(4,node) = (Scalar)(-0.5)*(t[0]*q.x() + t[1]*q.y() + t[2]*q.z());
+            node_parameters_(5,node) = (Scalar)(0.5)*(t[0]*q.w() + t[1]*q.z() - t[2]*q.y());
+            node_parameters_(6,node) = (Scalar)(0.5)*(-t[0]*q.z() + t[1]*q.w() + t[2]*q.x());
+            node_parameters_(7,node) = (Scalar)(0.5)*(t[0]*q.y() - t[1]*q.x() + t[2]*q.w());
+        }
+
+        // Column-major linear part, followed by the translation
+        template <bool DQ = IsDualQuaternion>
+        inline typename std::enable_if<!DQ,void>::type set_node_parameters_(size_t node, const TransformT &tform) {
+            for (size_t c = 0; c < Dimension; c++) {
+                for (size_t r = 0; r < Dimension; r++) {
+                    node_parameters_(Dimension*c + r,node) = tform.linear()(r,c);
+                }
+            }
+            for (size_t r = 0; r < Dimension; r++) {
+                node_parameters_(Dimension*Dimension + r,node) = tform.translation()[r];
+            }
+        }
+
+        // Dual quaternions are converted to rotation matrices and translations before transforming
+        template <bool DQ = IsDualQuaternion>
+        inline typename std::enable_if<DQ,void>::type apply_block_(size_t start, size_t size, Scalar (&dq)[NumberOfParameters][BlockSize],
+                                                                  const Scalar * points, const Scalar * normals,
+                                                                  Scalar * result_points, Scalar * result_normals) const
+        {
+            Scalar params[12][BlockSize];
+            for (size_t l = 0; l < size; l++) {
+                const Scalar inv_norm = (Scalar)1.0/std::sqrt(dq[0][l]*dq[0][l] + dq[1][l]*dq[1][l] + dq[2][l]*dq[2][l] + dq[3][l]*dq[3][l]);
+                const Scalar w = dq[0][l]*inv_norm, x = dq[1][l]*inv_norm, y = dq[2][l]*inv_norm, z = dq[3][l]*inv_norm;
+                const Scalar dw = dq[4][l]*inv_norm, dx = dq[5][l]*inv_norm, dy = dq[6][l]*inv_norm, dz = dq[7][l]*inv_norm;
+
+                params[0][l] = (Scalar)1.0 - (Scalar)2.0*(y*y + z*z);
+                params[1][l] = (Scalar)2.0*(x*y + w*z);
+                params[2][l] = (Scalar)2.0*(x*z - w*y);
+                params[3][l] = (Scalar)2.0*(x*y - w*z);
+                params[4][l] = (Scalar)1.0 - (Scalar)2.0*(x*x + z*z);
+                params[5][l] = (Scalar)2.0*(y*z + w*x);
+                params[6][l] = (Scalar)2.0*(x*z + w*y);
+                params[7][l] = (Scalar)2.0*(y*z - w*x);
+                params[8][l] = (Scalar)1.0 - (Scalar)2.0*(x*x + y*y);
+                // Translation: vector part of 2*dual*conj(real)
+                params[9][l] = (Scalar)2.0*(w*dx - dw*x + y*dz - z*dy);
+                params[10][l] = (Scalar)2.0*(w*dy - dw*y + z*dx - x*dz);
+                params[11][l] = (Scalar)2.0*(w*dz - dw*z + x*dy - y*dx);
+            }
+            transform_block_<true>(start, size, params, points, normals, result_points, result_normals);
+        }
+
+        template <bool DQ = IsDualQuaternion>
+        inline typename std::enable_if<!DQ,void>::type apply_block_(size_t start, size_t size, Scalar (&params)[NumberOfParameters][BlockSize],
+                                                                   const Scalar * points, const Scalar * normals,
+                                                                   Scalar * result_points, Scalar * result_normals) const
+        {
+            if (int(TransformT::Mode) == int(Eigen::Isometry)) {
+                // 2D: the blend of rotations [c -s; s c] keeps that form and only needs rescaling
+                for (size_t l = 0; l < size; l++) {
+                    const Scalar inv_norm = (Scalar)1.0/std::sqrt(params[0][l]*params[0][l] + params[1][l]*params[1][l]);
+                    params[0][l] *= inv_norm;
+                    params[1][l] *= inv_norm;
+                    params[2][l] = -params[1][l];
+                    params[3][l] = params[0][l];
+                }
+            }
+            transform_block_<int(TransformT::Mode) == int(Eigen::Isometry)>(start, size, params, points, normals, result_points, result_normals);
+        }
+
+        // params holds the column-major linear part followed by the translation, one lane per point
+        template <bool IsRigid>
+        inline void transform_block_(size_t start, size_t size, const Scalar (&params)[Dimension*(Dimension + 1)][BlockSize],
+                                     const Scalar * points, const Scalar * normals,
+                                     Scalar * result_points, Scalar * result_normals) const
+        {
+            for (size_t l = 0; l < size; l++) {
+                const Scalar * const p = points + Dimension*(start + l);
+                Scalar * const res_p = result_points + Dimension*(start + l);
+                for (size_t r = 0; r < Dimension; r++) {
+                    Scalar sum = params[Dimension*Dimension + r][l];
+                    for (size_t c = 0; c < Dimension; c++) {
+                        sum += params[Dimension*c + r][l]*p[c];
+                    }
+                    res_p[r] = sum;
+                }
+            }
+
+            if (normals == NULL) return;
+
+            if (IsRigid) {
+                for (size_t l = 0; l < size; l++) {
+                    const Scalar * const n = normals + Dimension*(start + l);
+                    Scalar * const res_n = result_normals + Dimension*(start + l);
+                    for (size_t r = 0; r < Dimension; r++) {
+                        Scalar sum = (Scalar)0.0;
+                        for (size_t c = 0; c < Dimension; c++) {
+                            sum += params[Dimension*c + r][l]*n[c];
+                        }
+                        res_n[r] = sum;
+                    }
+                }
+                return;
+            }
+
+            // Normals follow the inverse transpose, i.e. the cofactor matrix scaled by the determinant's inverse
+            for (size_t l = 0; l < size; l++) {
+                const Scalar * const n = normals + Dimension*(start + l);
+                Scalar * const res_n = result_normals + Dimension*(start + l);
+                Scalar det = (Scalar)0.0;
+                for (size_t c = 0; c < Dimension; c++) {
+                    det += params[Dimension*c][l]*cofactor_(params, 0, c, l);
+                }
+                Scalar norm_sq = (Scalar)0.0;
+                for (size_t r = 0; r < Dimension; r++) {
+                    Scalar sum = (Scalar)0.0;
+                    for (size_t c = 0; c < Dimension; c++) {
+                        sum += cofactor_(params, r, c, l)*n[c];
+                    }
+                    res_n[r] = sum;
+                    norm_sq += sum*sum;
+                }
+                const Scalar scale = ((det < (Scalar)0.0) ? (Scalar)(-1.0) : (Scalar)1.0)/std::sqrt(norm_sq);
+                for (size_t r = 0; r < Dimension; r++) {
+                    res_n[r] *= scale;
+                }
+            }
+        }
+
+        // Cofactor (r,c) of the linear part (2D or 3D) of lane l
+        static inline Scalar cofactor_(const Scalar (&params)[Dimension*(Dimension + 1)][BlockSize], size_t r, size_t c, size_t l) {
+            if (Dimension == 2) {
+                return (((r + c) % 2 == 0) ? (Scalar)1.0 : (Scalar)(-1.0))*params[Dimension*(1 - c) + 1 - r][l];
+            }
+            const size_t r1 = (r + 1) % Dimension, r2 = (r + 2) % Dimension, c1 = (c + 1) % Dimension, c2 = (c + 2) % Dimension;
+            return params[Dimension*c1 + r1][l]*params[Dimension*c2 + r2][l] - params[Dimension*c2 + r1][l]*params[Dimension*c1 + r2][l];
+        }
+    };
+}